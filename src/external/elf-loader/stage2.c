@@ -205,6 +205,13 @@ setup_env_vars (const char **envp)
       g_vdl.bind_now = 1;
     }
 
+  // setup huge_pages from LD_HUGE_PAGES
+  const char *huge_pages = vdl_utils_getenv (envp, "LD_HUGE_PAGES");
+  if (huge_pages != 0)
+    {
+      g_vdl.huge_pages = 1;
+    }
+
   // get additional static TLS size from LD_STATIC_TLS_EXTRA
   const char *static_tls_extra =
     vdl_utils_getenv (envp, "LD_STATIC_TLS_EXTRA");
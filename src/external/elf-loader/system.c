@@ -44,6 +44,17 @@ system_mprotect (const void *addr, size_t len, int prot)
   return status;
 }
 
+int
+system_madvise (void *addr, size_t len, int advice)
+{
+  int status = MACHINE_SYSCALL3 (madvise, addr, len, advice);
+  if (status < 0 && status > -256)
+    {
+      return -1;
+    }
+  return status;
+}
+
 void
 system_write (int fd, const void *buf, size_t size)
 {
@@ -13,6 +13,7 @@
 void *system_mmap(void *start, size_t length, int prot, int flags, int fd, off_t offset);
 int system_munmap (uint8_t *start, size_t size);
 int system_mprotect (const void *addr, size_t len, int prot);
+int system_madvise (void *addr, size_t len, int advice);
 void system_write (int fd, const void *buf, size_t size);
 int system_open (const char *name, int oflag, mode_t mode);
 int system_open_ro (const char *file);
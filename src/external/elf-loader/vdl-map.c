@@ -709,6 +709,26 @@ found:
 }
 #endif
 
+// the size of a transparent huge page on the architectures we support
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+// ask the kernel to back the whole huge pages inside [start, start+size) with
+// transparent huge pages. this only fails if the kernel doesn't support them,
+// and then we simply keep the small pages.
+static void
+file_map_advise_huge_pages (unsigned long start, unsigned long size)
+{
+  unsigned long huge_start = vdl_utils_align_up (start, HUGE_PAGE_SIZE);
+  unsigned long huge_end = vdl_utils_align_down (start + size, HUGE_PAGE_SIZE);
+  if (huge_end > huge_start)
+    {
+      int result = system_madvise ((void *) huge_start,
+                                   huge_end - huge_start, MADV_HUGEPAGE);
+      VDL_LOG_DEBUG ("madvise huge pages 0x%lx-0x%lx: %d\n", huge_start,
+                     huge_end, result);
+    }
+}
+
 static void
 file_map_do (const char *filename, const struct VdlFileMap *map,
              int fd, int prot, unsigned long load_base)
@@ -781,6 +801,17 @@ file_map_do (const char *filename, const struct VdlFileMap *map,
       VDL_LOG_ASSERT (address != (unsigned long) -1,
                       "Unable to map zero pages\n");
     }
+
+  if (g_vdl.huge_pages)
+    {
+      file_map_advise_huge_pages (load_base + map->mem_start_align,
+                                  map->mem_size_align);
+      if (map->mem_anon_size_align > 0)
+        {
+          file_map_advise_huge_pages (load_base + map->mem_anon_start_align,
+                                      map->mem_anon_size_align);
+        }
+    }
 }
 
 static struct VdlFile *
@@ -58,6 +58,8 @@ struct Vdl
   // The list of directories to search for binaries in DT_NEEDED entries.
   struct VdlList *search_dirs;
   uint32_t bind_now:1;
+  // ask for transparent huge pages on mapped segments, from LD_HUGE_PAGES
+  uint32_t huge_pages:1;
   uint32_t finalized:1;
   // the TCB has been set as the thread pointer
   uint32_t tp_set:1;
@@ -333,6 +333,8 @@ static void _main_logEnvironment(gchar** argv, gchar** envv) {
             if(!g_ascii_strncasecmp(envv[i], "LD_PRELOAD", 10) ||
                     !g_ascii_strncasecmp(envv[i], "SHADOW_SPAWNED", 14) ||
                     !g_ascii_strncasecmp(envv[i], "LD_STATIC_TLS_EXTRA", 19) ||
+                    !g_ascii_strncasecmp(envv[i], "LD_HUGE_PAGES", 13) ||
+                    !g_ascii_strncasecmp(envv[i], "GLIBC_TUNABLES", 14) ||
                     !g_ascii_strncasecmp(envv[i], "G_DEBUG", 7) ||
                     !g_ascii_strncasecmp(envv[i], "G_SLICE", 7)) {
                 message("env: %s", envv[i]);
@@ -612,6 +614,25 @@ static gint _main_helper(Options* options) {
             g_free(staticTLSValue);
         }
 
+        if(options_doUseHugePages(options)) {
+            message("setting up huge page environment");
+
+            /* the elf-loader advises huge pages on the plug-in segments it maps */
+            envlist = g_environ_setenv(envlist, "LD_HUGE_PAGES", "1", 1);
+
+            /* glibc malloc advises huge pages on its heaps and large chunks, which
+             * holds our hosts, events, packets, and the pth thread stacks. older
+             * versions of glibc ignore tunables they don't know. */
+            const gchar* tunables = g_environ_getenv(envlist, "GLIBC_TUNABLES");
+            if(tunables == NULL) {
+                envlist = g_environ_setenv(envlist, "GLIBC_TUNABLES", "glibc.malloc.hugetlb=1", 1);
+            } else if(g_strstr_len(tunables, -1, "glibc.malloc.hugetlb") == NULL) {
+                gchar* value = g_strdup_printf("%s:glibc.malloc.hugetlb=1", tunables);
+                envlist = g_environ_setenv(envlist, "GLIBC_TUNABLES", value, 1);
+                g_free(value);
+            }
+        }
+
         /* cleanup unused string */
         if(preloadArgValue) {
             g_free(preloadArgValue);
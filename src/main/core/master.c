@@ -15,6 +15,7 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <stddef.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "main/core/logger/shadow_logger.h"
@@ -221,7 +222,7 @@ static gboolean _master_loadTopology(Master* master) {
     }
 
     /* initialize global routing model */
-    master->topology = topology_new(temporaryFilename);
+    master->topology = topology_new(temporaryFilename, options_getTopologyChangesPath(master->options));
     g_unlink(temporaryFilename);
 
     if(!master->topology) {
@@ -237,6 +238,34 @@ static gboolean _master_loadTopology(Master* master) {
     return TRUE;
 }
 
+/* applies the topology changes that are due at or before windowStart, and ends the
+ * execution window at the next change so that it is applied at exactly its time.
+ * this must only be called while the workers are waiting for the next round. */
+static void _master_applyTopologyChanges(Master* master, SimulationTime windowStart) {
+    MAGIC_ASSERT(master);
+
+    gdouble minPathLatency = 0;
+    if(topology_applyChanges(master->topology, windowStart, &minPathLatency)) {
+        /* this is the fastest edge over the whole graph, so it bounds every path that
+         * may be computed from now on and is safe to raise as well as to lower */
+        SimulationTime oldJump = master->nextMinJumpTime;
+        master->nextMinJumpTime = MAX(1, (SimulationTime)(minPathLatency * SIMTIME_ONE_MILLISECOND));
+        master->minJumpTime = master->nextMinJumpTime;
+        info("topology changes set minimum time jump from %"G_GUINT64_FORMAT" to %"G_GUINT64_FORMAT" nanoseconds",
+                oldJump, master->nextMinJumpTime);
+
+        SimulationTime windowEnd = windowStart + _master_getMinTimeJump(master);
+        if(windowEnd < master->executeWindowEnd) {
+            master->executeWindowEnd = windowEnd;
+        }
+    }
+
+    SimulationTime nextChangeTime = topology_getNextChangeTime(master->topology);
+    if(nextChangeTime != SIMTIME_INVALID && nextChangeTime < master->executeWindowEnd) {
+        master->executeWindowEnd = nextChangeTime;
+    }
+}
+
 static void _master_initializeTimeWindows(Master* master) {
     MAGIC_ASSERT(master);
 
@@ -252,6 +281,7 @@ static void _master_initializeTimeWindows(Master* master) {
         SimulationTime jump = _master_getMinTimeJump(master);
         master->executeWindowEnd = jump;
         master->nextMinJumpTime = jump;
+        _master_applyTopologyChanges(master, 0);
     } else {
         /* single threaded, we are the only worker */
         master->executeWindowStart = 0;
@@ -301,6 +331,29 @@ static void _master_registerProcessCallback(ConfigurationProcessElement* pe, Pro
                         pe->arguments.string->str);
 }
 
+static void _master_registerTrafficCallback(ConfigurationTrafficElement* te, ProcessCallbackArgs* args) {
+    utility_assert(te && args);
+    MAGIC_ASSERT(args->master);
+    utility_assert(te->model.isSet && te->model.string);
+
+    TrafficModelParameters params;
+    memset(&params, 0, sizeof(TrafficModelParameters));
+
+    params.type = trafficmodel_typeFromString(te->model.string->str);
+    params.protocol = (te->protocol.isSet && !g_ascii_strcasecmp(te->protocol.string->str, "udp")) ? PUDP : PTCP;
+    params.peerHostname = te->peer.isSet ? te->peer.string->str : NULL;
+    params.peerPort = htons((in_port_t)te->port.integer);
+    params.startTime = SIMTIME_ONE_SECOND * te->starttime.integer;
+    params.stopTime = te->stoptime.isSet ? SIMTIME_ONE_SECOND * te->stoptime.integer : 0;
+    params.size = te->size.isSet ? (gsize)te->size.integer : 1024;
+    params.responseSize = te->responsesize.isSet ? (gsize)te->responsesize.integer : 0;
+    params.interval = te->interval.isSet ? SIMTIME_ONE_MILLISECOND * te->interval.integer : 0;
+    params.meanOnTime = te->ontime.isSet ? SIMTIME_ONE_MILLISECOND * te->ontime.integer : 0;
+    params.meanOffTime = te->offtime.isSet ? SIMTIME_ONE_MILLISECOND * te->offtime.integer : 0;
+
+    slave_addNewTrafficModel(args->master->slave, args->hostParams->hostname, &params);
+}
+
 static void _master_registerHostCallback(ConfigurationHostElement* he, Master* master) {
     MAGIC_ASSERT(master);
     utility_assert(he);
@@ -384,6 +437,7 @@ static void _master_registerHostCallback(ConfigurationHostElement* he, Master* m
 
         /* now handle each virtual process the host will run */
         g_queue_foreach(he->processes, (GFunc)_master_registerProcessCallback, &processArgs);
+        g_queue_foreach(he->traffic, (GFunc)_master_registerTrafficCallback, &processArgs);
 
         /* cleanup for next pass through the loop */
         g_string_free(hostnameBuffer, TRUE);
@@ -472,6 +526,10 @@ gboolean master_slaveFinishedCurrentRound(Master* master, SimulationTime minNext
     master->executeWindowStart = newStart;
     master->executeWindowEnd = newEnd;
 
+    /* the workers are waiting for us, so this is when the topology may change */
+    _master_applyTopologyChanges(master, newStart);
+    newEnd = master->executeWindowEnd;
+
     *executeWindowStart = master->executeWindowStart;
     *executeWindowEnd = master->executeWindowEnd;
 
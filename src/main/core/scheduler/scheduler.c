@@ -24,6 +24,12 @@
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
 
+/* the fewest events per round that make waking up another worker worthwhile */
+#define SCHEDULER_MIN_EVENTS_PER_WORKER 128
+/* how many consecutive quiet rounds must pass before we park workers, so that
+ * short lulls do not cause the hosts to be re-dealt back and forth */
+#define SCHEDULER_PARK_DELAY_ROUNDS 16
+
 struct _Scheduler {
     /* all worker threads used by the scheduler */
     GQueue* threadItems;
@@ -62,6 +68,16 @@ struct _Scheduler {
         SimulationTime minNextEventTime;
     } currentRound;
 
+    /* park workers that would not have enough events to run */
+    struct {
+        gboolean enabled;
+        guint quietRounds;
+    } adaptWorkers;
+
+    /* free every host and pending event at shutdown, rather than only
+     * flushing the host outputs and leaving the memory to the OS */
+    gboolean fullTeardown;
+
     /* for memory management */
     gint referenceCount;
     MAGIC_DECLARE;
@@ -106,7 +122,11 @@ static void _scheduler_stopHosts(Scheduler* scheduler) {
         if(myHosts) {
             guint nHosts = g_queue_get_length(myHosts);
             message("starting to shut down %u hosts", nHosts);
-            worker_freeHosts(myHosts);
+            if(scheduler->fullTeardown) {
+                worker_freeHosts(myHosts);
+            } else {
+                worker_flushHosts(myHosts);
+            }
             message("%u hosts are shut down", nHosts);
         }
     }
@@ -272,8 +292,18 @@ static void _scheduler_joinThreads(SchedulerThreadItem* item, Scheduler* schedul
 static void _scheduler_free(Scheduler* scheduler) {
     MAGIC_ASSERT(scheduler);
 
-    /* finish cleanup of shadow objects */
-    scheduler->policy->free(scheduler->policy);
+    /* log the policy's totals first, since we may not free it */
+    if(scheduler->policy->logSummary) {
+        scheduler->policy->logSummary(scheduler->policy);
+    }
+
+    /* finish cleanup of shadow objects. the policy holds the pending events,
+     * which we leave to the OS on a fast shutdown since we are exiting anyway. */
+    if(scheduler->fullTeardown) {
+        scheduler->policy->free(scheduler->policy);
+    } else {
+        message("skipped freeing the hosts and pending events, leaving the memory to the OS");
+    }
     random_free(scheduler->random);
 
     /* "join" the threads */
@@ -336,6 +366,49 @@ void scheduler_unref(Scheduler* scheduler) {
     }
 }
 
+/* the policy is chosen once and never changes during a run, so these branches
+ * are always predicted correctly and let us call the common policies directly
+ * rather than through the policy's function table on every event */
+static inline void _scheduler_pushToPolicy(Scheduler* scheduler, Event* event, Host* sender, Host* receiver) {
+    SimulationTime barrier = scheduler->currentRound.endTime;
+    switch(scheduler->policyType) {
+        case SP_PARALLEL_HOST_STEAL: {
+            schedulerpolicyhoststeal_push(scheduler->policy, event, sender, receiver, barrier);
+            break;
+        }
+        case SP_PARALLEL_HOST_SINGLE: {
+            schedulerpolicyhostsingle_push(scheduler->policy, event, sender, receiver, barrier);
+            break;
+        }
+        case SP_SERIAL_GLOBAL: {
+            schedulerpolicyglobalsingle_push(scheduler->policy, event, sender, receiver, barrier);
+            break;
+        }
+        default: {
+            scheduler->policy->push(scheduler->policy, event, sender, receiver, barrier);
+            break;
+        }
+    }
+}
+
+static inline Event* _scheduler_popFromPolicy(Scheduler* scheduler) {
+    SimulationTime barrier = scheduler->currentRound.endTime;
+    switch(scheduler->policyType) {
+        case SP_PARALLEL_HOST_STEAL: {
+            return schedulerpolicyhoststeal_pop(scheduler->policy, barrier);
+        }
+        case SP_PARALLEL_HOST_SINGLE: {
+            return schedulerpolicyhostsingle_pop(scheduler->policy, barrier);
+        }
+        case SP_SERIAL_GLOBAL: {
+            return schedulerpolicyglobalsingle_pop(scheduler->policy, barrier);
+        }
+        default: {
+            return scheduler->policy->pop(scheduler->policy, barrier);
+        }
+    }
+}
+
 gboolean scheduler_push(Scheduler* scheduler, Event* event, Host* sender, Host* receiver) {
     MAGIC_ASSERT(scheduler);
 
@@ -351,11 +424,27 @@ gboolean scheduler_push(Scheduler* scheduler, Event* event, Host* sender, Host*
     utility_assert(receiver == event_getHost(event));
 
     /* push to a queue based on the policy */
-    scheduler->policy->push(scheduler->policy, event, sender, receiver, scheduler->currentRound.endTime);
+    _scheduler_pushToPolicy(scheduler, event, sender, receiver);
+
+    return TRUE;
+}
 
+gboolean scheduler_blockHost(Scheduler* scheduler, Event* event, SimulationTime untilTime) {
+    MAGIC_ASSERT(scheduler);
+
+    if(!scheduler->policy->blockHost) {
+        return FALSE;
+    }
+
+    scheduler->policy->blockHost(scheduler->policy, event, event_getHost(event), untilTime);
     return TRUE;
 }
 
+static inline gboolean _scheduler_isThreadParked(Scheduler* scheduler) {
+    return scheduler->adaptWorkers.enabled &&
+            !schedulerpolicyhoststeal_isThreadActive(scheduler->policy);
+}
+
 Event* scheduler_pop(Scheduler* scheduler) {
     MAGIC_ASSERT(scheduler);
 
@@ -363,8 +452,12 @@ Event* scheduler_pop(Scheduler* scheduler) {
      * return NULL only to signal the worker thread to quit */
 
     while(scheduler->isRunning) {
-        /* pop from a queue based on the policy */
-        Event* nextEvent = scheduler->policy->pop(scheduler->policy, scheduler->currentRound.endTime);
+        /* pop from a queue based on the policy. parked threads own no hosts and
+         * skip straight to sleeping at the barrier. */
+        Event* nextEvent = NULL;
+        if(!_scheduler_isThreadParked(scheduler)) {
+            nextEvent = _scheduler_popFromPolicy(scheduler);
+        }
 
         if(nextEvent != NULL) {
             /* we have an event, let the worker run it */
@@ -379,6 +472,9 @@ Event* scheduler_pop(Scheduler* scheduler) {
              * track idle times, so let's start by making sure we have timer elements in place. */
             GTimer* executeEventsBarrierWaitTime = g_hash_table_lookup(scheduler->threadToWaitTimerMap, GUINT_TO_POINTER(pthread_self()));
 
+            /* charge the last host we ran before we start waiting */
+            worker_flushExecutionTime();
+
             /* wait for all other worker threads to finish their events too, and track wait time */
             if(executeEventsBarrierWaitTime) {
                 g_timer_continue(executeEventsBarrierWaitTime);
@@ -390,6 +486,8 @@ Event* scheduler_pop(Scheduler* scheduler) {
 
             /* now all threads reached the current round end barrier time.
              * asynchronously collect some stats that the main thread will use. */
+            worker_updateLiveMetrics(executeEventsBarrierWaitTime ?
+                    g_timer_elapsed(executeEventsBarrierWaitTime, NULL) : 0.0f);
             if(scheduler->policy->getNextTime) {
                 SimulationTime nextTime = scheduler->policy->getNextTime(scheduler->policy);
                 g_mutex_lock(&(scheduler->globalLock));
@@ -434,6 +532,14 @@ static void _scheduler_appendHostToQueue(gpointer uintKey, Host* host, GQueue* a
     g_queue_push_tail(allHosts, host);
 }
 
+/* returns a new queue of all hosts, which the caller must free */
+GQueue* scheduler_getHosts(Scheduler* scheduler) {
+    MAGIC_ASSERT(scheduler);
+    GQueue* hosts = g_queue_new();
+    g_hash_table_foreach(scheduler->hostIDToHostMap, (GHFunc)_scheduler_appendHostToQueue, hosts);
+    return hosts;
+}
+
 static void _scheduler_shuffleQueue(Scheduler* scheduler, GQueue* queue) {
     if(queue == NULL) {
         return;
@@ -559,11 +665,60 @@ static void _scheduler_rebalanceHosts(Scheduler* scheduler) {
     }
 }
 
+static void _scheduler_adaptWorkers(Scheduler* scheduler) {
+    MAGIC_ASSERT(scheduler);
+
+    gsize nEvents = 0;
+    guint nHosts = 0;
+    schedulerpolicyhoststeal_collectRoundWork(scheduler->policy, &nEvents, &nHosts);
+
+    /* each active worker should get enough events to amortize the barrier,
+     * and at least one host with events of its own */
+    guint nWorkers = g_queue_get_length(scheduler->threadItems);
+    gsize nWanted = MIN(nEvents / SCHEDULER_MIN_EVENTS_PER_WORKER, (gsize)nHosts);
+    nWanted = CLAMP(nWanted, 1, (gsize)nWorkers);
+
+    guint nActive = schedulerpolicyhoststeal_getActiveThreads(scheduler->policy);
+
+    if(nWanted > nActive) {
+        /* busy rounds need all the help they can get right away */
+        scheduler->adaptWorkers.quietRounds = 0;
+    } else if(nWanted < nActive && scheduler->adaptWorkers.quietRounds < SCHEDULER_PARK_DELAY_ROUNDS) {
+        scheduler->adaptWorkers.quietRounds++;
+        return;
+    } else {
+        scheduler->adaptWorkers.quietRounds = 0;
+        if(nWanted == nActive) {
+            return;
+        }
+    }
+
+    debug("round ran %"G_GSIZE_FORMAT" events on %u hosts, changing from %u to %u active workers",
+            nEvents, nHosts, nActive, (guint)nWanted);
+    schedulerpolicyhoststeal_setActiveThreads(scheduler->policy, (guint)nWanted);
+}
+
+void scheduler_setAdaptiveWorkers(Scheduler* scheduler, gboolean enabled) {
+    MAGIC_ASSERT(scheduler);
+    if(enabled && scheduler->policyType != SP_PARALLEL_HOST_STEAL) {
+        warning("parking idle workers requires workers and the 'steal' scheduler policy; "
+                "all workers will run every round");
+        return;
+    }
+    scheduler->adaptWorkers.enabled = enabled;
+}
+
+void scheduler_setFullTeardown(Scheduler* scheduler, gboolean enabled) {
+    MAGIC_ASSERT(scheduler);
+    scheduler->fullTeardown = enabled;
+}
+
 SchedulerPolicyType scheduler_getPolicy(Scheduler* scheduler) {
     MAGIC_ASSERT(scheduler);
     return scheduler->policyType;
 }
 
+
 gboolean scheduler_isRunning(Scheduler* scheduler) {
     MAGIC_ASSERT(scheduler);
     return scheduler->isRunning;
@@ -640,6 +795,11 @@ SimulationTime scheduler_awaitNextRound(Scheduler* scheduler) {
         /* then they collect stats and wait at this barrier */
         countdownlatch_countDownAwait(scheduler->collectInfoBarrier);
         countdownlatch_reset(scheduler->collectInfoBarrier);
+
+        /* workers are blocked until the next round, so we may safely re-deal hosts */
+        if(scheduler->adaptWorkers.enabled) {
+            _scheduler_adaptWorkers(scheduler);
+        }
     }
 
     SimulationTime minNextEventTime = SIMTIME_MAX;
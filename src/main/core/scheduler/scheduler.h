@@ -31,10 +31,14 @@ void scheduler_finish(Scheduler*);
 
 gboolean scheduler_push(Scheduler*, Event*, Host* sender, Host* receiver);
 Event* scheduler_pop(Scheduler*);
+gboolean scheduler_blockHost(Scheduler*, Event*, SimulationTime untilTime);
 
 void scheduler_addHost(Scheduler*, Host*);
 Host* scheduler_getHost(Scheduler*, GQuark);
+GQueue* scheduler_getHosts(Scheduler*);
 SchedulerPolicyType scheduler_getPolicy(Scheduler*);
 gboolean scheduler_isRunning(Scheduler* scheduler);
+void scheduler_setAdaptiveWorkers(Scheduler* scheduler, gboolean enabled);
+void scheduler_setFullTeardown(Scheduler* scheduler, gboolean enabled);
 
 #endif /* SHD_SCHEDULER_H_ */
@@ -35,7 +35,9 @@ typedef GQueue* (*SchedulerPolicyGetHostsFunc)(SchedulerPolicy*);
 typedef void (*SchedulerPolicyPushFunc)(SchedulerPolicy*, Event*, Host*, Host*, SimulationTime);
 typedef Event* (*SchedulerPolicyPopFunc)(SchedulerPolicy*, SimulationTime);
 typedef SimulationTime (*SchedulerPolicyGetNextTimeFunc)(SchedulerPolicy*);
+typedef void (*SchedulerPolicyBlockHostFunc)(SchedulerPolicy*, Event*, Host*, SimulationTime);
 typedef void (*SchedulerPolicyFreeFunc)(SchedulerPolicy*);
+typedef void (*SchedulerPolicyLogSummaryFunc)(SchedulerPolicy*);
 
 struct _SchedulerPolicy {
     SchedulerPolicyType type;
@@ -47,6 +49,12 @@ struct _SchedulerPolicy {
     SchedulerPolicyPopFunc pop;
     SchedulerPolicyGetNextTimeFunc getNextTime;
     SchedulerPolicyFreeFunc free;
+    /* logs the totals the policy kept for each thread. called once at the end of the
+     * simulation, whether or not the policy is freed. NULL if the policy keeps none. */
+    SchedulerPolicyLogSummaryFunc logSummary;
+    /* returns a popped event to its host's queue and holds back all of the host's
+     * events until the given time. NULL if the policy does not keep a queue per host. */
+    SchedulerPolicyBlockHostFunc blockHost;
     MAGIC_DECLARE;
 };
 
@@ -57,4 +65,19 @@ SchedulerPolicy* schedulerpolicythreadsingle_new();
 SchedulerPolicy* schedulerpolicythreadperthread_new();
 SchedulerPolicy* schedulerpolicythreadperhost_new();
 
+/* the push and pop operations of the most common policies, exported so the
+ * scheduler can call them directly instead of through the function table */
+void schedulerpolicyglobalsingle_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier);
+Event* schedulerpolicyglobalsingle_pop(SchedulerPolicy* policy, SimulationTime barrier);
+void schedulerpolicyhostsingle_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier);
+Event* schedulerpolicyhostsingle_pop(SchedulerPolicy* policy, SimulationTime barrier);
+void schedulerpolicyhoststeal_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier);
+Event* schedulerpolicyhoststeal_pop(SchedulerPolicy* policy, SimulationTime barrier);
+
+/* per-round work measurement and worker parking, only supported by the host steal policy */
+void schedulerpolicyhoststeal_collectRoundWork(SchedulerPolicy* policy, gsize* nEvents, guint* nHosts);
+gboolean schedulerpolicyhoststeal_isThreadActive(SchedulerPolicy* policy);
+guint schedulerpolicyhoststeal_getActiveThreads(SchedulerPolicy* policy);
+void schedulerpolicyhoststeal_setActiveThreads(SchedulerPolicy* policy, guint nActive);
+
 #endif /* SHD_SCHEDULER_POLICY_H_ */
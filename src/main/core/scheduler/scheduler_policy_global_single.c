@@ -37,13 +37,13 @@ static GQueue* _schedulerpolicyglobalsingle_getHosts(SchedulerPolicy* policy) {
     return data->assignedHosts;
 }
 
-static void _schedulerpolicyglobalsingle_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier) {
+void schedulerpolicyglobalsingle_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier) {
     MAGIC_ASSERT(policy);
     GlobalSinglePolicyData* data = policy->data;
     priorityqueue_push(data->pq, event);
 }
 
-static Event* _schedulerpolicyglobalsingle_pop(SchedulerPolicy* policy, SimulationTime barrier) {
+Event* schedulerpolicyglobalsingle_pop(SchedulerPolicy* policy, SimulationTime barrier) {
     MAGIC_ASSERT(policy);
     GlobalSinglePolicyData* data = policy->data;
 
@@ -95,8 +95,8 @@ SchedulerPolicy* schedulerpolicyglobalsingle_new() {
     MAGIC_INIT(policy);
     policy->addHost = _schedulerpolicyglobalsingle_addHost;
     policy->getAssignedHosts = _schedulerpolicyglobalsingle_getHosts;
-    policy->push = _schedulerpolicyglobalsingle_push;
-    policy->pop = _schedulerpolicyglobalsingle_pop;
+    policy->push = schedulerpolicyglobalsingle_push;
+    policy->pop = schedulerpolicyglobalsingle_pop;
     policy->getNextTime = _schedulerpolicyglobalsingle_getNextTime;
     policy->free = _schedulerpolicyglobalsingle_free;
 
@@ -22,6 +22,8 @@ struct _HostSingleQueueData {
     SimulationTime lastEventTime;
     gsize nPushed;
     gsize nPopped;
+    /* the host's cpu is blocked until this time, and none of its events may run before it */
+    SimulationTime blockedUntilTime;
 };
 
 typedef struct _HostSingleThreadData HostSingleThreadData;
@@ -45,6 +47,11 @@ struct _HostSinglePolicyData {
     MAGIC_DECLARE;
 };
 
+/* each worker caches a direct pointer to its own thread data, so that we don't
+ * need to look it up in threadToThreadDataMap for every event. we only ever
+ * create a single scheduler policy per process. */
+static GPrivate hostSingleThreadDataKey = G_PRIVATE_INIT(NULL);
+
 typedef struct _HostSingleSearchState HostSingleSearchState;
 struct _HostSingleSearchState {
     HostSinglePolicyData* data;
@@ -80,23 +87,24 @@ static void _hostsinglethreaddata_free(HostSingleThreadData* tdata) {
             g_queue_free(tdata->processedHosts);
         }
 
-        gdouble totalPushWaitTime = 0.0;
         if(tdata->pushIdleTime) {
-            totalPushWaitTime = g_timer_elapsed(tdata->pushIdleTime, NULL);
             g_timer_destroy(tdata->pushIdleTime);
         }
-        gdouble totalPopWaitTime = 0.0;
         if(tdata->popIdleTime) {
-            totalPopWaitTime = g_timer_elapsed(tdata->popIdleTime, NULL);
             g_timer_destroy(tdata->popIdleTime);
         }
 
         g_free(tdata);
-        message("scheduler thread data destroyed, total push wait time was %f seconds, "
-                "total pop wait time was %f seconds", totalPushWaitTime, totalPopWaitTime);
     }
 }
 
+static void _hostsinglethreaddata_logSummary(gpointer thread, HostSingleThreadData* tdata, gpointer userData) {
+    gdouble totalPushWaitTime = tdata->pushIdleTime ? g_timer_elapsed(tdata->pushIdleTime, NULL) : 0.0;
+    gdouble totalPopWaitTime = tdata->popIdleTime ? g_timer_elapsed(tdata->popIdleTime, NULL) : 0.0;
+    message("scheduler thread %p summary, total push wait time was %f seconds, "
+            "total pop wait time was %f seconds", thread, totalPushWaitTime, totalPopWaitTime);
+}
+
 static HostSingleQueueData* _hostsinglequeuedata_new() {
     HostSingleQueueData* qdata = g_new0(HostSingleQueueData, 1);
 
@@ -116,6 +124,18 @@ static void _hostsinglequeuedata_free(HostSingleQueueData* qdata) {
     }
 }
 
+static HostSingleThreadData* _schedulerpolicyhostsingle_getThreadData(HostSinglePolicyData* data) {
+    HostSingleThreadData* tdata = g_private_get(&hostSingleThreadDataKey);
+    if(G_UNLIKELY(tdata == NULL)) {
+        /* the thread data is created when the first host is assigned to a thread */
+        tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+        if(tdata != NULL) {
+            g_private_set(&hostSingleThreadDataKey, tdata);
+        }
+    }
+    return tdata;
+}
+
 /* this must be run synchronously, or the call must be protected by locks */
 static void _schedulerpolicyhostsingle_addHost(SchedulerPolicy* policy, Host* host, pthread_t randomThread) {
     MAGIC_ASSERT(policy);
@@ -123,7 +143,10 @@ static void _schedulerpolicyhostsingle_addHost(SchedulerPolicy* policy, Host* ho
 
     /* each host has its own queue */
     if(!g_hash_table_lookup(data->hostToQueueDataMap, host)) {
-        g_hash_table_replace(data->hostToQueueDataMap, host, _hostsinglequeuedata_new());
+        HostSingleQueueData* qdata = _hostsinglequeuedata_new();
+        g_hash_table_replace(data->hostToQueueDataMap, host, qdata);
+        /* the table owns the queue, the host keeps a direct pointer for push and pop */
+        host_setSchedulerData(host, qdata);
     }
 
     /* each thread keeps track of the hosts it needs to run */
@@ -146,7 +169,7 @@ static void concat_queue_iter(Host* hostItem, GQueue* userQueue) {
 static GQueue* _schedulerpolicyhostsingle_getHosts(SchedulerPolicy* policy) {
     MAGIC_ASSERT(policy);
     HostSinglePolicyData* data = policy->data;
-    HostSingleThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+    HostSingleThreadData* tdata = _schedulerpolicyhostsingle_getThreadData(data);
     if(!tdata) {
         return NULL;
     }
@@ -164,7 +187,7 @@ static GQueue* _schedulerpolicyhostsingle_getHosts(SchedulerPolicy* policy) {
     return tdata->allHosts;
 }
 
-static void _schedulerpolicyhostsingle_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier) {
+void schedulerpolicyhostsingle_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier) {
     MAGIC_ASSERT(policy);
     HostSinglePolicyData* data = policy->data;
 
@@ -184,10 +207,10 @@ static void _schedulerpolicyhostsingle_push(SchedulerPolicy* policy, Event* even
     }
 
     /* we want to track how long this thread spends idle waiting to push the event */
-    HostSingleThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+    HostSingleThreadData* tdata = _schedulerpolicyhostsingle_getThreadData(data);
 
     /* get the queue for the destination */
-    HostSingleQueueData* qdata = g_hash_table_lookup(data->hostToQueueDataMap, dstHost);
+    HostSingleQueueData* qdata = host_getSchedulerData(dstHost);
     utility_assert(qdata);
 
     /* tracking idle time spent waiting for the destination queue lock */
@@ -207,12 +230,34 @@ static void _schedulerpolicyhostsingle_push(SchedulerPolicy* policy, Event* even
     g_mutex_unlock(&(qdata->lock));
 }
 
-static Event* _schedulerpolicyhostsingle_pop(SchedulerPolicy* policy, SimulationTime barrier) {
+/* the time at which the event can run, which is no earlier than the time the host's
+ * cpu frees up. the caller must hold the queue lock. */
+static inline SimulationTime _schedulerpolicyhostsingle_getReadyTime(HostSingleQueueData* qdata, Event* event) {
+    return MAX(event_getTime(event), qdata->blockedUntilTime);
+}
+
+static void _schedulerpolicyhostsingle_blockHost(SchedulerPolicy* policy, Event* event, Host* host, SimulationTime untilTime) {
+    MAGIC_ASSERT(policy);
+
+    HostSingleQueueData* qdata = host_getSchedulerData(host);
+    utility_assert(qdata);
+
+    /* the event keeps its place at the head of the queue, and the rest of the queue
+     * waits behind it, so we don't need to reschedule any of the host's events */
+    event_clearReadyTime(event);
+    g_mutex_lock(&(qdata->lock));
+    priorityqueue_push(qdata->pq, event);
+    qdata->nPushed++;
+    qdata->blockedUntilTime = MAX(qdata->blockedUntilTime, untilTime);
+    g_mutex_unlock(&(qdata->lock));
+}
+
+Event* schedulerpolicyhostsingle_pop(SchedulerPolicy* policy, SimulationTime barrier) {
     MAGIC_ASSERT(policy);
     HostSinglePolicyData* data = policy->data;
 
     /* figure out which hosts we should be checking */
-    HostSingleThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+    HostSingleThreadData* tdata = _schedulerpolicyhostsingle_getThreadData(data);
     /* if there is no tdata, that means this thread didn't get any hosts assigned to it */
     if(!tdata) {
         /* this thread will remain idle */
@@ -236,7 +281,7 @@ static Event* _schedulerpolicyhostsingle_pop(SchedulerPolicy* policy, Simulation
 
     while(!g_queue_is_empty(tdata->unprocessedHosts)) {
         Host* host = g_queue_peek_head(tdata->unprocessedHosts);
-        HostSingleQueueData* qdata = g_hash_table_lookup(data->hostToQueueDataMap, host);
+        HostSingleQueueData* qdata = host_getSchedulerData(host);
         utility_assert(qdata);
 
         /* tracking idle time spent waiting for the host queue lock */
@@ -245,13 +290,16 @@ static Event* _schedulerpolicyhostsingle_pop(SchedulerPolicy* policy, Simulation
         g_timer_stop(tdata->popIdleTime);
 
         Event* nextEvent = priorityqueue_peek(qdata->pq);
-        SimulationTime eventTime = (nextEvent != NULL) ? event_getTime(nextEvent) : SIMTIME_INVALID;
+        SimulationTime eventTime = (nextEvent != NULL) ?
+                _schedulerpolicyhostsingle_getReadyTime(qdata, nextEvent) : SIMTIME_INVALID;
 
         if(nextEvent != NULL && eventTime < barrier) {
             utility_assert(eventTime >= qdata->lastEventTime);
             qdata->lastEventTime = eventTime;
             nextEvent = priorityqueue_pop(qdata->pq);
             qdata->nPopped++;
+            /* events held back by a blocked cpu run as soon as it frees up */
+            event_setReadyTime(nextEvent, eventTime);
         } else {
             nextEvent = NULL;
         }
@@ -271,16 +319,16 @@ static Event* _schedulerpolicyhostsingle_pop(SchedulerPolicy* policy, Simulation
 }
 
 static void _schedulerpolicyhostsingle_findMinTime(Host* host, HostSingleSearchState* state) {
-    HostSingleQueueData* qdata = g_hash_table_lookup(state->data->hostToQueueDataMap, host);
+    HostSingleQueueData* qdata = host_getSchedulerData(host);
     utility_assert(qdata);
 
     g_mutex_lock(&(qdata->lock));
     Event* event = priorityqueue_peek(qdata->pq);
+    SimulationTime eventTime = (event != NULL) ?
+            _schedulerpolicyhostsingle_getReadyTime(qdata, event) : SIMTIME_MAX;
     g_mutex_unlock(&(qdata->lock));
 
-    if(event != NULL) {
-        state->nextEventTime = MIN(state->nextEventTime, event_getTime(event));
-    }
+    state->nextEventTime = MIN(state->nextEventTime, eventTime);
 }
 
 static SimulationTime _schedulerpolicyhostsingle_getNextTime(SchedulerPolicy* policy) {
@@ -293,7 +341,7 @@ static SimulationTime _schedulerpolicyhostsingle_getNextTime(SchedulerPolicy* po
     searchState.data = data;
     searchState.nextEventTime = SIMTIME_MAX;
 
-    HostSingleThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+    HostSingleThreadData* tdata = _schedulerpolicyhostsingle_getThreadData(data);
     if(tdata) {
         /* make sure we get all hosts, which are probably held in the processedHosts queue between rounds */
         g_queue_foreach(tdata->unprocessedHosts, (GFunc)_schedulerpolicyhostsingle_findMinTime, &searchState);
@@ -304,6 +352,12 @@ static SimulationTime _schedulerpolicyhostsingle_getNextTime(SchedulerPolicy* po
     return searchState.nextEventTime;
 }
 
+static void _schedulerpolicyhostsingle_logSummary(SchedulerPolicy* policy) {
+    MAGIC_ASSERT(policy);
+    HostSinglePolicyData* data = policy->data;
+    g_hash_table_foreach(data->threadToThreadDataMap, (GHFunc)_hostsinglethreaddata_logSummary, NULL);
+}
+
 static void _schedulerpolicyhostsingle_free(SchedulerPolicy* policy) {
     MAGIC_ASSERT(policy);
     HostSinglePolicyData* data = policy->data;
@@ -327,10 +381,12 @@ SchedulerPolicy* schedulerpolicyhostsingle_new() {
     MAGIC_INIT(policy);
     policy->addHost = _schedulerpolicyhostsingle_addHost;
     policy->getAssignedHosts = _schedulerpolicyhostsingle_getHosts;
-    policy->push = _schedulerpolicyhostsingle_push;
-    policy->pop = _schedulerpolicyhostsingle_pop;
+    policy->push = schedulerpolicyhostsingle_push;
+    policy->pop = schedulerpolicyhostsingle_pop;
     policy->getNextTime = _schedulerpolicyhostsingle_getNextTime;
     policy->free = _schedulerpolicyhostsingle_free;
+    policy->logSummary = _schedulerpolicyhostsingle_logSummary;
+    policy->blockHost = _schedulerpolicyhostsingle_blockHost;
 
     policy->type = SP_PARALLEL_HOST_SINGLE;
     policy->data = data;
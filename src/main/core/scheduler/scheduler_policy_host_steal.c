@@ -15,6 +15,11 @@
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
 
+/* a host that runs for more than 1/N of a round is reported as a straggler,
+ * unless the round took less than this many seconds */
+#define HOSTSTEAL_STRAGGLER_ROUND_SHARE_DIVISOR 2
+#define HOSTSTEAL_STRAGGLER_MIN_ROUND_TIME 0.001
+
 typedef struct _HostStealQueueData HostStealQueueData;
 struct _HostStealQueueData {
     GMutex lock;
@@ -22,6 +27,15 @@ struct _HostStealQueueData {
     SimulationTime lastEventTime;
     gsize nPushed;
     gsize nPopped;
+    /* the host's cpu is blocked until this time, and none of its events may run before it */
+    SimulationTime blockedUntilTime;
+    /* the execution cycles the worker had charged to this host at the end of the
+     * last round, and the log2 bucket of the cycles it was charged during that round.
+     * hosts are ordered by the bucket so that timing jitter does not reorder them. */
+    guint64 roundEndCycles;
+    guint loadClass;
+    /* the thread currently running this host, protected by the queue lock */
+    pthread_t assignedThread;
 };
 
 typedef struct _HostStealThreadData HostStealThreadData;
@@ -41,6 +55,14 @@ struct _HostStealThreadData {
     GTimer* popIdleTime;
     /* which worker thread this is */
     guint tnumber;
+    pthread_t thread;
+    /* the work done by this thread since the last collection, protected by the lock */
+    gsize roundEvents;
+    guint roundHosts;
+    gboolean runningHostPopped;
+    /* the cycle count when this thread started running events in the current round */
+    guint64 roundStartCycles;
+    guint nStragglerRounds;
     GMutex lock;
 };
 
@@ -48,13 +70,28 @@ typedef struct _HostStealPolicyData HostStealPolicyData;
 struct _HostStealPolicyData {
     GArray* threadList;
     guint threadCount;
+    /* threads with a tnumber at or above this are parked and own no hosts */
+    guint activeThreadCount;
     GHashTable* hostToQueueDataMap;
     GHashTable* threadToThreadDataMap;
-    GHashTable* hostToThreadMap;
     GRWLock lock;
     MAGIC_DECLARE;
 };
 
+/* each worker caches a direct pointer to its own thread data, so that we don't
+ * need to take the policy lock and look it up in threadToThreadDataMap for
+ * every event. we only ever create a single scheduler policy per process. */
+static GPrivate hostStealThreadDataKey = G_PRIVATE_INIT(NULL);
+
+typedef struct _HostStealLoadState HostStealLoadState;
+struct _HostStealLoadState {
+    guint previousLoadClass;
+    gboolean isSorted;
+    /* the host that was charged the most cycles in the last round */
+    Host* longestHost;
+    guint64 longestCycles;
+};
+
 typedef struct _HostStealSearchState HostStealSearchState;
 struct _HostStealSearchState {
     HostStealPolicyData* data;
@@ -92,23 +129,25 @@ static void _hoststealthreaddata_free(HostStealThreadData* tdata) {
             g_queue_free(tdata->processedHosts);
         }
 
-        gdouble totalPushWaitTime = 0.0;
         if(tdata->pushIdleTime) {
-            totalPushWaitTime = g_timer_elapsed(tdata->pushIdleTime, NULL);
             g_timer_destroy(tdata->pushIdleTime);
         }
-        gdouble totalPopWaitTime = 0.0;
         if(tdata->popIdleTime) {
-            totalPopWaitTime = g_timer_elapsed(tdata->popIdleTime, NULL);
             g_timer_destroy(tdata->popIdleTime);
         }
 
         g_free(tdata);
-        message("scheduler thread data destroyed, total push wait time was %f seconds, "
-                "total pop wait time was %f seconds", totalPushWaitTime, totalPopWaitTime);
     }
 }
 
+static void _hoststealthreaddata_logSummary(gpointer thread, HostStealThreadData* tdata, gpointer userData) {
+    gdouble totalPushWaitTime = tdata->pushIdleTime ? g_timer_elapsed(tdata->pushIdleTime, NULL) : 0.0;
+    gdouble totalPopWaitTime = tdata->popIdleTime ? g_timer_elapsed(tdata->popIdleTime, NULL) : 0.0;
+    message("scheduler thread %p summary, total push wait time was %f seconds, "
+            "total pop wait time was %f seconds, a single host dominated %u rounds",
+            thread, totalPushWaitTime, totalPopWaitTime, tdata->nStragglerRounds);
+}
+
 static HostStealQueueData* _hoststealqueuedata_new() {
     HostStealQueueData* qdata = g_new0(HostStealQueueData, 1);
 
@@ -128,18 +167,34 @@ static void _hoststealqueuedata_free(HostStealQueueData* qdata) {
     }
 }
 
+static HostStealThreadData* _schedulerpolicyhoststeal_getThreadData(HostStealPolicyData* data) {
+    HostStealThreadData* tdata = g_private_get(&hostStealThreadDataKey);
+    if(G_UNLIKELY(tdata == NULL)) {
+        /* the thread data is created when the first host is assigned to a thread */
+        g_rw_lock_reader_lock(&data->lock);
+        tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+        g_rw_lock_reader_unlock(&data->lock);
+        if(tdata != NULL) {
+            g_private_set(&hostStealThreadDataKey, tdata);
+        }
+    }
+    return tdata;
+}
+
 /* this must be run synchronously, or the thread must be protected by locks */
 static void _schedulerpolicyhoststeal_addHost(SchedulerPolicy* policy, Host* host, pthread_t randomThread) {
     MAGIC_ASSERT(policy);
     HostStealPolicyData* data = policy->data;
 
-    /* each host has its own queue
-     * we don't read lock data->lock because we only modify the table here anyway
-     */
-    if(!g_hash_table_lookup(data->hostToQueueDataMap, host)) {
+    /* each host has its own queue, which the host points to once it exists */
+    HostStealQueueData* qdata = host_getSchedulerData(host);
+    if(!qdata) {
+        qdata = _hoststealqueuedata_new();
         g_rw_lock_writer_lock(&data->lock);
-        g_hash_table_replace(data->hostToQueueDataMap, host, _hoststealqueuedata_new());
+        g_hash_table_replace(data->hostToQueueDataMap, host, qdata);
         g_rw_lock_writer_unlock(&data->lock);
+        /* the table owns the queue, the host keeps a direct pointer for push and pop */
+        host_setSchedulerData(host, qdata);
     }
 
     /* each thread keeps track of the hosts it needs to run */
@@ -152,32 +207,33 @@ static void _schedulerpolicyhoststeal_addHost(SchedulerPolicy* policy, Host* hos
         g_rw_lock_writer_lock(&data->lock);
         g_hash_table_replace(data->threadToThreadDataMap, GUINT_TO_POINTER(assignedThread), tdata);
         tdata->tnumber = data->threadCount;
+        tdata->thread = assignedThread;
         data->threadCount++;
         g_array_append_val(data->threadList, tdata);
-    } else {
-        g_rw_lock_writer_lock(&data->lock);
+        g_rw_lock_writer_unlock(&data->lock);
     }
     /* store the host-to-thread mapping */
-    g_hash_table_replace(data->hostToThreadMap, host, GUINT_TO_POINTER(assignedThread));
-    g_rw_lock_writer_unlock(&data->lock);
+    qdata->assignedThread = assignedThread;
     /* if the target thread is stealing the host, we don't want to add it twice */
     if(host != tdata->runningHost) {
         g_queue_push_tail(tdata->unprocessedHosts, host);
     }
 }
 
-/* primarily a wrapper for dealing with TLS and the hostToThread map.
+/* primarily a wrapper for dealing with TLS and the host's assigned thread.
  * this does not affect unprocessedHosts/processedHosts/runningHost;
  * that migration should be done as normal (from/to the respective threads) */
 static void _schedulerpolicyhoststeal_migrateHost(SchedulerPolicy* policy, Host* host, pthread_t newThread) {
     MAGIC_ASSERT(policy);
     HostStealPolicyData* data = policy->data;
-    g_rw_lock_reader_lock(&data->lock);
-    pthread_t oldThread = (pthread_t)g_hash_table_lookup(data->hostToThreadMap, host);
+    /* the caller holds the queue lock. this is called for every event we pop,
+     * so check for the common case that the host did not move first. */
+    HostStealQueueData* qdata = host_getSchedulerData(host);
+    pthread_t oldThread = qdata->assignedThread;
     if(oldThread == newThread) {
-        g_rw_lock_reader_unlock(&data->lock);
         return;
     }
+    g_rw_lock_reader_lock(&data->lock);
     HostStealThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(oldThread));
     HostStealThreadData* tdataNew = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(newThread));
     g_rw_lock_reader_unlock(&data->lock);
@@ -202,9 +258,7 @@ static void concat_queue_iter(Host* hostItem, GQueue* userQueue) {
 static GQueue* _schedulerpolicyhoststeal_getHosts(SchedulerPolicy* policy) {
     MAGIC_ASSERT(policy);
     HostStealPolicyData* data = policy->data;
-    g_rw_lock_reader_lock(&data->lock);
-    HostStealThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
-    g_rw_lock_reader_unlock(&data->lock);
+    HostStealThreadData* tdata = _schedulerpolicyhoststeal_getThreadData(data);
     if(!tdata) {
         return NULL;
     }
@@ -222,7 +276,7 @@ static GQueue* _schedulerpolicyhoststeal_getHosts(SchedulerPolicy* policy) {
     return tdata->allHosts;
 }
 
-static void _schedulerpolicyhoststeal_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier) {
+void schedulerpolicyhoststeal_push(SchedulerPolicy* policy, Event* event, Host* srcHost, Host* dstHost, SimulationTime barrier) {
     MAGIC_ASSERT(policy);
     HostStealPolicyData* data = policy->data;
 
@@ -241,13 +295,11 @@ static void _schedulerpolicyhoststeal_push(SchedulerPolicy* policy, Event* event
                 "to ensure event causality", eventTime, barrier);
     }
 
-    g_rw_lock_reader_lock(&data->lock);
     /* we want to track how long this thread spends idle waiting to push the event */
-    HostStealThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
+    HostStealThreadData* tdata = _schedulerpolicyhoststeal_getThreadData(data);
 
     /* get the queue for the destination */
-    HostStealQueueData* qdata = g_hash_table_lookup(data->hostToQueueDataMap, dstHost);
-    g_rw_lock_reader_unlock(&data->lock);
+    HostStealQueueData* qdata = host_getSchedulerData(dstHost);
     utility_assert(qdata);
 
     /* tracking idle time spent waiting for the destination queue lock */
@@ -271,34 +323,97 @@ static void _schedulerpolicyhoststeal_push(SchedulerPolicy* policy, Event* event
     }
 }
 
+/* the time at which the event can run, which is no earlier than the time the host's
+ * cpu frees up. the caller must hold the queue lock. */
+static inline SimulationTime _schedulerpolicyhoststeal_getReadyTime(HostStealQueueData* qdata, Event* event) {
+    return MAX(event_getTime(event), qdata->blockedUntilTime);
+}
+
+static void _schedulerpolicyhoststeal_blockHost(SchedulerPolicy* policy, Event* event, Host* host, SimulationTime untilTime) {
+    MAGIC_ASSERT(policy);
+
+    HostStealQueueData* qdata = host_getSchedulerData(host);
+    utility_assert(qdata);
+
+    /* the event keeps its place at the head of the queue, and the rest of the queue
+     * waits behind it, so we don't need to reschedule any of the host's events */
+    event_clearReadyTime(event);
+    g_mutex_lock(&(qdata->lock));
+    priorityqueue_push(qdata->pq, event);
+    qdata->nPushed++;
+    qdata->blockedUntilTime = MAX(qdata->blockedUntilTime, untilTime);
+    g_mutex_unlock(&(qdata->lock));
+}
+
+/* called after the round for the hosts in a thread's queues, which are owned by that
+ * thread. the workers charged all of the round's execution cycles to the hosts before
+ * waiting at the barrier, so we get the host's load for free from the difference. */
+static void _schedulerpolicyhoststeal_markRound(Host* host, HostStealLoadState* state) {
+    HostStealQueueData* qdata = host_getSchedulerData(host);
+    utility_assert(qdata);
+
+    guint64 cycles = host_getExecutionCycles(host);
+    guint64 roundCycles = cycles - qdata->roundEndCycles;
+    qdata->roundEndCycles = cycles;
+    qdata->loadClass = g_bit_storage(roundCycles);
+
+    if(roundCycles > state->longestCycles) {
+        state->longestCycles = roundCycles;
+        state->longestHost = host;
+    }
+}
+
+static void _schedulerpolicyhoststeal_checkSorted(Host* host, HostStealLoadState* state) {
+    HostStealQueueData* qdata = host_getSchedulerData(host);
+    utility_assert(qdata);
+
+    if(qdata->loadClass > state->previousLoadClass) {
+        state->isSorted = FALSE;
+    }
+    state->previousLoadClass = qdata->loadClass;
+}
+
+static gint _schedulerpolicyhoststeal_compareLoad(Host* a, Host* b, gpointer userData) {
+    HostStealQueueData* qa = host_getSchedulerData(a);
+    HostStealQueueData* qb = host_getSchedulerData(b);
+    /* busiest first; the sort is stable, so hosts in the same class keep their order */
+    return qa->loadClass < qb->loadClass ? +1 :
+            qa->loadClass > qb->loadClass ? -1 : 0;
+}
+
 static Event* _schedulerpolicyhoststeal_popFromThread(SchedulerPolicy* policy, HostStealThreadData* tdata, GQueue* assignedHosts, SimulationTime barrier) {
     /* if there is no tdata, that means this thread didn't get any hosts assigned to it */
     if(!tdata) {
         return NULL;
     }
 
-    HostStealPolicyData* data = policy->data;
-
     while(!g_queue_is_empty(assignedHosts) || tdata->runningHost) {
         /* if there's no running host, we completed the last assignment and need a new one */
         if(!tdata->runningHost) {
             tdata->runningHost = g_queue_pop_head(assignedHosts);
+            tdata->runningHostPopped = FALSE;
         }
         Host* host = tdata->runningHost;
-        g_rw_lock_reader_lock(&data->lock);
-        HostStealQueueData* qdata = g_hash_table_lookup(data->hostToQueueDataMap, host);
-        g_rw_lock_reader_unlock(&data->lock);
+        HostStealQueueData* qdata = host_getSchedulerData(host);
         utility_assert(qdata);
 
         g_mutex_lock(&(qdata->lock));
         Event* nextEvent = priorityqueue_peek(qdata->pq);
-        SimulationTime eventTime = (nextEvent != NULL) ? event_getTime(nextEvent) : SIMTIME_INVALID;
+        SimulationTime eventTime = (nextEvent != NULL) ?
+                _schedulerpolicyhoststeal_getReadyTime(qdata, nextEvent) : SIMTIME_INVALID;
 
         if(nextEvent != NULL && eventTime < barrier) {
             utility_assert(eventTime >= qdata->lastEventTime);
             qdata->lastEventTime = eventTime;
             nextEvent = priorityqueue_pop(qdata->pq);
             qdata->nPopped++;
+            /* events held back by a blocked cpu run as soon as it frees up */
+            event_setReadyTime(nextEvent, eventTime);
+            tdata->roundEvents++;
+            if(!tdata->runningHostPopped) {
+                tdata->runningHostPopped = TRUE;
+                tdata->roundHosts++;
+            }
             /* migrate iff a migration is needed */
             _schedulerpolicyhoststeal_migrateHost(policy, host, pthread_self());
         } else {
@@ -322,14 +437,12 @@ static Event* _schedulerpolicyhoststeal_popFromThread(SchedulerPolicy* policy, H
     return NULL;
 }
 
-static Event* _schedulerpolicyhoststeal_pop(SchedulerPolicy* policy, SimulationTime barrier) {
+Event* schedulerpolicyhoststeal_pop(SchedulerPolicy* policy, SimulationTime barrier) {
     MAGIC_ASSERT(policy);
     HostStealPolicyData* data = policy->data;
 
     /* first, we try to pop a host from this thread's queue */
-    g_rw_lock_reader_lock(&data->lock);
-    HostStealThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
-    g_rw_lock_reader_unlock(&data->lock);
+    HostStealThreadData* tdata = _schedulerpolicyhoststeal_getThreadData(data);
 
     /* if there is no tdata, that means this thread didn't get any hosts assigned to it */
     if(!tdata) {
@@ -355,6 +468,18 @@ static Event* _schedulerpolicyhoststeal_pop(SchedulerPolicy* policy, SimulationT
                 g_queue_push_tail(tdata->unprocessedHosts, g_queue_pop_head(tdata->processedHosts));
             }
         }
+
+        tdata->roundStartCycles = utility_getCycleCount();
+
+        /* a host's events run serially, so a busy host that is started late in the round
+         * holds up the barrier. start the hosts that ran longest in the last round first,
+         * which also puts them at the front of the queue for threads that steal from us.
+         * we only sort when a host moved to a different load class. */
+        HostStealLoadState loadState = {.previousLoadClass = G_MAXUINT, .isSorted = TRUE};
+        g_queue_foreach(tdata->unprocessedHosts, (GFunc)_schedulerpolicyhoststeal_checkSorted, &loadState);
+        if(!loadState.isSorted && data->threadCount > 1) {
+            g_queue_sort(tdata->unprocessedHosts, (GCompareDataFunc)_schedulerpolicyhoststeal_compareLoad, NULL);
+        }
     }
     /* attempt to get an event from this thread's queue */
     Event* nextEvent = _schedulerpolicyhoststeal_popFromThread(policy, tdata, tdata->unprocessedHosts, barrier);
@@ -367,7 +492,8 @@ static Event* _schedulerpolicyhoststeal_pop(SchedulerPolicy* policy, SimulationT
     GHashTableIter iter;
     gpointer key, value;
     g_rw_lock_reader_lock(&data->lock);
-    guint i, n = data->threadCount;
+    /* parked threads do not own any hosts, so there is nothing to steal from them */
+    guint i, n = MIN(data->threadCount, data->activeThreadCount);
     g_rw_lock_reader_unlock(&data->lock);
     for(i = 1; i < n; i++) {
         guint stolenTnumber = (i + tdata->tnumber) % n;
@@ -418,17 +544,37 @@ static Event* _schedulerpolicyhoststeal_pop(SchedulerPolicy* policy, SimulationT
 }
 
 static void _schedulerpolicyhoststeal_findMinTime(Host* host, HostStealSearchState* state) {
-    g_rw_lock_reader_lock(&state->data->lock);
-    HostStealQueueData* qdata = g_hash_table_lookup(state->data->hostToQueueDataMap, host);
-    g_rw_lock_reader_unlock(&state->data->lock);
+    HostStealQueueData* qdata = host_getSchedulerData(host);
     utility_assert(qdata);
 
     g_mutex_lock(&(qdata->lock));
     Event* event = priorityqueue_peek(qdata->pq);
+    SimulationTime eventTime = (event != NULL) ?
+            _schedulerpolicyhoststeal_getReadyTime(qdata, event) : SIMTIME_MAX;
     g_mutex_unlock(&(qdata->lock));
 
-    if(event != NULL) {
-        state->nextEventTime = MIN(state->nextEventTime, event_getTime(event));
+    state->nextEventTime = MIN(state->nextEventTime, eventTime);
+}
+
+/* called after the round by the thread that owns tdata, while the other threads are
+ * waiting. a host is a straggler if running it took most of the round on its own. */
+static void _schedulerpolicyhoststeal_checkStraggler(HostStealThreadData* tdata) {
+    HostStealLoadState loadState = {0};
+    g_queue_foreach(tdata->unprocessedHosts, (GFunc)_schedulerpolicyhoststeal_markRound, &loadState);
+    g_queue_foreach(tdata->processedHosts, (GFunc)_schedulerpolicyhoststeal_markRound, &loadState);
+
+    if(tdata->roundStartCycles > 0 && loadState.longestHost != NULL) {
+        guint64 roundCycles = utility_getCycleCount() - tdata->roundStartCycles;
+        gdouble roundTime = utility_cyclesToSeconds(roundCycles);
+
+        if(roundTime >= HOSTSTEAL_STRAGGLER_MIN_ROUND_TIME &&
+                loadState.longestCycles * HOSTSTEAL_STRAGGLER_ROUND_SHARE_DIVISOR > roundCycles) {
+            tdata->nStragglerRounds++;
+            info("host %s ran for %f of the %f seconds in this round; "
+                    "it will be started first in the next round",
+                    host_getName(loadState.longestHost),
+                    utility_cyclesToSeconds(loadState.longestCycles), roundTime);
+        }
     }
 }
 
@@ -442,10 +588,10 @@ static SimulationTime _schedulerpolicyhoststeal_getNextTime(SchedulerPolicy* pol
     searchState.data = data;
     searchState.nextEventTime = SIMTIME_MAX;
 
-    g_rw_lock_reader_lock(&data->lock);
-    HostStealThreadData* tdata = g_hash_table_lookup(data->threadToThreadDataMap, GUINT_TO_POINTER(pthread_self()));
-    g_rw_lock_reader_unlock(&data->lock);
+    HostStealThreadData* tdata = _schedulerpolicyhoststeal_getThreadData(data);
     if(tdata) {
+        _schedulerpolicyhoststeal_checkStraggler(tdata);
+
         /* make sure we get all hosts, which are probably held in the processedHosts queue between rounds */
         g_queue_foreach(tdata->unprocessedHosts, (GFunc)_schedulerpolicyhoststeal_findMinTime, &searchState);
         g_queue_foreach(tdata->processedHosts, (GFunc)_schedulerpolicyhoststeal_findMinTime, &searchState);
@@ -455,13 +601,114 @@ static SimulationTime _schedulerpolicyhoststeal_getNextTime(SchedulerPolicy* pol
     return searchState.nextEventTime;
 }
 
+void schedulerpolicyhoststeal_collectRoundWork(SchedulerPolicy* policy, gsize* nEvents, guint* nHosts) {
+    MAGIC_ASSERT(policy);
+    HostStealPolicyData* data = policy->data;
+
+    gsize totalEvents = 0;
+    guint totalHosts = 0;
+
+    g_rw_lock_reader_lock(&data->lock);
+    for(guint i = 0; i < data->threadCount; i++) {
+        HostStealThreadData* tdata = g_array_index(data->threadList, HostStealThreadData*, i);
+        g_mutex_lock(&(tdata->lock));
+        totalEvents += tdata->roundEvents;
+        totalHosts += tdata->roundHosts;
+        tdata->roundEvents = 0;
+        tdata->roundHosts = 0;
+        g_mutex_unlock(&(tdata->lock));
+    }
+    g_rw_lock_reader_unlock(&data->lock);
+
+    if(nEvents) {
+        *nEvents = totalEvents;
+    }
+    if(nHosts) {
+        *nHosts = totalHosts;
+    }
+}
+
+gboolean schedulerpolicyhoststeal_isThreadActive(SchedulerPolicy* policy) {
+    MAGIC_ASSERT(policy);
+    HostStealPolicyData* data = policy->data;
+    HostStealThreadData* tdata = _schedulerpolicyhoststeal_getThreadData(data);
+    /* threads that never got a host have nothing to run or steal from */
+    return (tdata != NULL && tdata->tnumber < data->activeThreadCount) ? TRUE : FALSE;
+}
+
+guint schedulerpolicyhoststeal_getActiveThreads(SchedulerPolicy* policy) {
+    MAGIC_ASSERT(policy);
+    HostStealPolicyData* data = policy->data;
+    return MIN(data->threadCount, data->activeThreadCount);
+}
+
+/* must only be called between rounds, while all workers are blocked at a barrier */
+void schedulerpolicyhoststeal_setActiveThreads(SchedulerPolicy* policy, guint nActive) {
+    MAGIC_ASSERT(policy);
+    HostStealPolicyData* data = policy->data;
+
+    g_rw_lock_writer_lock(&data->lock);
+
+    nActive = MAX(1, MIN(nActive, data->threadCount));
+    if(data->threadCount == 0 || nActive == MIN(data->threadCount, data->activeThreadCount)) {
+        g_rw_lock_writer_unlock(&data->lock);
+        return;
+    }
+
+    /* take every host away from its thread */
+    GQueue* hosts = g_queue_new();
+    for(guint i = 0; i < data->threadCount; i++) {
+        HostStealThreadData* tdata = g_array_index(data->threadList, HostStealThreadData*, i);
+        utility_assert(tdata->runningHost == NULL);
+        while(!g_queue_is_empty(tdata->unprocessedHosts)) {
+            g_queue_push_tail(hosts, g_queue_pop_head(tdata->unprocessedHosts));
+        }
+        while(!g_queue_is_empty(tdata->processedHosts)) {
+            g_queue_push_tail(hosts, g_queue_pop_head(tdata->processedHosts));
+        }
+    }
+
+    /* the order hosts were stolen in depends on thread timing, so sort them by
+     * id to make the new assignment independent of the previous rounds */
+    g_queue_sort(hosts, (GCompareDataFunc)host_compare, NULL);
+
+    /* deal them out evenly among the threads that remain active */
+    guint next = 0;
+    while(!g_queue_is_empty(hosts)) {
+        Host* host = g_queue_pop_head(hosts);
+        HostStealQueueData* qdata = host_getSchedulerData(host);
+        HostStealThreadData* tdata = g_array_index(data->threadList, HostStealThreadData*, next);
+        utility_assert(qdata);
+
+        pthread_t oldThread = qdata->assignedThread;
+        if(oldThread != tdata->thread) {
+            host_migrate(host, &oldThread, &(tdata->thread));
+            qdata->assignedThread = tdata->thread;
+        }
+        g_queue_push_tail(tdata->unprocessedHosts, host);
+
+        next = (next + 1) % nActive;
+    }
+    g_queue_free(hosts);
+
+    info("dealt hosts to %u of %u scheduler threads", nActive, data->threadCount);
+    data->activeThreadCount = nActive;
+
+    g_rw_lock_writer_unlock(&data->lock);
+}
+
+static void _schedulerpolicyhoststeal_logSummary(SchedulerPolicy* policy) {
+    MAGIC_ASSERT(policy);
+    HostStealPolicyData* data = policy->data;
+    g_hash_table_foreach(data->threadToThreadDataMap, (GHFunc)_hoststealthreaddata_logSummary, NULL);
+}
+
 static void _schedulerpolicyhoststeal_free(SchedulerPolicy* policy) {
     MAGIC_ASSERT(policy);
     HostStealPolicyData* data = policy->data;
 
     g_hash_table_destroy(data->hostToQueueDataMap);
     g_hash_table_destroy(data->threadToThreadDataMap);
-    g_hash_table_destroy(data->hostToThreadMap);
     g_rw_lock_clear(&data->lock);
     g_free(data);
 
@@ -472,19 +719,21 @@ static void _schedulerpolicyhoststeal_free(SchedulerPolicy* policy) {
 SchedulerPolicy* schedulerpolicyhoststeal_new() {
     HostStealPolicyData* data = g_new0(HostStealPolicyData, 1);
     data->threadList = g_array_new(FALSE, FALSE, sizeof(HostStealThreadData*));
+    data->activeThreadCount = G_MAXUINT;
     data->hostToQueueDataMap = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)_hoststealqueuedata_free);
     data->threadToThreadDataMap = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)_hoststealthreaddata_free);
-    data->hostToThreadMap = g_hash_table_new(g_direct_hash, g_direct_equal);
     g_rw_lock_init(&data->lock);
 
     SchedulerPolicy* policy = g_new0(SchedulerPolicy, 1);
     MAGIC_INIT(policy);
     policy->addHost = _schedulerpolicyhoststeal_addHost;
     policy->getAssignedHosts = _schedulerpolicyhoststeal_getHosts;
-    policy->push = _schedulerpolicyhoststeal_push;
-    policy->pop = _schedulerpolicyhoststeal_pop;
+    policy->push = schedulerpolicyhoststeal_push;
+    policy->pop = schedulerpolicyhoststeal_pop;
     policy->getNextTime = _schedulerpolicyhoststeal_getNextTime;
     policy->free = _schedulerpolicyhoststeal_free;
+    policy->logSummary = _schedulerpolicyhoststeal_logSummary;
+    policy->blockHost = _schedulerpolicyhoststeal_blockHost;
 
     policy->type = SP_PARALLEL_HOST_STEAL;
     policy->data = data;
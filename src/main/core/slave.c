@@ -5,10 +5,14 @@
 
 #include <errno.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stddef.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
+#include <unistd.h>
 
 #include "main/core/logger/shadow_logger.h"
 #include "main/core/master.h"
@@ -16,8 +20,10 @@
 #include "main/core/scheduler/scheduler_policy.h"
 #include "main/core/slave.h"
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/live_metrics.h"
 #include "main/core/support/options.h"
+#include "main/core/support/packet_trace.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/host/host.h"
 #include "main/host/network_interface.h"
@@ -51,13 +57,31 @@ struct _Slave {
     /* simulation cli options */
     Options* options;
     SimulationTime bootstrapEndTime;
+    SimulationTime endTime;
 
     /* slave random source, init from master random, used to init host randoms */
     Random* random;
     guint rawFrequencyKHz;
 
     /* global object counters, we collect counts from workers at end of sim */
-    ObjectCounter* objectCounts;
+    /* counters from threads without a worker, and from workers that exited */
+    Statistics* statistics;
+    /* the counters owned by each running worker */
+    GList* workerStatistics;
+
+    /* packets sent between each ordered pair of vertices, merged from the workers */
+    GHashTable* pathPacketCounts;
+    /* the path packet counters owned by each running worker */
+    GList* workerPathPacketCounts;
+
+    /* writes packet delivery status records, NULL unless tracing is enabled */
+    PacketTrace* packetTrace;
+    /* records from threads without a worker, protected by the slave lock */
+    PacketTraceBuffer* packetTraceBuffer;
+
+    /* the memory-mapped metrics for external monitoring, NULL unless enabled.
+     * it is only created and freed while no worker is running events. */
+    LiveMetrics* liveMetrics;
 
     /* the parallel event/host/thread scheduler */
     Scheduler* scheduler;
@@ -73,9 +97,19 @@ struct _Slave {
 
     /* the last time we logged heartbeat information */
     SimulationTime simClockLastHeartbeat;
+    /* the last time we stopped to let an external tool take a checkpoint */
+    SimulationTime simClockLastCheckpoint;
+    /* the last time we merged the path counters and wrote the traffic matrix */
+    SimulationTime simClockLastTrafficMatrix;
+    /* the last time we checked our resident memory against the memory budget */
+    SimulationTime simClockLastSpill;
 
     guint numPluginErrors;
 
+    /* the most verbose of the default and all per-host log levels, so we can
+     * skip building debug messages nobody will see without checking the host */
+    LogLevel maxLogLevel;
+
     gchar* cwdPath;
     gchar* dataPath;
     gchar* hostsPath;
@@ -179,8 +213,11 @@ Slave* slave_new(Master* master, Options* options, SimulationTime endTime, Simul
 
     slave->master = master;
     slave->options = options;
+    slave->endTime = endTime;
+    slave->maxLogLevel = options_getLogLevel(options);
     slave->random = random_new(randomSeed);
-    slave->objectCounts = objectcounter_new();
+    slave->statistics = statistics_new();
+    slave->pathPacketCounts = g_hash_table_new(g_direct_hash, g_direct_equal);
     slave->bootstrapEndTime = unlimBWEndTime;
 
     slave->rawFrequencyKHz = utility_getRawCPUFrequency(CONFIG_CPU_MAX_FREQ_FILE);
@@ -191,13 +228,6 @@ Slave* slave_new(Master* master, Options* options, SimulationTime endTime, Simul
     /* we will store the plug-in program meta data */
     slave->programMeta = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, _program_meta_free);
 
-    /* the main scheduler may utilize multiple threads */
-
-    guint nWorkers = options_getNWorkerThreads(options);
-    SchedulerPolicyType policy = _slave_getEventSchedulerPolicy(slave);
-    guint schedulerSeed = _slave_nextRandomUInt(slave);
-    slave->scheduler = scheduler_new(policy, nWorkers, slave, schedulerSeed, endTime);
-
     slave->cwdPath = g_get_current_dir();
     slave->dataPath = g_build_filename(slave->cwdPath, options_getDataOutputPath(options), NULL);
     slave->hostsPath = g_build_filename(slave->dataPath, "hosts", NULL);
@@ -217,9 +247,58 @@ Slave* slave_new(Master* master, Options* options, SimulationTime endTime, Simul
     /* now make sure the hosts path exists, as it may not have been in the template */
     g_mkdir_with_parents(slave->hostsPath, 0775);
 
+    /* the trace must exist before the workers start, since they each get a buffer */
+    if(options_doRunPacketTrace(options)) {
+        gchar* tracePath = g_build_filename(slave->dataPath, "packet-trace.bin", NULL);
+        slave->packetTrace = packettrace_new(tracePath);
+        if(slave->packetTrace != NULL) {
+            slave->packetTraceBuffer = packettrace_newBuffer(slave->packetTrace);
+        }
+        g_free(tracePath);
+    }
+
+    /* the main scheduler may utilize multiple threads */
+
+    guint nWorkers = options_getNWorkerThreads(options);
+    SchedulerPolicyType policy = _slave_getEventSchedulerPolicy(slave);
+    guint schedulerSeed = _slave_nextRandomUInt(slave);
+    slave->scheduler = scheduler_new(policy, nWorkers, slave, schedulerSeed, endTime);
+    if(options_doAdaptWorkers(options)) {
+        scheduler_setAdaptiveWorkers(slave->scheduler, TRUE);
+    }
+    scheduler_setFullTeardown(slave->scheduler, !options_doFastShutdown(options));
+
+#ifndef MADV_PAGEOUT
+    if(options_getMemoryBudget(options) > 0) {
+        warning("paging out idle hosts requires MADV_PAGEOUT, which this system does not support; "
+                "ignoring the memory budget");
+    }
+#endif
+
     return slave;
 }
 
+/* adds the counts into the total, and clears them. the owner of counts must not be running. */
+static void _slave_mergePathPacketCounts(GHashTable* total, GHashTable* counts) {
+    GHashTableIter iter;
+    gpointer vertexPair, count;
+    g_hash_table_iter_init(&iter, counts);
+    while(g_hash_table_iter_next(&iter, &vertexPair, &count)) {
+        guint64 totalCount = (guint64)g_hash_table_lookup(total, vertexPair);
+        g_hash_table_replace(total, vertexPair, (gpointer)(totalCount + (guint64)count));
+    }
+    g_hash_table_remove_all(counts);
+}
+
+static void _slave_writeTrafficMatrix(Slave* slave) {
+    MAGIC_ASSERT(slave);
+
+    gchar* matrixPath = g_build_filename(slave->dataPath, "traffic-matrix.txt", NULL);
+    topology_writeTrafficMatrix(master_getTopology(slave->master),
+            slave->pathPacketCounts, matrixPath);
+    g_free(matrixPath);
+}
+
 gint slave_free(Slave* slave) {
     MAGIC_ASSERT(slave);
     gint returnCode = (slave->numPluginErrors > 0) ? -1 : 0;
@@ -234,10 +313,43 @@ gint slave_free(Slave* slave) {
         scheduler_unref(slave->scheduler);
     }
 
-    if(slave->objectCounts != NULL) {
-        message("%s", objectcounter_valuesToString(slave->objectCounts));
-        message("%s", objectcounter_diffsToString(slave->objectCounts));
-        objectcounter_free(slave->objectCounts);
+    /* all workers are done, so nobody updates the metrics anymore */
+    if(slave->liveMetrics != NULL) {
+        livemetrics_free(slave->liveMetrics);
+        slave->liveMetrics = NULL;
+    }
+
+    /* all workers are done, so this writes out the remaining trace records */
+    if(slave->packetTrace != NULL) {
+        packettrace_free(slave->packetTrace);
+        slave->packetTrace = NULL;
+        slave->packetTraceBuffer = NULL;
+    }
+
+    /* all workers stored their path counters when they finished */
+    if(slave->pathPacketCounts != NULL) {
+        _slave_writeTrafficMatrix(slave);
+        g_hash_table_destroy(slave->pathPacketCounts);
+    }
+    if(slave->workerPathPacketCounts) {
+        g_list_free(slave->workerPathPacketCounts);
+    }
+
+    if(slave->statistics != NULL) {
+        gchar* values = statistics_valuesToString(slave->statistics);
+        gchar* diffs = statistics_objectDiffsToString(slave->statistics);
+        message("%s", values);
+        message("%s", diffs);
+        if(options_doFastShutdown(slave->options)) {
+            message("the object counts include the hosts that were not freed because of "
+                    "--fast-shutdown, run without it to check for leaks");
+        }
+        g_free(values);
+        g_free(diffs);
+        statistics_free(slave->statistics);
+    }
+    if(slave->workerStatistics) {
+        g_list_free(slave->workerStatistics);
     }
 
     g_hash_table_destroy(slave->programMeta);
@@ -300,6 +412,10 @@ void slave_addNewVirtualHost(Slave* slave, HostParameters* params) {
     params->id = g_quark_from_string(params->hostname);
     params->nodeSeed = _slave_nextRandomUInt(slave);
 
+    if(params->logLevel > slave->maxLogLevel) {
+        slave->maxLogLevel = params->logLevel;
+    }
+
     Host* host = host_new(params);
     host_setup(host, slave_getDNS(slave), slave_getTopology(slave),
             slave_getRawCPUFrequency(slave), slave_getHostsRootPath(slave));
@@ -335,6 +451,19 @@ void slave_addNewVirtualProcess(Slave* slave, gchar* hostName, gchar* pluginName
     host_stopExecutionTimer(host);
 }
 
+void slave_addNewTrafficModel(Slave* slave, gchar* hostName, TrafficModelParameters* params) {
+    MAGIC_ASSERT(slave);
+    utility_assert(params);
+
+    /* quarks are unique per process, so do the conversion here */
+    GQuark hostID = g_quark_from_string(hostName);
+
+    Host* host = scheduler_getHost(slave->scheduler, hostID);
+    host_continueExecutionTimer(host);
+    host_addTrafficModel(host, params);
+    host_stopExecutionTimer(host);
+}
+
 DNS* slave_getDNS(Slave* slave) {
     MAGIC_ASSERT(slave);
     return master_getDNS(slave->master);
@@ -387,6 +516,26 @@ void slave_updateMinTimeJump(Slave* slave, gdouble minPathLatency) {
     _slave_unlock(slave);
 }
 
+static void _slave_logStatistics(Slave* slave, SimulationTime simClockNow) {
+    MAGIC_ASSERT(slave);
+
+    /* sum a snapshot of all counters, the workers keep running while we read */
+    Statistics* snapshot = statistics_new();
+
+    _slave_lock(slave);
+    statistics_addAll(snapshot, slave->statistics);
+    for(GList* item = slave->workerStatistics; item != NULL; item = g_list_next(item)) {
+        statistics_addAll(snapshot, item->data);
+    }
+    _slave_unlock(slave);
+
+    gchar* values = statistics_valuesToString(snapshot);
+    message("at simtime %"G_GUINT64_FORMAT": %s", simClockNow, values);
+    g_free(values);
+
+    statistics_free(snapshot);
+}
+
 static void _slave_heartbeat(Slave* slave, SimulationTime simClockNow) {
     MAGIC_ASSERT(slave);
 
@@ -407,12 +556,228 @@ static void _slave_heartbeat(Slave* slave, SimulationTime simClockNow) {
         } else {
             warning("unable to print process resources usage: error %i in getrusage: %s", errno, g_strerror(errno));
         }
+
+        _slave_logStatistics(slave, simClockNow);
+    }
+}
+
+/* Stops the whole process at a round barrier, when no worker is executing
+ * events and everything before simClockNow has been processed, so that an
+ * external tool such as CRIU can checkpoint the complete simulator state,
+ * including plug-in memory, and later restore it at the same simulated time.
+ * The tool continues us by sending SIGCONT. */
+static void _slave_checkpoint(Slave* slave, SimulationTime simClockNow) {
+    MAGIC_ASSERT(slave);
+
+    SimulationTime interval = options_getCheckpointInterval(slave->options);
+    if(interval == 0 || simClockNow < slave->simClockLastCheckpoint + interval) {
+        return;
+    }
+    slave->simClockLastCheckpoint = simClockNow;
+
+    /* tell the checkpoint tool which process to dump and where we are */
+    gchar* readyPath = g_build_filename(slave->dataPath, "checkpoint.ready", NULL);
+    gchar* contents = g_strdup_printf("%i %"G_GUINT64_FORMAT"\n", (gint)getpid(), simClockNow);
+
+    GError* error = NULL;
+    if(!g_file_set_contents(readyPath, contents, -1, &error)) {
+        warning("skipping checkpoint at simtime %"G_GUINT64_FORMAT": unable to write '%s': %s",
+                simClockNow, readyPath, error->message);
+        g_error_free(error);
+    } else {
+        message("stopping for checkpoint at simtime %"G_GUINT64_FORMAT", send SIGCONT to pid %i to continue",
+                simClockNow, (gint)getpid());
+
+        /* make sure our messages are on their way to disk before we stop */
+        shadow_logger_flushRecords(shadow_logger_getDefault(), pthread_self());
+        shadow_logger_syncToDisk(shadow_logger_getDefault());
+
+        /* this stops every thread in the process, and returns after SIGCONT */
+        kill(getpid(), SIGSTOP);
+
+        /* we may now be running in a restored copy of the process */
+        g_unlink(readyPath);
+        message("continuing after checkpoint at simtime %"G_GUINT64_FORMAT" as pid %i",
+                simClockNow, (gint)getpid());
+    }
+
+    g_free(contents);
+    g_free(readyPath);
+}
+
+/* merges the path counters of the workers and writes out the current traffic matrix
+ * once per heartbeat interval. the workers must be waiting at the round barrier. */
+static void _slave_updateTrafficMatrix(Slave* slave, SimulationTime simClockNow) {
+    MAGIC_ASSERT(slave);
+
+    if(simClockNow <= (slave->simClockLastTrafficMatrix + options_getHeartbeatInterval(slave->options))) {
+        return;
+    }
+    slave->simClockLastTrafficMatrix = simClockNow;
+
+    _slave_lock(slave);
+    for(GList* item = slave->workerPathPacketCounts; item != NULL; item = g_list_next(item)) {
+        _slave_mergePathPacketCounts(slave->pathPacketCounts, item->data);
+    }
+    _slave_unlock(slave);
+
+    _slave_writeTrafficMatrix(slave);
+}
+
+/* returns our resident set size in bytes, or 0 if it is unknown */
+static guint64 _slave_getResidentMemory() {
+    gchar* contents = NULL;
+    if(!g_file_get_contents("/proc/self/statm", &contents, NULL, NULL)) {
+        return 0;
+    }
+
+    /* the second field is the number of resident pages */
+    guint64 residentPages = 0;
+    gchar** fields = g_strsplit(contents, " ", 3);
+    if(fields[0] && fields[1]) {
+        residentPages = g_ascii_strtoull(fields[1], NULL, 10);
+    }
+    g_strfreev(fields);
+    g_free(contents);
+
+    return residentPages * (guint64)sysconf(_SC_PAGESIZE);
+}
+
+static gint _slave_compareHostLastActiveTime(gconstpointer a, gconstpointer b, gpointer userData) {
+    SimulationTime ta = host_getLastActiveTime((Host*)a);
+    SimulationTime tb = host_getLastActiveTime((Host*)b);
+    return ta > tb ? +1 : ta == tb ? 0 : -1;
+}
+
+/* the memory budget we can enforce, which is none if we have no way to page out memory */
+static guint64 _slave_getMemoryBudget(Slave* slave) {
+#ifdef MADV_PAGEOUT
+    return options_getMemoryBudget(slave->options);
+#else
+    return 0;
+#endif
+}
+
+/* while our resident memory is over budget, pages out the plug-in memory of the hosts
+ * that have been idle the longest. spilled hosts page back in on their next event.
+ * the workers must be waiting at the round barrier. */
+static void _slave_spillIdleHosts(Slave* slave, SimulationTime simClockNow) {
+    MAGIC_ASSERT(slave);
+
+    guint64 budget = _slave_getMemoryBudget(slave);
+    if(budget == 0 || simClockNow < slave->simClockLastSpill + SIMTIME_ONE_SECOND) {
+        return;
+    }
+    slave->simClockLastSpill = simClockNow;
+
+    guint64 residentMemory = _slave_getResidentMemory();
+    if(residentMemory <= budget) {
+        return;
+    }
+
+    /* the coldest hosts are the least likely to need their memory back soon */
+    SimulationTime idleTime = options_getMemorySpillIdleTime(slave->options);
+    GQueue* candidates = scheduler_getHosts(slave->scheduler);
+    for(GList* item = g_queue_peek_head_link(candidates); item != NULL;) {
+        GList* next = g_list_next(item);
+        Host* host = item->data;
+        if(host_isSpilled(host) || host_getLastActiveTime(host) + idleTime > simClockNow) {
+            g_queue_delete_link(candidates, item);
+        }
+        item = next;
+    }
+    g_queue_sort(candidates, _slave_compareHostLastActiveTime, NULL);
+
+    guint64 overBudget = residentMemory - budget;
+    guint64 numBytesSpilled = 0;
+    guint numHostsSpilled = 0;
+    while(numBytesSpilled < overBudget && !g_queue_is_empty(candidates)) {
+        Host* host = g_queue_pop_head(candidates);
+        numBytesSpilled += host_spillMemory(host);
+        numHostsSpilled++;
+    }
+    g_queue_free(candidates);
+
+    info("resident memory of %"G_GUINT64_FORMAT" bytes exceeds the budget of %"G_GUINT64_FORMAT" bytes "
+            "at simtime %"G_GUINT64_FORMAT", paged out %"G_GUINT64_FORMAT" bytes of %u idle hosts",
+            residentMemory, budget, simClockNow, numBytesSpilled, numHostsSpilled);
+}
+
+static void _slave_startLiveMetrics(Slave* slave) {
+    MAGIC_ASSERT(slave);
+
+    guint numWorkers = options_getNWorkerThreads(slave->options);
+    GQueue* hosts = scheduler_getHosts(slave->scheduler);
+
+    gchar* metricsPath = g_build_filename(slave->dataPath, "live-metrics.bin", NULL);
+    slave->liveMetrics = livemetrics_new(metricsPath, numWorkers, g_queue_get_length(hosts), slave->endTime);
+    g_free(metricsPath);
+
+    if(slave->liveMetrics != NULL) {
+        while(!g_queue_is_empty(hosts)) {
+            Host* host = g_queue_pop_head(hosts);
+            livemetrics_addHost(slave->liveMetrics, host_getID(host), host_getName(host));
+        }
+    }
+
+    g_queue_free(hosts);
+}
+
+static void _slave_updateLiveMetrics(Slave* slave, SimulationTime simClockNow) {
+    MAGIC_ASSERT(slave);
+
+    if(slave->liveMetrics == NULL) {
+        return;
+    }
+
+    /* all workers are blocked at the barrier, so the counters are stable */
+    Statistics* snapshot = statistics_new();
+    _slave_lock(slave);
+    statistics_addAll(snapshot, slave->statistics);
+    for(GList* item = slave->workerStatistics; item != NULL; item = g_list_next(item)) {
+        statistics_addAll(snapshot, item->data);
+    }
+    _slave_unlock(slave);
+
+    /* objects are often freed by a different worker than the one that created
+     * them, so only the sums over all workers are meaningful */
+    guint64 numEventsPending = statistics_get(snapshot, STAT_EVENT_NEW) - statistics_get(snapshot, STAT_EVENT_FREE);
+    guint64 numPacketsAlive = statistics_get(snapshot, STAT_PACKET_NEW) - statistics_get(snapshot, STAT_PACKET_FREE);
+    statistics_free(snapshot);
+
+    livemetrics_updateRound(slave->liveMetrics, simClockNow, numEventsPending, numPacketsAlive);
+}
+
+/* these all happen while the workers wait at a round barrier, and a serial run
+ * has no rounds, so tell the user which of the requested ones we skip */
+static void _slave_warnIgnoredBarrierFeatures(Slave* slave) {
+    MAGIC_ASSERT(slave);
+
+    GString* ignored = g_string_new(NULL);
+    if(options_getCheckpointInterval(slave->options) > 0) {
+        g_string_append_printf(ignored, "%scheckpoints", ignored->len > 0 ? ", " : "");
+    }
+    if(_slave_getMemoryBudget(slave) > 0) {
+        g_string_append_printf(ignored, "%spaging out idle hosts", ignored->len > 0 ? ", " : "");
+    }
+    if(options_doRunLiveMetrics(slave->options)) {
+        g_string_append_printf(ignored, "%slive metrics", ignored->len > 0 ? ", " : "");
+    }
+    if(topology_getNextChangeTime(slave_getTopology(slave)) != SIMTIME_INVALID) {
+        g_string_append_printf(ignored, "%stopology changes", ignored->len > 0 ? ", " : "");
+    }
+
+    if(ignored->len > 0) {
+        warning("running without workers, so there are no round barriers; ignoring %s", ignored->str);
     }
+    g_string_free(ignored, TRUE);
 }
 
 void slave_run(Slave* slave) {
     MAGIC_ASSERT(slave);
     if(scheduler_getPolicy(slave->scheduler) == SP_SERIAL_GLOBAL) {
+        _slave_warnIgnoredBarrierFeatures(slave);
+
         scheduler_start(slave->scheduler);
 
         /* the main slave thread becomes the only worker and runs everything */
@@ -432,6 +797,11 @@ void slave_run(Slave* slave) {
         SimulationTime minNextEventTime = SIMTIME_INVALID;
         gboolean keepRunning = TRUE;
 
+        /* the workers only start using the metrics after the start barrier */
+        if(options_doRunLiveMetrics(slave->options)) {
+            _slave_startLiveMetrics(slave);
+        }
+
         scheduler_start(slave->scheduler);
 
         while(keepRunning) {
@@ -456,6 +826,12 @@ void slave_run(Slave* slave) {
             info("finished execution window [%"G_GUINT64_FORMAT"--%"G_GUINT64_FORMAT"] next event at %"G_GUINT64_FORMAT,
                     windowStart, windowEnd, minNextEventTime);
 
+            /* all workers are blocked at the barrier, so this is a consistent state */
+            _slave_updateLiveMetrics(slave, windowEnd);
+            _slave_updateTrafficMatrix(slave, windowEnd);
+            _slave_spillIdleHosts(slave, windowEnd);
+            _slave_checkpoint(slave, windowEnd);
+
             /* notify master that we finished this round, and the time of our next event
              * in order to fast-forward our execute window if possible */
             keepRunning = master_slaveFinishedCurrentRound(slave->master, minNextEventTime, &windowStart, &windowEnd);
@@ -477,26 +853,88 @@ const gchar* slave_getHostsRootPath(Slave* slave) {
     return slave->hostsPath;
 }
 
-void slave_storeCounts(Slave* slave, ObjectCounter* objectCounter) {
+void slave_registerStatistics(Slave* slave, Statistics* statistics) {
+    MAGIC_ASSERT(slave);
+    _slave_lock(slave);
+    slave->workerStatistics = g_list_prepend(slave->workerStatistics, statistics);
+    _slave_unlock(slave);
+}
+
+void slave_registerPathPacketCounts(Slave* slave, GHashTable* pathPacketCounts) {
+    MAGIC_ASSERT(slave);
+    _slave_lock(slave);
+    slave->workerPathPacketCounts = g_list_prepend(slave->workerPathPacketCounts, pathPacketCounts);
+    _slave_unlock(slave);
+}
+
+void slave_storePathPacketCounts(Slave* slave, GHashTable* pathPacketCounts) {
+    MAGIC_ASSERT(slave);
+    _slave_lock(slave);
+    slave->workerPathPacketCounts = g_list_remove(slave->workerPathPacketCounts, pathPacketCounts);
+    _slave_mergePathPacketCounts(slave->pathPacketCounts, pathPacketCounts);
+    _slave_unlock(slave);
+}
+
+void slave_storeStatistics(Slave* slave, Statistics* statistics) {
     MAGIC_ASSERT(slave);
     _slave_lock(slave);
-    if(slave->objectCounts) {
-        objectcounter_incrementAll(globalSlave->objectCounts, objectCounter);
+    slave->workerStatistics = g_list_remove(slave->workerStatistics, statistics);
+    if(slave->statistics) {
+        statistics_addAll(slave->statistics, statistics);
     }
     _slave_unlock(slave);
 }
 
-void slave_countObject(ObjectType otype, CounterType ctype) {
+void slave_incrementStatistic(StatisticsCounter counter) {
     if(globalSlave) {
         MAGIC_ASSERT(globalSlave);
         _slave_lock(globalSlave);
-        if(globalSlave->objectCounts) {
-            objectcounter_incrementOne(globalSlave->objectCounts, otype, ctype);
+        if(globalSlave->statistics) {
+            statistics_increment(globalSlave->statistics, counter);
         }
         _slave_unlock(globalSlave);
     }
 }
 
+LiveMetrics* slave_getLiveMetrics(Slave* slave) {
+    MAGIC_ASSERT(slave);
+    return slave->liveMetrics;
+}
+
+PacketTraceBuffer* slave_newPacketTraceBuffer(Slave* slave) {
+    MAGIC_ASSERT(slave);
+    if(slave->packetTrace != NULL) {
+        return packettrace_newBuffer(slave->packetTrace);
+    } else {
+        return NULL;
+    }
+}
+
+void slave_tracePacketStatus(SimulationTime time, guint packetHostID, guint64 packetID,
+        guint hostID, guint status) {
+    /* the buffer is only set up in slave_new, so skip the lock when tracing is off */
+    if(!globalSlave || !globalSlave->packetTraceBuffer) {
+        return;
+    }
+
+    MAGIC_ASSERT(globalSlave);
+    _slave_lock(globalSlave);
+    if(globalSlave->packetTraceBuffer) {
+        packettracebuffer_append(globalSlave->packetTraceBuffer, time,
+                packetHostID, packetID, hostID, status);
+    }
+    _slave_unlock(globalSlave);
+}
+
+gboolean slave_isLogLevelFiltered(LogLevel level) {
+    /* no host logs anything above the most verbose level we saw during setup */
+    if(globalSlave) {
+        return (level > globalSlave->maxLogLevel) ? TRUE : FALSE;
+    } else {
+        return FALSE;
+    }
+}
+
 SimulationTime slave_getBootstrapEndTime(Slave* slave) {
     MAGIC_ASSERT(slave);
     return slave->bootstrapEndTime;
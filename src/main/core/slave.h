@@ -27,8 +27,10 @@
 
 #include "main/core/master.h"
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/live_metrics.h"
 #include "main/core/support/options.h"
+#include "main/core/support/packet_trace.h"
+#include "main/core/support/statistics.h"
 #include "main/host/host.h"
 #include "main/routing/dns.h"
 #include "main/routing/topology.h"
@@ -62,8 +64,18 @@ void slave_addNewProgram(Slave* slave, const gchar* name, const gchar* path, con
 void slave_addNewVirtualHost(Slave* slave, HostParameters* params);
 void slave_addNewVirtualProcess(Slave* slave, gchar* hostName, gchar* pluginName, gchar* preloadName,
         SimulationTime startTime, SimulationTime stopTime, gchar* arguments);
+void slave_addNewTrafficModel(Slave* slave, gchar* hostName, TrafficModelParameters* params);
 
-void slave_storeCounts(Slave* slave, ObjectCounter* objectCounter);
-void slave_countObject(ObjectType otype, CounterType ctype);
+void slave_registerStatistics(Slave* slave, Statistics* statistics);
+void slave_storeStatistics(Slave* slave, Statistics* statistics);
+void slave_registerPathPacketCounts(Slave* slave, GHashTable* pathPacketCounts);
+void slave_storePathPacketCounts(Slave* slave, GHashTable* pathPacketCounts);
+void slave_incrementStatistic(StatisticsCounter counter);
+
+PacketTraceBuffer* slave_newPacketTraceBuffer(Slave* slave);
+LiveMetrics* slave_getLiveMetrics(Slave* slave);
+gboolean slave_isLogLevelFiltered(LogLevel level);
+void slave_tracePacketStatus(SimulationTime time, guint packetHostID, guint64 packetID,
+        guint hostID, guint status);
 
 #endif /* SHD_SLAVE_H_ */
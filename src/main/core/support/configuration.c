@@ -9,6 +9,7 @@
 #include <stddef.h>
 
 #include "main/core/support/definitions.h"
+#include "main/host/traffic_model.h"
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
 
@@ -172,6 +173,25 @@ static void _parser_freeProcessElement(ConfigurationProcessElement* process) {
     g_free(process);
 }
 
+static void _parser_freeTrafficElement(ConfigurationTrafficElement* traffic) {
+    utility_assert(traffic != NULL);
+
+    if(traffic->model.isSet) {
+        utility_assert(traffic->model.string != NULL);
+        g_string_free(traffic->model.string, TRUE);
+    }
+    if(traffic->peer.isSet) {
+        utility_assert(traffic->peer.string != NULL);
+        g_string_free(traffic->peer.string, TRUE);
+    }
+    if(traffic->protocol.isSet) {
+        utility_assert(traffic->protocol.string != NULL);
+        g_string_free(traffic->protocol.string, TRUE);
+    }
+
+    g_free(traffic);
+}
+
 static void _parser_freeHostElement(ConfigurationHostElement* host) {
     utility_assert(host != NULL);
 
@@ -222,6 +242,9 @@ static void _parser_freeHostElement(ConfigurationHostElement* host) {
     if(host->processes) {
         g_queue_free_full(host->processes, (GDestroyNotify)_parser_freeProcessElement);
     }
+    if(host->traffic) {
+        g_queue_free_full(host->traffic, (GDestroyNotify)_parser_freeTrafficElement);
+    }
 
     g_free(host);
 }
@@ -401,6 +424,7 @@ static GError* _parser_handlePluginAttributes(Parser* parser, const gchar** attr
 static GError* _parser_handleHostAttributes(Parser* parser, const gchar** attributeNames, const gchar** attributeValues) {
     ConfigurationHostElement* host = g_new0(ConfigurationHostElement, 1);
     host->processes = g_queue_new();
+    host->traffic = g_queue_new();
     GError* error = NULL;
 
     const gchar **nameCursor = attributeNames;
@@ -624,6 +648,110 @@ static GError* _parser_handleProcessAttributes(Parser* parser, const gchar** att
     return error;
 }
 
+static GError* _parser_handleTrafficAttributes(Parser* parser, const gchar** attributeNames, const gchar** attributeValues) {
+    ConfigurationTrafficElement* traffic = g_new0(ConfigurationTrafficElement, 1);
+    GError* error = NULL;
+
+    const gchar **nameCursor = attributeNames;
+    const gchar **valueCursor = attributeValues;
+
+    /* check the attributes */
+    while (!error && *nameCursor) {
+        const gchar* name = *nameCursor;
+        const gchar* value = *valueCursor;
+
+        debug("found attribute '%s=%s'", name, value);
+
+        if(!traffic->model.isSet && !g_ascii_strcasecmp(name, "model")) {
+            traffic->model.string = g_string_new(value);
+            traffic->model.isSet = TRUE;
+        } else if (!traffic->peer.isSet && !g_ascii_strcasecmp(name, "peer")) {
+            traffic->peer.string = g_string_new(value);
+            traffic->peer.isSet = TRUE;
+        } else if (!traffic->protocol.isSet && !g_ascii_strcasecmp(name, "protocol")) {
+            traffic->protocol.string = g_string_new(value);
+            traffic->protocol.isSet = TRUE;
+        } else if (!traffic->port.isSet && !g_ascii_strcasecmp(name, "port")) {
+            traffic->port.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->port.isSet = TRUE;
+        } else if (!traffic->starttime.isSet && !g_ascii_strcasecmp(name, "starttime")) {
+            traffic->starttime.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->starttime.isSet = TRUE;
+        } else if (!traffic->stoptime.isSet && !g_ascii_strcasecmp(name, "stoptime")) {
+            traffic->stoptime.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->stoptime.isSet = TRUE;
+        } else if (!traffic->size.isSet && !g_ascii_strcasecmp(name, "size")) {
+            traffic->size.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->size.isSet = TRUE;
+        } else if (!traffic->responsesize.isSet && !g_ascii_strcasecmp(name, "responsesize")) {
+            traffic->responsesize.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->responsesize.isSet = TRUE;
+        } else if (!traffic->interval.isSet && !g_ascii_strcasecmp(name, "interval")) {
+            /* milliseconds */
+            traffic->interval.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->interval.isSet = TRUE;
+        } else if (!traffic->ontime.isSet && !g_ascii_strcasecmp(name, "ontime")) {
+            /* milliseconds */
+            traffic->ontime.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->ontime.isSet = TRUE;
+        } else if (!traffic->offtime.isSet && !g_ascii_strcasecmp(name, "offtime")) {
+            /* milliseconds */
+            traffic->offtime.integer = g_ascii_strtoull(value, NULL, 10);
+            traffic->offtime.isSet = TRUE;
+        } else {
+            error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_UNKNOWN_ATTRIBUTE,
+                            "unknown 'traffic' attribute '%s'", name);
+        }
+
+        nameCursor++;
+        valueCursor++;
+    }
+
+    /* validate the values */
+    if(!error && (!traffic->model.isSet || !traffic->port.isSet || !traffic->starttime.isSet)) {
+        error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_MISSING_ATTRIBUTE,
+                "element 'traffic' requires attributes 'model' 'port' 'starttime'");
+    }
+
+    if(!error) {
+        TrafficModelType type = trafficmodel_typeFromString(traffic->model.string->str);
+        if(type == TM_NONE) {
+            error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                    "element 'traffic' attribute 'model' must be one of "
+                    "'fixedrate' 'onoff' 'requestresponse' 'server'");
+        } else if(type != TM_SERVER && !traffic->peer.isSet) {
+            error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_MISSING_ATTRIBUTE,
+                    "element 'traffic' with model '%s' requires attribute 'peer'",
+                    traffic->model.string->str);
+        }
+    }
+
+    if(!error && (traffic->port.integer == 0 || traffic->port.integer > G_MAXUINT16)) {
+        error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                "element 'traffic' attribute 'port' must be in the range [1, 65535]");
+    }
+
+    if(!error && traffic->protocol.isSet &&
+            g_ascii_strcasecmp(traffic->protocol.string->str, "tcp") &&
+            g_ascii_strcasecmp(traffic->protocol.string->str, "udp")) {
+        error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                "element 'traffic' attribute 'protocol' must be 'tcp' or 'udp'");
+    }
+
+    if(error) {
+        /* clean up */
+        _parser_freeTrafficElement(traffic);
+    } else {
+        /* no error, traffic configs get added to the most recent host */
+        ConfigurationHostElement* host = g_queue_peek_tail(parser->hosts);
+        utility_assert(host != NULL);
+
+        g_queue_push_tail(host->traffic, traffic);
+    }
+
+    return error;
+}
+
 static void _parser_handleHostChildStartElement(GMarkupParseContext* context,
         const gchar* elementName, const gchar** attributeNames,
         const gchar** attributeValues, gpointer userData, GError** error) {
@@ -636,6 +764,8 @@ static void _parser_handleHostChildStartElement(GMarkupParseContext* context,
     /* check for cluster child-level elements */
     if (!g_ascii_strcasecmp(elementName, "process") || !g_ascii_strcasecmp(elementName, "application")) {
         *error = _parser_handleProcessAttributes(parser, attributeNames, attributeValues);
+    } else if (!g_ascii_strcasecmp(elementName, "traffic")) {
+        *error = _parser_handleTrafficAttributes(parser, attributeNames, attributeValues);
     } else {
         *error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_UNKNOWN_ELEMENT,
                 "unknown 'host' child starting element '%s'", elementName);
@@ -651,7 +781,8 @@ static void _parser_handleHostChildEndElement(GMarkupParseContext* context,
     debug("found 'host' child ending element '%s'", elementName);
 
     /* check for cluster child-level elements */
-    if (!(!g_ascii_strcasecmp(elementName, "process")) && !(!g_ascii_strcasecmp(elementName, "application"))) {
+    if (!(!g_ascii_strcasecmp(elementName, "process")) && !(!g_ascii_strcasecmp(elementName, "application")) &&
+            !(!g_ascii_strcasecmp(elementName, "traffic"))) {
         *error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_UNKNOWN_ELEMENT,
                 "unknown 'host' child ending element '%s'", elementName);
     }
@@ -766,9 +897,9 @@ static void _parser_handleRootEndElement(GMarkupParseContext* context,
         /* validate children */
         ConfigurationHostElement* host = g_queue_peek_tail(parser->hosts);
         utility_assert(host != NULL);
-        if (g_queue_get_length(host->processes) <= 0) {
+        if (g_queue_get_length(host->processes) <= 0 && g_queue_get_length(host->traffic) <= 0) {
             *error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_EMPTY,
-                    "element 'host' requires at least 1 child 'process'");
+                    "element 'host' requires at least 1 child 'process' or 'traffic'");
         }
         g_markup_parse_context_pop(context);
     } else if(!g_ascii_strcasecmp(elementName, "topology")) {
@@ -62,11 +62,30 @@ struct _ConfigurationProcessElement {
     ConfigurationStringAttribute preload;
 };
 
+typedef struct _ConfigurationTrafficElement ConfigurationTrafficElement;
+struct _ConfigurationTrafficElement {
+    /* required */
+    ConfigurationStringAttribute model;
+    ConfigurationIntegerAttribute port;
+    ConfigurationIntegerAttribute starttime;
+    /* optional, but peer is required for all client models */
+    ConfigurationStringAttribute peer;
+    ConfigurationStringAttribute protocol;
+    ConfigurationIntegerAttribute stoptime;
+    ConfigurationIntegerAttribute size;
+    ConfigurationIntegerAttribute responsesize;
+    ConfigurationIntegerAttribute interval;
+    ConfigurationIntegerAttribute ontime;
+    ConfigurationIntegerAttribute offtime;
+};
+
 typedef struct _ConfigurationHostElement ConfigurationHostElement;
 struct _ConfigurationHostElement {
     /* required */
     ConfigurationStringAttribute id;
+    /* at least one process or traffic element is required */
     GQueue* processes;
+    GQueue* traffic;
     /* optional*/
     ConfigurationStringAttribute ipHint;
     ConfigurationStringAttribute citycodeHint;
@@ -0,0 +1,217 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include "main/core/support/live_metrics.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "main/utility/utility.h"
+#include "support/logger/logger.h"
+
+G_STATIC_ASSERT(sizeof(LiveMetricsHeader) == 112);
+G_STATIC_ASSERT(sizeof(LiveMetricsWorker) == 32);
+G_STATIC_ASSERT(sizeof(LiveMetricsHost) == 112);
+
+struct _LiveMetrics {
+    gchar* path;
+    gint fd;
+
+    /* the whole mapped file, and pointers to its parts */
+    gpointer region;
+    gsize regionSize;
+    LiveMetricsHeader* header;
+    LiveMetricsWorker* workers;
+    LiveMetricsHost* hosts;
+
+    /* host id to record index plus one, only changed before the workers start */
+    GHashTable* hostIndices;
+    guint numHostsAdded;
+
+    /* real time when the metrics were created and last updated, in microseconds */
+    gint64 startTime;
+    gint64 lastUpdateTime;
+    guint64 lastNumEventsExecuted;
+
+    MAGIC_DECLARE;
+};
+
+LiveMetrics* livemetrics_new(const gchar* path, guint numWorkers, guint numHosts, SimulationTime endTime) {
+    utility_assert(path);
+
+    gsize regionSize = sizeof(LiveMetricsHeader) +
+            numWorkers * sizeof(LiveMetricsWorker) + numHosts * sizeof(LiveMetricsHost);
+
+    gint fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        warning("unable to open live metrics file '%s': %s", path, g_strerror(errno));
+        return NULL;
+    }
+
+    /* the file is extended with zeros, so all records start out cleared */
+    if(ftruncate(fd, (off_t)regionSize) != 0) {
+        warning("unable to resize live metrics file '%s' to %"G_GSIZE_FORMAT" bytes: %s",
+                path, regionSize, g_strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    gpointer region = mmap(NULL, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(region == MAP_FAILED) {
+        warning("unable to map live metrics file '%s': %s", path, g_strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    LiveMetrics* metrics = g_new0(LiveMetrics, 1);
+    MAGIC_INIT(metrics);
+
+    metrics->path = g_strdup(path);
+    metrics->fd = fd;
+    metrics->region = region;
+    metrics->regionSize = regionSize;
+    metrics->header = region;
+    metrics->workers = (LiveMetricsWorker*)(metrics->header + 1);
+    metrics->hosts = (LiveMetricsHost*)(metrics->workers + numWorkers);
+    metrics->hostIndices = g_hash_table_new(g_direct_hash, g_direct_equal);
+    metrics->startTime = g_get_monotonic_time();
+    metrics->lastUpdateTime = metrics->startTime;
+
+    LiveMetricsHeader* header = metrics->header;
+    header->version = LIVE_METRICS_VERSION;
+    header->headerSize = (guint32)sizeof(LiveMetricsHeader);
+    header->workerRecordSize = (guint32)sizeof(LiveMetricsWorker);
+    header->hostRecordSize = (guint32)sizeof(LiveMetricsHost);
+    header->numWorkers = (guint32)numWorkers;
+    header->numHosts = (guint32)numHosts;
+    header->state = LIVE_METRICS_STATE_STARTING;
+    header->endTime = endTime;
+
+    /* readers check the magic last, so it goes in after everything else */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(header->magic, LIVE_METRICS_MAGIC, sizeof(header->magic));
+
+    message("writing live metrics for %u workers and %u hosts to '%s'", numWorkers, numHosts, path);
+
+    return metrics;
+}
+
+/* each record has a single writer, so only the readers need the atomics */
+static void _livemetrics_beginUpdate(guint64* sequence) {
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void _livemetrics_endUpdate(guint64* sequence) {
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELEASE);
+}
+
+void livemetrics_free(LiveMetrics* metrics) {
+    MAGIC_ASSERT(metrics);
+
+    _livemetrics_beginUpdate(&(metrics->header->sequence));
+    metrics->header->state = LIVE_METRICS_STATE_FINISHED;
+    _livemetrics_endUpdate(&(metrics->header->sequence));
+
+    munmap(metrics->region, metrics->regionSize);
+    close(metrics->fd);
+
+    g_hash_table_destroy(metrics->hostIndices);
+    g_free(metrics->path);
+
+    MAGIC_CLEAR(metrics);
+    g_free(metrics);
+}
+
+void livemetrics_addHost(LiveMetrics* metrics, GQuark hostID, const gchar* hostName) {
+    MAGIC_ASSERT(metrics);
+    utility_assert(metrics->numHostsAdded < metrics->header->numHosts);
+
+    guint index = metrics->numHostsAdded++;
+    g_hash_table_replace(metrics->hostIndices, GUINT_TO_POINTER(hostID), GUINT_TO_POINTER(index + 1));
+
+    /* longer names are cut, the record keeps the terminating null */
+    LiveMetricsHost* host = &(metrics->hosts[index]);
+    _livemetrics_beginUpdate(&(host->sequence));
+    g_strlcpy(host->name, hostName ? hostName : "", LIVE_METRICS_HOST_NAME_LENGTH);
+    _livemetrics_endUpdate(&(host->sequence));
+}
+
+void livemetrics_updateWorker(LiveMetrics* metrics, guint workerID,
+        guint64 numEventsExecuted, gdouble idleSeconds) {
+    MAGIC_ASSERT(metrics);
+
+    if(workerID >= metrics->header->numWorkers) {
+        return;
+    }
+
+    LiveMetricsWorker* worker = &(metrics->workers[workerID]);
+    _livemetrics_beginUpdate(&(worker->sequence));
+    worker->numRounds++;
+    worker->numEventsExecuted = numEventsExecuted;
+    worker->idleSeconds = idleSeconds;
+    _livemetrics_endUpdate(&(worker->sequence));
+}
+
+void livemetrics_updateHost(LiveMetrics* metrics, GQuark hostID, SimulationTime lastActiveTime,
+        gdouble executionSeconds, guint64 bytesSent, guint64 bytesReceived, guint64 allocatedBytes) {
+    MAGIC_ASSERT(metrics);
+
+    guint index = GPOINTER_TO_UINT(g_hash_table_lookup(metrics->hostIndices, GUINT_TO_POINTER(hostID)));
+    if(index == 0) {
+        return;
+    }
+
+    LiveMetricsHost* host = &(metrics->hosts[index - 1]);
+    _livemetrics_beginUpdate(&(host->sequence));
+    host->lastActiveTime = lastActiveTime;
+    host->executionSeconds = executionSeconds;
+    host->bytesSent = bytesSent;
+    host->bytesReceived = bytesReceived;
+    host->allocatedBytes = allocatedBytes;
+    _livemetrics_endUpdate(&(host->sequence));
+}
+
+void livemetrics_updateRound(LiveMetrics* metrics, SimulationTime simulationTime,
+        guint64 numEventsPending, guint64 numPacketsAlive) {
+    MAGIC_ASSERT(metrics);
+
+    /* the workers are waiting, so their records are complete for this round */
+    guint64 numEventsExecuted = 0;
+    for(guint i = 0; i < metrics->header->numWorkers; i++) {
+        numEventsExecuted += metrics->workers[i].numEventsExecuted;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    gdouble elapsedSeconds = ((gdouble)(now - metrics->lastUpdateTime)) / G_USEC_PER_SEC;
+
+    /* keep the rate over at least a second, so it does not jump around
+     * when rounds are short */
+    gboolean updateRate = elapsedSeconds >= 1.0f;
+
+    LiveMetricsHeader* header = metrics->header;
+    _livemetrics_beginUpdate(&(header->sequence));
+
+    header->state = LIVE_METRICS_STATE_RUNNING;
+    header->numRounds++;
+    header->simulationTime = simulationTime;
+    header->realTime = (guint64)(now - metrics->startTime) * SIMTIME_ONE_MICROSECOND;
+    header->numEventsExecuted = numEventsExecuted;
+    if(updateRate) {
+        header->eventsPerSecond = ((gdouble)(numEventsExecuted - metrics->lastNumEventsExecuted)) / elapsedSeconds;
+    }
+    header->numEventsPending = numEventsPending;
+    header->numPacketsAlive = numPacketsAlive;
+
+    _livemetrics_endUpdate(&(header->sequence));
+
+    if(updateRate) {
+        metrics->lastUpdateTime = now;
+        metrics->lastNumEventsExecuted = numEventsExecuted;
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SRC_MAIN_CORE_SUPPORT_SHD_LIVE_METRICS_H_
+#define SRC_MAIN_CORE_SUPPORT_SHD_LIVE_METRICS_H_
+
+#include <glib.h>
+
+#include "main/core/support/definitions.h"
+
+/*
+ * Live metrics are kept in a file that is mapped into memory and updated in
+ * place at round boundaries, so that an external tool can map the same file
+ * and watch a running simulation without parsing the log.
+ *
+ * The file starts with a LiveMetricsHeader, followed by an array of
+ * LiveMetricsWorker with one record per worker thread, followed by an array
+ * of LiveMetricsHost with one record per host. The counts and record sizes in
+ * the header never change after the file is created.
+ *
+ * The header and every record start with a sequence number. Only the slave
+ * thread writes the header, and every worker and host record has a single
+ * writer, which makes the sequence odd while it updates the record. Readers
+ * should retry a record while its sequence is odd or if it changed while they
+ * were reading. Host records are written whenever a worker moves on from the
+ * host, so they may be from a later point in the round than the header.
+ */
+
+#define LIVE_METRICS_MAGIC "SHDMETRC"
+#define LIVE_METRICS_VERSION 2
+
+/* the lengths of host names are limited so that host records have a fixed size */
+#define LIVE_METRICS_HOST_NAME_LENGTH 64
+
+typedef enum _LiveMetricsState LiveMetricsState;
+enum _LiveMetricsState {
+    LIVE_METRICS_STATE_STARTING = 0,
+    LIVE_METRICS_STATE_RUNNING = 1,
+    LIVE_METRICS_STATE_FINISHED = 2,
+};
+
+typedef struct _LiveMetricsHeader LiveMetricsHeader;
+struct _LiveMetricsHeader {
+    gchar magic[8];
+    guint32 version;
+    guint32 headerSize;
+    guint32 workerRecordSize;
+    guint32 hostRecordSize;
+    guint32 numWorkers;
+    guint32 numHosts;
+
+    /* odd while the fields below are being updated */
+    guint64 sequence;
+    /* a LiveMetricsState value */
+    guint64 state;
+    guint64 numRounds;
+    /* the simulation time up to which all events were executed, and at
+     * which the simulation will end */
+    guint64 simulationTime;
+    guint64 endTime;
+    /* real nanoseconds since the simulation started */
+    guint64 realTime;
+    /* events executed by all workers, and the rate since the last update */
+    guint64 numEventsExecuted;
+    gdouble eventsPerSecond;
+    /* events and packets that were created but not freed yet */
+    guint64 numEventsPending;
+    guint64 numPacketsAlive;
+};
+
+typedef struct _LiveMetricsWorker LiveMetricsWorker;
+struct _LiveMetricsWorker {
+    /* odd while the fields below are being updated */
+    guint64 sequence;
+    guint64 numRounds;
+    guint64 numEventsExecuted;
+    /* seconds spent waiting for the other workers at the end of a round */
+    gdouble idleSeconds;
+};
+
+typedef struct _LiveMetricsHost LiveMetricsHost;
+struct _LiveMetricsHost {
+    /* odd while the fields below are being updated */
+    guint64 sequence;
+    gchar name[LIVE_METRICS_HOST_NAME_LENGTH];
+    /* the simulation time of the last event the host executed */
+    guint64 lastActiveTime;
+    /* seconds the simulator spent executing the host's events */
+    gdouble executionSeconds;
+    /* header and payload bytes the host sent and received over all interfaces */
+    guint64 bytesSent;
+    guint64 bytesReceived;
+    /* bytes allocated by the host's processes, only tracked if the 'ram'
+     * heartbeat info is enabled for the host */
+    guint64 allocatedBytes;
+};
+
+typedef struct _LiveMetrics LiveMetrics;
+
+/* creates the metrics file at path with room for the given number of workers
+ * and hosts, and maps it. returns NULL if the file could not be mapped. */
+LiveMetrics* livemetrics_new(const gchar* path, guint numWorkers, guint numHosts, SimulationTime endTime);
+
+/* marks the simulation as finished and unmaps the file, which keeps the last values */
+void livemetrics_free(LiveMetrics* metrics);
+
+/* gives the host the next record. all hosts must be added by the slave
+ * before the workers start. */
+void livemetrics_addHost(LiveMetrics* metrics, GQuark hostID, const gchar* hostName);
+
+/* may only be called by the worker with the given id */
+void livemetrics_updateWorker(LiveMetrics* metrics, guint workerID,
+        guint64 numEventsExecuted, gdouble idleSeconds);
+
+/* may only be called by the thread that is running the host */
+void livemetrics_updateHost(LiveMetrics* metrics, GQuark hostID, SimulationTime lastActiveTime,
+        gdouble executionSeconds, guint64 bytesSent, guint64 bytesReceived, guint64 allocatedBytes);
+
+/* may only be called by the slave thread while the workers wait at the round barrier */
+void livemetrics_updateRound(LiveMetrics* metrics, SimulationTime simulationTime,
+        guint64 numEventsPending, guint64 numPacketsAlive);
+
+#endif /* SRC_MAIN_CORE_SUPPORT_SHD_LIVE_METRICS_H_ */
@@ -19,16 +19,25 @@ struct _Options {
     GOptionGroup* mainOptionGroup;
     gchar* logLevelInput;
     gint nWorkerThreads;
+    gboolean adaptiveWorkers;
     guint randomSeed;
     gboolean printSoftwareVersion;
     guint heartbeatInterval;
+    gint checkpointInterval;
     gchar* heartbeatLogLevelInput;
     gchar* heartbeatLogInfo;
     gchar* preloads;
     gboolean runValgrind;
     gboolean debug;
+    gboolean profileSyscalls;
+    gboolean hugePages;
+    gboolean fastShutdown;
+    gboolean liveMetrics;
     gchar* dataDirPath;
     gchar* dataTemplatePath;
+    gchar* topologyChangesPath;
+    gint memoryBudget;
+    gint memorySpillIdleTime;
 
     GOptionGroup* networkOptionGroup;
     gint cpuThreshold;
@@ -45,6 +54,8 @@ struct _Options {
     SimulationTime interfaceBatchTime;
     gchar* tcpCongestionControl;
     gint tcpSlowStartThreshold;
+    gboolean tcpLoopbackFastPath;
+    gboolean packetTrace;
 
     GOptionGroup* pluginsOptionGroup;
     gboolean runTGenExample;
@@ -81,21 +92,31 @@ Options* options_new(gint argc, gchar* argv[]) {
     options->cpuThreshold = -1;
     options->cpuPrecision = 200;
     options->heartbeatInterval = 1;
+    options->memorySpillIdleTime = 10;
 
     /* set options to change defaults for the main group */
     options->mainOptionGroup = g_option_group_new("main", "Main Options", "Primary simulator options", NULL, NULL);
     const GOptionEntry mainEntries[] = {
+      { "adaptive-workers", 0, 0, G_OPTION_ARG_NONE, &(options->adaptiveWorkers), "Park worker threads during rounds with too few events to keep them all busy, requires the 'steal' scheduler policy", NULL },
+      { "checkpoint-interval", 0, 0, G_OPTION_ARG_INT, &(options->checkpointInterval), "Stop the process at a round barrier every N simulated seconds so an external tool (e.g. CRIU) can checkpoint it, requires workers [0]", "N" },
       { "data-directory", 'd', 0, G_OPTION_ARG_STRING, &(options->dataDirPath), "PATH to store simulation output ['shadow.data']", "PATH" },
       { "data-template", 'e', 0, G_OPTION_ARG_STRING, &(options->dataTemplatePath), "PATH to recursively copy during startup and use as the data-directory ['shadow.data.template']", "PATH" },
+      { "fast-shutdown", 0, 0, G_OPTION_ARG_NONE, &(options->fastShutdown), "Only stop the processes and flush the outputs of every host at the end of the simulation, and leave the memory of the hosts and pending events to the OS instead of freeing it (ignored with --valgrind)", NULL },
       { "gdb", 'g', 0, G_OPTION_ARG_NONE, &(options->debug), "Pause at startup for debugger attachment", NULL },
       { "heartbeat-frequency", 'h', 0, G_OPTION_ARG_INT, &(options->heartbeatInterval), "Log node statistics every N seconds [1]", "N" },
       { "heartbeat-log-info", 'i', 0, G_OPTION_ARG_STRING, &(options->heartbeatLogInfo), "Comma separated list of information contained in heartbeat ('node','socket','ram') ['node']", "LIST"},
       { "heartbeat-log-level", 'j', 0, G_OPTION_ARG_STRING, &(options->heartbeatLogLevelInput), "Log LEVEL at which to print node statistics ['message']", "LEVEL" },
+      { "huge-pages", 0, 0, G_OPTION_ARG_NONE, &(options->hugePages), "Ask the kernel to back simulator allocations and plug-in code and data with transparent huge pages where it supports them", NULL },
+      { "memory-budget", 0, 0, G_OPTION_ARG_INT, &(options->memoryBudget), "Page out the plug-in memory of idle hosts at round barriers while the resident memory of the simulator exceeds N MiB, requires workers [0]", "N" },
+      { "memory-spill-idle", 0, 0, G_OPTION_ARG_INT, &(options->memorySpillIdleTime), "Only page out the memory of hosts that did not execute an event in the last N simulated seconds [10]", "N" },
+      { "live-metrics", 0, 0, G_OPTION_ARG_NONE, &(options->liveMetrics), "Keep simulation progress, worker, and host metrics up to date in the memory-mapped file 'live-metrics.bin' in the data-directory at every round, requires workers", NULL },
       { "log-level", 'l', 0, G_OPTION_ARG_STRING, &(options->logLevelInput), "Log LEVEL above which to filter messages ('error' < 'critical' < 'warning' < 'message' < 'info' < 'debug') ['message']", "LEVEL" },
       { "preload", 'p', 0, G_OPTION_ARG_STRING, &(options->preloads), "LD_PRELOAD environment VALUE to use for function interposition (/path/to/lib:...) [None]", "VALUE" },
+      { "profile-syscalls", 0, 0, G_OPTION_ARG_NONE, &(options->profileSyscalls), "Count the calls, time, and bytes of every emulated function in each process, and write them to the host data directories at shutdown", NULL },
       { "runahead", 'r', 0, G_OPTION_ARG_INT, &(options->minRunAhead), "If set, overrides the automatically calculated minimum TIME workers may run ahead when sending events between nodes, in milliseconds [0]", "TIME" },
       { "seed", 's', 0, G_OPTION_ARG_INT, &(options->randomSeed), "Initialize randomness for each thread using seed N [1]", "N" },
       { "scheduler-policy", 't', 0, G_OPTION_ARG_STRING, &(options->eventSchedulingPolicy), "The event scheduler's policy for thread synchronization ('thread', 'host', 'steal', 'threadXthread', 'threadXhost') ['steal']", "SPOL" },
+      { "topology-changes", 0, 0, G_OPTION_ARG_STRING, &(options->topologyChangesPath), "PATH to a file of link changes to apply to the topology at scheduled times, requires workers [None]", "PATH" },
       { "workers", 'w', 0, G_OPTION_ARG_INT, &(options->nWorkerThreads), "Run concurrently with N worker threads [0]", "N" },
       { "valgrind", 'x', 0, G_OPTION_ARG_NONE, &(options->runValgrind), "Run through valgrind for debugging", NULL },
       { "version", 'v', 0, G_OPTION_ARG_NONE, &(options->printSoftwareVersion), "Print software version and exit", NULL },
@@ -131,9 +152,11 @@ Options* options_new(gint argc, gchar* argv[]) {
       { "interface-batch", 0, 0, G_OPTION_ARG_INT, &(options->interfaceBatchTime), "Batch TIME for network interface sends and receives, in microseconds [5000]", "TIME" },
       { "interface-buffer", 0, 0, G_OPTION_ARG_INT, &(options->interfaceBufferSize), "Size of the network interface receive buffer, in bytes [1024000]", "N" },
       { "interface-qdisc", 0, 0, G_OPTION_ARG_STRING, &(options->interfaceQueuingDiscipline), "The interface queuing discipline QDISC used to select the next sendable socket ('fifo' or 'rr') ['fifo']", "QDISC" },
+      { "packet-trace", 0, 0, G_OPTION_ARG_NONE, &(options->packetTrace), "Record every packet delivery status change in the binary trace file 'packet-trace.bin' in the data-directory", NULL },
       { "socket-recv-buffer", 0, 0, G_OPTION_ARG_INT, &(options->initialSocketReceiveBufferSize), sockrecv->str, "N" },
       { "socket-send-buffer", 0, 0, G_OPTION_ARG_INT, &(options->initialSocketSendBufferSize), socksend->str, "N" },
       { "tcp-congestion-control", 0, 0, G_OPTION_ARG_STRING, &(options->tcpCongestionControl), "Congestion control algorithm to use for TCP ('aimd', 'reno', 'cubic') ['reno']", "TCPCC" },
+      { "tcp-loopback-fastpath", 0, 0, G_OPTION_ARG_NONE, &(options->tcpLoopbackFastPath), "Pass user data directly between TCP connections whose endpoints are on the same host, instead of sending packets. Connections are paired during the handshake, before any data is written", NULL },
       { "tcp-ssthresh", 0, 0, G_OPTION_ARG_INT, &(options->tcpSlowStartThreshold), "Set TCP ssthresh value instead of discovering it via packet loss or hystart [0]", "N" },
       { "tcp-windows", 0, 0, G_OPTION_ARG_INT, &(options->initialTCPWindow), "Initialize the TCP send, receive, and congestion windows to N packets [10]", "N" },
       { NULL },
@@ -181,6 +204,15 @@ Options* options_new(gint argc, gchar* argv[]) {
     if(options->heartbeatInterval < 1) {
         options->heartbeatInterval = 1;
     }
+    if(options->checkpointInterval < 0) {
+        options->checkpointInterval = 0;
+    }
+    if(options->memoryBudget < 0) {
+        options->memoryBudget = 0;
+    }
+    if(options->memorySpillIdleTime < 0) {
+        options->memorySpillIdleTime = 0;
+    }
     if(options->initialTCPWindow < 1) {
         options->initialTCPWindow = 1;
     }
@@ -252,6 +284,9 @@ void options_free(Options* options) {
     if(options->dataTemplatePath != NULL) {
         g_free(options->dataTemplatePath);
     }
+    if(options->topologyChangesPath != NULL) {
+        g_free(options->topologyChangesPath);
+    }
 
     /* groups are freed with the context */
     g_option_context_free(options->context);
@@ -276,6 +311,21 @@ SimulationTime options_getHeartbeatInterval(Options* options) {
     return options->heartbeatInterval * SIMTIME_ONE_SECOND;
 }
 
+SimulationTime options_getCheckpointInterval(Options* options) {
+    MAGIC_ASSERT(options);
+    return ((SimulationTime)options->checkpointInterval) * SIMTIME_ONE_SECOND;
+}
+
+guint64 options_getMemoryBudget(Options* options) {
+    MAGIC_ASSERT(options);
+    return ((guint64)options->memoryBudget) * 1024 * 1024;
+}
+
+SimulationTime options_getMemorySpillIdleTime(Options* options) {
+    MAGIC_ASSERT(options);
+    return ((SimulationTime)options->memorySpillIdleTime) * SIMTIME_ONE_SECOND;
+}
+
 LogInfoFlags options_toHeartbeatLogInfo(Options* options, const gchar* input) {
     LogInfoFlags flags = LOG_INFO_FLAGS_NONE;
     if(input) {
@@ -326,6 +376,11 @@ guint options_getNWorkerThreads(Options* options) {
     return options->nWorkerThreads > 0 ? (guint)options->nWorkerThreads : 0;
 }
 
+gboolean options_doAdaptWorkers(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->adaptiveWorkers;
+}
+
 const gchar* options_getArgumentString(Options* options) {
     MAGIC_ASSERT(options);
     return options->argstr;
@@ -341,6 +396,27 @@ gboolean options_doRunPrintVersion(Options* options) {
     return options->printSoftwareVersion;
 }
 
+gboolean options_doUseHugePages(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->hugePages;
+}
+
+gboolean options_doProfileSyscalls(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->profileSyscalls;
+}
+
+gboolean options_doRunLiveMetrics(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->liveMetrics;
+}
+
+gboolean options_doFastShutdown(Options* options) {
+    MAGIC_ASSERT(options);
+    /* valgrind is only useful for leak checking if we free everything */
+    return options->fastShutdown && !options->runValgrind;
+}
+
 gboolean options_doRunValgrind(Options* options) {
     MAGIC_ASSERT(options);
     return options->runValgrind;
@@ -351,6 +427,11 @@ gboolean options_doRunDebug(Options* options) {
     return options->debug;
 }
 
+gboolean options_doRunPacketTrace(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->packetTrace;
+}
+
 gboolean options_doRunTGenExample(Options* options) {
     MAGIC_ASSERT(options);
     return options->runTGenExample;
@@ -366,6 +447,11 @@ const gchar* options_getPreloadString(Options* options) {
     return options->preloads;
 }
 
+const gchar* options_getTopologyChangesPath(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->topologyChangesPath;
+}
+
 gint options_getCPUThreshold(Options* options) {
     MAGIC_ASSERT(options);
     return options->cpuThreshold;
@@ -426,6 +512,11 @@ gboolean options_doAutotuneSendBuffer(Options* options) {
     return options->autotuneSocketSendBuffer;
 }
 
+gboolean options_doTCPLoopbackFastPath(Options* options) {
+    MAGIC_ASSERT(options);
+    return options->tcpLoopbackFastPath;
+}
+
 const GString* options_getInputXMLFilename(Options* options) {
     MAGIC_ASSERT(options);
     return options->inputXMLFilename;
@@ -81,6 +81,23 @@ LogInfoFlags options_getHeartbeatLogInfo(Options* options);
  */
 SimulationTime options_getHeartbeatInterval(Options* options);
 
+/**
+ * Get the configured checkpoint interval.
+ * @param config a #Configuration object created with configuration_new()
+ * @return the command line checkpoint interval converted to SimulationTime,
+ * or 0 if checkpoints are disabled
+ */
+SimulationTime options_getCheckpointInterval(Options* options);
+
+/**
+ * Get the configured memory budget.
+ * @param config a #Configuration object created with configuration_new()
+ * @return the command line memory budget converted to bytes, or 0 if idle
+ * hosts should never be paged out
+ */
+guint64 options_getMemoryBudget(Options* options);
+SimulationTime options_getMemorySpillIdleTime(Options* options);
+
 /**
  * Get the string form that represents the queuing discipline the network
  * interface uses to select which of the sendable sockets should get priority.
@@ -92,15 +109,22 @@ QDiscMode options_getQueuingDiscipline(Options* options);
 gchar* options_getEventSchedulerPolicy(Options* options);
 
 guint options_getNWorkerThreads(Options* options);
+gboolean options_doAdaptWorkers(Options* options);
 
 const gchar* options_getArgumentString(Options* options);
 const gchar* options_getHeartbeatLogInfoString(Options* options);
 const gchar* options_getPreloadString(Options* options);
+const gchar* options_getTopologyChangesPath(Options* options);
 guint options_getRandomSeed(Options* options);
 
 gboolean options_doRunPrintVersion(Options* options);
 gboolean options_doRunValgrind(Options* options);
 gboolean options_doRunDebug(Options* options);
+gboolean options_doRunPacketTrace(Options* options);
+gboolean options_doProfileSyscalls(Options* options);
+gboolean options_doUseHugePages(Options* options);
+gboolean options_doFastShutdown(Options* options);
+gboolean options_doRunLiveMetrics(Options* options);
 gboolean options_doRunTGenExample(Options* options);
 gboolean options_doRunTestExample(Options* options);
 
@@ -117,6 +141,7 @@ gint options_getSocketReceiveBufferSize(Options* options);
 gint options_getSocketSendBufferSize(Options* options);
 gboolean options_doAutotuneReceiveBuffer(Options* options);
 gboolean options_doAutotuneSendBuffer(Options* options);
+gboolean options_doTCPLoopbackFastPath(Options* options);
 
 const GString* options_getInputXMLFilename(Options* options);
 
@@ -0,0 +1,224 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include "main/core/support/packet_trace.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/utility/utility.h"
+#include "support/logger/logger.h"
+
+/* number of records in each ring, must be a power of 2 */
+#define PACKET_TRACE_BUFFER_CAPACITY (1 << 15)
+#define PACKET_TRACE_BUFFER_MASK (PACKET_TRACE_BUFFER_CAPACITY - 1)
+/* how long the writer sleeps when all rings are empty, in microseconds */
+#define PACKET_TRACE_IDLE_SLEEP 1000
+/* keep the producer and consumer positions on separate cache lines */
+#define PACKET_TRACE_CACHE_LINE_SIZE 64
+
+G_STATIC_ASSERT(sizeof(PacketTraceHeader) == 16);
+G_STATIC_ASSERT(sizeof(PacketTraceRecord) == 32);
+
+struct _PacketTraceBuffer {
+    /* the next position to write, only changed by the producer */
+    guint64 head __attribute__((aligned(PACKET_TRACE_CACHE_LINE_SIZE)));
+    /* the next position to read, only changed by the writer thread */
+    guint64 tail __attribute__((aligned(PACKET_TRACE_CACHE_LINE_SIZE)));
+    PacketTraceRecord records[PACKET_TRACE_BUFFER_CAPACITY] __attribute__((aligned(PACKET_TRACE_CACHE_LINE_SIZE)));
+};
+
+struct _PacketTrace {
+    FILE* file;
+    gchar* path;
+
+    /* protects the list of buffers */
+    GMutex lock;
+    GList* buffers;
+
+    pthread_t writer;
+    gboolean stopWriter;
+
+    guint64 numRecordsWritten;
+
+    MAGIC_DECLARE;
+};
+
+static PacketTraceBuffer* _packettracebuffer_new() {
+    gpointer memory = NULL;
+    gint result = posix_memalign(&memory, PACKET_TRACE_CACHE_LINE_SIZE, sizeof(PacketTraceBuffer));
+    utility_assert(result == 0 && memory != NULL);
+    /* we only need to clear the positions, the records are written before they are read */
+    PacketTraceBuffer* buffer = memory;
+    buffer->head = 0;
+    buffer->tail = 0;
+    return buffer;
+}
+
+static void _packettracebuffer_free(PacketTraceBuffer* buffer) {
+    /* allocated with posix_memalign */
+    free(buffer);
+}
+
+/* writes all records that are currently in the buffer to the file,
+ * and returns the number of records written */
+static guint64 _packettracebuffer_drain(PacketTraceBuffer* buffer, FILE* file) {
+    guint64 tail = buffer->tail;
+    guint64 head = __atomic_load_n(&(buffer->head), __ATOMIC_ACQUIRE);
+    guint64 numWritten = 0;
+
+    while(tail < head) {
+        /* write the contiguous segment up to the end of the ring */
+        guint64 index = tail & PACKET_TRACE_BUFFER_MASK;
+        guint64 count = MIN(head - tail, PACKET_TRACE_BUFFER_CAPACITY - index);
+
+        gsize n = fwrite(&(buffer->records[index]), sizeof(PacketTraceRecord), (gsize)count, file);
+        if(n != count) {
+            warning("packet trace: wrote %"G_GSIZE_FORMAT" of %"G_GUINT64_FORMAT" records", n, count);
+        }
+
+        tail += count;
+        numWritten += count;
+    }
+
+    /* release the slots back to the producer */
+    __atomic_store_n(&(buffer->tail), tail, __ATOMIC_RELEASE);
+    return numWritten;
+}
+
+static guint64 _packettrace_drainAll(PacketTrace* trace) {
+    guint64 numWritten = 0;
+    g_mutex_lock(&(trace->lock));
+    for(GList* item = trace->buffers; item != NULL; item = g_list_next(item)) {
+        numWritten += _packettracebuffer_drain(item->data, trace->file);
+    }
+    g_mutex_unlock(&(trace->lock));
+    return numWritten;
+}
+
+static gpointer _packettrace_runWriterThread(PacketTrace* trace) {
+    MAGIC_ASSERT(trace);
+
+    while(!__atomic_load_n(&(trace->stopWriter), __ATOMIC_ACQUIRE)) {
+        guint64 numWritten = _packettrace_drainAll(trace);
+        trace->numRecordsWritten += numWritten;
+        if(numWritten == 0) {
+            g_usleep(PACKET_TRACE_IDLE_SLEEP);
+        }
+    }
+
+    /* the producers are done by the time we are stopped, so get the rest */
+    trace->numRecordsWritten += _packettrace_drainAll(trace);
+    fflush(trace->file);
+
+    return NULL;
+}
+
+PacketTrace* packettrace_new(const gchar* path) {
+    utility_assert(path);
+
+    FILE* file = fopen(path, "wb");
+    if(file == NULL) {
+        warning("unable to open packet trace file '%s': %s", path, g_strerror(errno));
+        return NULL;
+    }
+
+    PacketTraceHeader header;
+    memset(&header, 0, sizeof(PacketTraceHeader));
+    memcpy(header.magic, PACKET_TRACE_MAGIC, sizeof(header.magic));
+    header.version = PACKET_TRACE_VERSION;
+    header.recordSize = (guint32)sizeof(PacketTraceRecord);
+    if(fwrite(&header, sizeof(PacketTraceHeader), 1, file) != 1) {
+        warning("unable to write packet trace header to '%s'", path);
+        fclose(file);
+        return NULL;
+    }
+
+    PacketTrace* trace = g_new0(PacketTrace, 1);
+    MAGIC_INIT(trace);
+
+    trace->file = file;
+    trace->path = g_strdup(path);
+    g_mutex_init(&(trace->lock));
+
+    gint returnVal = pthread_create(&(trace->writer), NULL,
+            (void*(*)(void*))_packettrace_runWriterThread, trace);
+    if(returnVal != 0) {
+        warning("unable to create packet trace writer thread: error %i", returnVal);
+        g_mutex_clear(&(trace->lock));
+        g_free(trace->path);
+        fclose(trace->file);
+        MAGIC_CLEAR(trace);
+        g_free(trace);
+        return NULL;
+    }
+
+    pthread_setname_np(trace->writer, "packet-trace");
+
+    message("writing packet trace records to '%s'", path);
+    return trace;
+}
+
+void packettrace_free(PacketTrace* trace) {
+    MAGIC_ASSERT(trace);
+
+    /* wait for the writer to drain everything that is left. the workers are
+     * gone by now, so nothing else will touch the buffers while it exits. */
+    __atomic_store_n(&(trace->stopWriter), TRUE, __ATOMIC_RELEASE);
+    gint returnVal = pthread_join(trace->writer, NULL);
+    if(returnVal != 0) {
+        warning("unable to join packet trace writer thread: error %i", returnVal);
+    }
+
+    message("wrote %"G_GUINT64_FORMAT" packet trace records to '%s'",
+            trace->numRecordsWritten, trace->path);
+
+    g_list_free_full(trace->buffers, (GDestroyNotify)_packettracebuffer_free);
+    g_mutex_clear(&(trace->lock));
+
+    fclose(trace->file);
+    g_free(trace->path);
+
+    MAGIC_CLEAR(trace);
+    g_free(trace);
+}
+
+PacketTraceBuffer* packettrace_newBuffer(PacketTrace* trace) {
+    MAGIC_ASSERT(trace);
+
+    PacketTraceBuffer* buffer = _packettracebuffer_new();
+
+    g_mutex_lock(&(trace->lock));
+    trace->buffers = g_list_prepend(trace->buffers, buffer);
+    g_mutex_unlock(&(trace->lock));
+
+    return buffer;
+}
+
+void packettracebuffer_append(PacketTraceBuffer* buffer, SimulationTime time,
+        guint packetHostID, guint64 packetID, guint hostID, guint status) {
+    utility_assert(buffer);
+
+    guint64 head = buffer->head;
+
+    /* wait for the writer thread to free up a slot, we never drop records */
+    while(head - __atomic_load_n(&(buffer->tail), __ATOMIC_ACQUIRE) >= PACKET_TRACE_BUFFER_CAPACITY) {
+        g_thread_yield();
+    }
+
+    PacketTraceRecord* record = &(buffer->records[head & PACKET_TRACE_BUFFER_MASK]);
+    record->time = (guint64)time;
+    record->packetID = packetID;
+    record->packetHostID = (guint32)packetHostID;
+    record->hostID = (guint32)hostID;
+    record->status = (guint32)status;
+    record->reserved = 0;
+
+    /* publish the record to the writer thread */
+    __atomic_store_n(&(buffer->head), head + 1, __ATOMIC_RELEASE);
+}
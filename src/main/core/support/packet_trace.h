@@ -0,0 +1,69 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SRC_MAIN_CORE_SUPPORT_SHD_PACKET_TRACE_H_
+#define SRC_MAIN_CORE_SUPPORT_SHD_PACKET_TRACE_H_
+
+#include <glib.h>
+
+#include "main/core/support/definitions.h"
+
+/*
+ * Packet tracing records every packet delivery status change as a fixed-size
+ * binary record. Each worker appends records to its own single-producer ring
+ * buffer without allocating or locking, and a background thread drains all
+ * of the rings into the trace file.
+ *
+ * The trace file starts with a PacketTraceHeader, followed by a flat array of
+ * PacketTraceRecord. Records from different workers are interleaved in the
+ * order they were drained, so readers should sort by time if needed.
+ */
+
+#define PACKET_TRACE_MAGIC "SHDPKTTR"
+#define PACKET_TRACE_VERSION 1
+
+typedef struct _PacketTraceHeader PacketTraceHeader;
+struct _PacketTraceHeader {
+    gchar magic[8];
+    guint32 version;
+    guint32 recordSize;
+};
+
+typedef struct _PacketTraceRecord PacketTraceRecord;
+struct _PacketTraceRecord {
+    /* the simulation time at which the status was added */
+    guint64 time;
+    /* the packet is uniquely identified by the host that created it and
+     * the id it was given on that host */
+    guint64 packetID;
+    guint32 packetHostID;
+    /* the host on which the status was added, or 0 if none was active */
+    guint32 hostID;
+    /* a single PacketDeliveryStatusFlags value */
+    guint32 status;
+    guint32 reserved;
+};
+
+typedef struct _PacketTrace PacketTrace;
+typedef struct _PacketTraceBuffer PacketTraceBuffer;
+
+/* opens the trace file at path and starts the writer thread.
+ * returns NULL if the file could not be opened. */
+PacketTrace* packettrace_new(const gchar* path);
+
+/* stops the writer thread, writes all remaining records, and closes the file.
+ * no buffer of this trace may be used after this is called. */
+void packettrace_free(PacketTrace* trace);
+
+/* returns a new ring buffer that is drained by the trace writer thread. the
+ * buffer is owned by the trace and freed in packettrace_free(). */
+PacketTraceBuffer* packettrace_newBuffer(PacketTrace* trace);
+
+/* appends a record to the buffer. only one thread at a time may append to a
+ * buffer. blocks while the buffer is full. */
+void packettracebuffer_append(PacketTraceBuffer* buffer, SimulationTime time,
+        guint packetHostID, guint64 packetID, guint hostID, guint status);
+
+#endif /* SRC_MAIN_CORE_SUPPORT_SHD_PACKET_TRACE_H_ */
@@ -0,0 +1,87 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include "main/core/support/statistics.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/utility/utility.h"
+
+G_STATIC_ASSERT(sizeof(Statistics) % STATISTICS_CACHE_LINE_SIZE == 0);
+G_STATIC_ASSERT(STAT_TIMER_FREE == STATISTICS_OBJECT_COUNTER(OBJECT_TYPE_TIMER, COUNTER_TYPE_FREE));
+
+static const gchar* _statisticsCounterNames[STAT_NUM_COUNTERS] = {
+#define STATISTICS_COUNTER_NAME(id, name) name,
+    STATISTICS_COUNTER_LIST(STATISTICS_COUNTER_NAME)
+#undef STATISTICS_COUNTER_NAME
+};
+
+Statistics* statistics_new() {
+    gpointer memory = NULL;
+    gint result = posix_memalign(&memory, STATISTICS_CACHE_LINE_SIZE, sizeof(Statistics));
+    utility_assert(result == 0 && memory != NULL);
+    memset(memory, 0, sizeof(Statistics));
+    return (Statistics*) memory;
+}
+
+void statistics_free(Statistics* stats) {
+    utility_assert(stats);
+    /* allocated with posix_memalign */
+    free(stats);
+}
+
+guint64 statistics_get(const Statistics* stats, StatisticsCounter counter) {
+    utility_assert(stats);
+    utility_assert(counter < STAT_NUM_COUNTERS);
+    return __atomic_load_n(&(stats->values[counter]), __ATOMIC_RELAXED);
+}
+
+const gchar* statistics_getName(StatisticsCounter counter) {
+    utility_assert(counter < STAT_NUM_COUNTERS);
+    return _statisticsCounterNames[counter];
+}
+
+void statistics_addAll(Statistics* total, const Statistics* increment) {
+    utility_assert(total);
+    utility_assert(increment);
+
+    for(gint i = 0; i < STAT_NUM_COUNTERS; i++) {
+        statistics_add(total, (StatisticsCounter)i, statistics_get(increment, (StatisticsCounter)i));
+    }
+}
+
+gchar* statistics_valuesToString(const Statistics* stats) {
+    utility_assert(stats);
+
+    GString* buffer = g_string_new("Statistics: counter values: ");
+    for(gint i = 0; i < STAT_NUM_COUNTERS; i++) {
+        g_string_append_printf(buffer, "%s=%"G_GUINT64_FORMAT" ",
+                statistics_getName((StatisticsCounter)i), statistics_get(stats, (StatisticsCounter)i));
+    }
+
+    return g_string_free(buffer, FALSE);
+}
+
+gchar* statistics_objectDiffsToString(const Statistics* stats) {
+    utility_assert(stats);
+
+    /* keep the old object counter prefix, test/leakcheck.sh searches for it */
+    GString* buffer = g_string_new("ObjectCounter: counter diffs: ");
+    for(gint otype = OBJECT_TYPE_TASK; otype <= OBJECT_TYPE_TIMER; otype++) {
+        StatisticsCounter newCounter = STATISTICS_OBJECT_COUNTER(otype, COUNTER_TYPE_NEW);
+        StatisticsCounter freeCounter = STATISTICS_OBJECT_COUNTER(otype, COUNTER_TYPE_FREE);
+
+        /* strip the '_new' suffix to get the object name */
+        const gchar* name = statistics_getName(newCounter);
+        gsize nameLength = strlen(name) - strlen("_new");
+
+        g_string_append_printf(buffer, "%.*s=%"G_GUINT64_FORMAT" ", (gint)nameLength, name,
+                statistics_get(stats, newCounter) - statistics_get(stats, freeCounter));
+    }
+
+    return g_string_free(buffer, FALSE);
+}
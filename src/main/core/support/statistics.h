@@ -0,0 +1,137 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SRC_MAIN_CORE_SUPPORT_SHD_STATISTICS_H_
+#define SRC_MAIN_CORE_SUPPORT_SHD_STATISTICS_H_
+
+#include <glib.h>
+
+/* the size we pad and align each counter array to, so that the arrays of
+ * different workers never share a cache line */
+#define STATISTICS_CACHE_LINE_SIZE 64
+
+/*
+ * All counters are registered here at compile time. Each entry is
+ * X(counter enum id, counter name as printed in the log). To add a new
+ * counter, add it to this list and call worker_incrementStatistic() where
+ * it should be counted.
+ *
+ * The object counters must stay grouped in NEW/FREE pairs in the same order
+ * as ObjectType, since the object counter index is computed from it.
+ */
+#define STATISTICS_COUNTER_LIST(X) \
+    X(STAT_TASK_NEW, "task_new") \
+    X(STAT_TASK_FREE, "task_free") \
+    X(STAT_EVENT_NEW, "event_new") \
+    X(STAT_EVENT_FREE, "event_free") \
+    X(STAT_PACKET_NEW, "packet_new") \
+    X(STAT_PACKET_FREE, "packet_free") \
+    X(STAT_PAYLOAD_NEW, "payload_new") \
+    X(STAT_PAYLOAD_FREE, "payload_free") \
+    X(STAT_ROUTER_NEW, "router_new") \
+    X(STAT_ROUTER_FREE, "router_free") \
+    X(STAT_HOST_NEW, "host_new") \
+    X(STAT_HOST_FREE, "host_free") \
+    X(STAT_NETIFACE_NEW, "netiface_new") \
+    X(STAT_NETIFACE_FREE, "netiface_free") \
+    X(STAT_PROCESS_NEW, "process_new") \
+    X(STAT_PROCESS_FREE, "process_free") \
+    X(STAT_DESCRIPTOR_NEW, "descriptor_new") \
+    X(STAT_DESCRIPTOR_FREE, "descriptor_free") \
+    X(STAT_CHANNEL_NEW, "channel_new") \
+    X(STAT_CHANNEL_FREE, "channel_free") \
+    X(STAT_TCP_NEW, "tcp_new") \
+    X(STAT_TCP_FREE, "tcp_free") \
+    X(STAT_UDP_NEW, "udp_new") \
+    X(STAT_UDP_FREE, "udp_free") \
+    X(STAT_EPOLL_NEW, "epoll_new") \
+    X(STAT_EPOLL_FREE, "epoll_free") \
+    X(STAT_TIMER_NEW, "timer_new") \
+    X(STAT_TIMER_FREE, "timer_free") \
+    X(STAT_EVENT_EXECUTED, "event_executed") \
+    X(STAT_EVENT_CPU_DELAYED, "event_cpu_delayed") \
+    X(STAT_PACKET_SENT, "packet_sent") \
+    X(STAT_PACKET_DROPPED_INET, "packet_dropped_inet") \
+    X(STAT_PACKET_DROPPED_ROUTER, "packet_dropped_router") \
+    X(STAT_PACKET_DROPPED_INTERFACE, "packet_dropped_interface") \
+    X(STAT_PACKET_DROPPED_SOCKET, "packet_dropped_socket")
+
+typedef enum _StatisticsCounter StatisticsCounter;
+enum _StatisticsCounter {
+#define STATISTICS_COUNTER_ENUM(id, name) id,
+    STATISTICS_COUNTER_LIST(STATISTICS_COUNTER_ENUM)
+#undef STATISTICS_COUNTER_ENUM
+    STAT_NUM_COUNTERS
+};
+
+typedef enum _ObjectType ObjectType;
+enum _ObjectType {
+    OBJECT_TYPE_NONE,
+    OBJECT_TYPE_TASK,
+    OBJECT_TYPE_EVENT,
+    OBJECT_TYPE_PACKET,
+    OBJECT_TYPE_PAYLOAD,
+    OBJECT_TYPE_ROUTER,
+    OBJECT_TYPE_HOST,
+    OBJECT_TYPE_NETIFACE,
+    OBJECT_TYPE_PROCESS,
+    OBJECT_TYPE_DESCRIPTOR,
+    OBJECT_TYPE_CHANNEL,
+    OBJECT_TYPE_TCP,
+    OBJECT_TYPE_UDP,
+    OBJECT_TYPE_EPOLL,
+    OBJECT_TYPE_TIMER,
+};
+
+typedef enum _CounterType CounterType;
+enum _CounterType {
+    COUNTER_TYPE_NONE,
+    COUNTER_TYPE_NEW,
+    COUNTER_TYPE_FREE,
+};
+
+/* maps an object type and counter type to its registered counter */
+#define STATISTICS_OBJECT_COUNTER(otype, ctype) \
+    ((StatisticsCounter)(STAT_TASK_NEW + (((otype) - OBJECT_TYPE_TASK) * 2) + ((ctype) - COUNTER_TYPE_NEW)))
+
+/*
+ * A flat array of counter values. Each worker owns one and is the only
+ * thread that writes to it, so increments are plain (relaxed) stores.
+ * Other threads may read it at any time to aggregate.
+ */
+typedef struct _Statistics Statistics;
+struct _Statistics {
+    guint64 values[STAT_NUM_COUNTERS];
+} __attribute__((aligned(STATISTICS_CACHE_LINE_SIZE)));
+
+Statistics* statistics_new();
+void statistics_free(Statistics* stats);
+
+/* only the owner thread may call these */
+static inline void statistics_add(Statistics* stats, StatisticsCounter counter, guint64 value) {
+    __atomic_store_n(&(stats->values[counter]), stats->values[counter] + value, __ATOMIC_RELAXED);
+}
+
+static inline void statistics_increment(Statistics* stats, StatisticsCounter counter) {
+    statistics_add(stats, counter, 1);
+}
+
+/* safe to call from any thread */
+guint64 statistics_get(const Statistics* stats, StatisticsCounter counter);
+const gchar* statistics_getName(StatisticsCounter counter);
+
+/* add all counter values from 'increment' into the values of 'total'.
+ * only the owner of 'total' may call this. */
+void statistics_addAll(Statistics* total, const Statistics* increment);
+
+/* returns a newly allocated string containing all counter values, which
+ * the caller should free with g_free */
+gchar* statistics_valuesToString(const Statistics* stats);
+
+/* returns a newly allocated string containing the differences between the
+ * new and free object counters, which the caller should free with g_free */
+gchar* statistics_objectDiffsToString(const Statistics* stats);
+
+#endif /* SRC_MAIN_CORE_SUPPORT_SHD_STATISTICS_H_ */
@@ -7,43 +7,167 @@
 
 #include <stddef.h>
 
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/host/cpu.h"
+#include "main/host/descriptor/descriptor.h"
 #include "main/host/host.h"
 #include "main/host/tracker.h"
+#include "main/routing/router.h"
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
 
 struct _Event {
     Host* srcHost;
     Host* dstHost;
-    Task* task;
+    EventType type;
+    union {
+        Task* task;
+        Packet* packet;
+        struct {
+            NetworkInterface* interface;
+            Packet* packet;
+        } localPacket;
+        struct {
+            TCP* tcp;
+            EventSocketTimer timer;
+        } socketTimer;
+        struct {
+            Timer* timer;
+            guint expireID;
+        } timerExpire;
+        NetworkInterface* interface;
+        Epoll* epoll;
+        Tracker* tracker;
+    } data;
     SimulationTime time;
+    /* the time the event was scheduled for. it is earlier than time if a blocked
+     * cpu held the event back, and keeps its place among the host's events. */
+    SimulationTime scheduledTime;
     guint64 srcHostEventID;
     gint referenceCount;
     MAGIC_DECLARE;
 };
 
-Event* event_new_(Task* task, SimulationTime time, gpointer srcHost, gpointer dstHost) {
-    utility_assert(task != NULL);
+static Event* _event_new(EventType type) {
     Event* event = g_new0(Event, 1);
     MAGIC_INIT(event);
 
+    event->type = type;
+    event->referenceCount = 1;
+
+    worker_countObject(OBJECT_TYPE_EVENT, COUNTER_TYPE_NEW);
+    return event;
+}
+
+static void _event_setHosts(Event* event, SimulationTime time, gpointer srcHost, gpointer dstHost) {
     event->srcHost = (Host*)srcHost;
     event->dstHost = (Host*)dstHost;
-    event->task = task;
-    task_ref(event->task);
     event->time = time;
+    event->scheduledTime = time;
     event->srcHostEventID = host_getNewEventID(srcHost);
-    event->referenceCount = 1;
+}
 
-    worker_countObject(OBJECT_TYPE_EVENT, COUNTER_TYPE_NEW);
+Event* event_new_(Task* task, SimulationTime time, gpointer srcHost, gpointer dstHost) {
+    utility_assert(task != NULL);
+    Event* event = _event_new(EVENT_TYPE_TASK);
+    _event_setHosts(event, time, srcHost, dstHost);
+    event->data.task = task;
+    task_ref(event->data.task);
+    return event;
+}
+
+Event* event_newPacket(Packet* packet, SimulationTime time, gpointer srcHost, gpointer dstHost) {
+    utility_assert(packet != NULL);
+    Event* event = _event_new(EVENT_TYPE_PACKET);
+    _event_setHosts(event, time, srcHost, dstHost);
+    event->data.packet = packet;
+    return event;
+}
+
+Event* event_newLocalPacket(NetworkInterface* interface, Packet* packet) {
+    utility_assert(interface != NULL && packet != NULL);
+    Event* event = _event_new(EVENT_TYPE_LOCAL_PACKET);
+    event->data.localPacket.interface = interface;
+    event->data.localPacket.packet = packet;
+    return event;
+}
+
+Event* event_newSocketTimer(TCP* tcp, EventSocketTimer timer) {
+    utility_assert(tcp != NULL);
+    Event* event = _event_new(EVENT_TYPE_SOCKET_TIMER);
+    event->data.socketTimer.tcp = tcp;
+    event->data.socketTimer.timer = timer;
+    return event;
+}
+
+Event* event_newTimerExpire(Timer* timer, guint expireID) {
+    utility_assert(timer != NULL);
+    Event* event = _event_new(EVENT_TYPE_TIMER_EXPIRE);
+    event->data.timerExpire.timer = timer;
+    event->data.timerExpire.expireID = expireID;
+    return event;
+}
+
+Event* event_newInterfaceRefill(NetworkInterface* interface) {
+    utility_assert(interface != NULL);
+    Event* event = _event_new(EVENT_TYPE_INTERFACE_REFILL);
+    event->data.interface = interface;
     return event;
 }
 
+Event* event_newProcessWakeup(Epoll* epoll) {
+    utility_assert(epoll != NULL);
+    Event* event = _event_new(EVENT_TYPE_PROCESS_WAKEUP);
+    event->data.epoll = epoll;
+    return event;
+}
+
+Event* event_newHeartbeat(Tracker* tracker) {
+    utility_assert(tracker != NULL);
+    Event* event = _event_new(EVENT_TYPE_HEARTBEAT);
+    event->data.tracker = tracker;
+    return event;
+}
+
+/* schedules an event on the host that runs it, as if that host just created it */
+void event_setLocal(Event* event, SimulationTime time, gpointer host) {
+    MAGIC_ASSERT(event);
+    _event_setHosts(event, time, host, host);
+}
+
 static void _event_free(Event* event) {
-    task_unref(event->task);
+    switch(event->type) {
+        case EVENT_TYPE_TASK: {
+            task_unref(event->data.task);
+            break;
+        }
+        case EVENT_TYPE_PACKET: {
+            packet_unref(event->data.packet);
+            break;
+        }
+        case EVENT_TYPE_LOCAL_PACKET: {
+            packet_unref(event->data.localPacket.packet);
+            break;
+        }
+        case EVENT_TYPE_SOCKET_TIMER: {
+            descriptor_unref(event->data.socketTimer.tcp);
+            break;
+        }
+        case EVENT_TYPE_TIMER_EXPIRE: {
+            descriptor_unref(event->data.timerExpire.timer);
+            break;
+        }
+        case EVENT_TYPE_PROCESS_WAKEUP: {
+            descriptor_unref(event->data.epoll);
+            break;
+        }
+        case EVENT_TYPE_INTERFACE_REFILL:
+        case EVENT_TYPE_HEARTBEAT: {
+            /* the host owns these for as long as it has events */
+            break;
+        }
+    }
     MAGIC_CLEAR(event);
     g_free(event);
     worker_countObject(OBJECT_TYPE_EVENT, COUNTER_TYPE_FREE);
@@ -62,10 +186,70 @@ void event_unref(Event* event) {
     }
 }
 
+static inline void _event_dispatch(Event* event) {
+    switch(event->type) {
+        case EVENT_TYPE_TASK: {
+            task_execute(event->data.task);
+            break;
+        }
+        case EVENT_TYPE_PACKET: {
+            in_addr_t ip = packet_getDestinationIP(event->data.packet);
+            Router* router = host_getUpstreamRouter(event->dstHost, ip);
+            utility_assert(router != NULL);
+            router_enqueue(router, event->data.packet);
+            break;
+        }
+        case EVENT_TYPE_LOCAL_PACKET: {
+            networkinterface_receiveLocalPacket(event->data.localPacket.interface,
+                    event->data.localPacket.packet);
+            break;
+        }
+        case EVENT_TYPE_SOCKET_TIMER: {
+            TCP* tcp = event->data.socketTimer.tcp;
+            switch(event->data.socketTimer.timer) {
+                case EVENT_SOCKET_TIMER_CLOSE: {
+                    tcp_closeTimerExpired(tcp);
+                    break;
+                }
+                case EVENT_SOCKET_TIMER_RETRANSMIT: {
+                    tcp_retransmitTimerExpired(tcp);
+                    break;
+                }
+                case EVENT_SOCKET_TIMER_DELAYED_ACK: {
+                    tcp_sendDelayedACK(tcp);
+                    break;
+                }
+                case EVENT_SOCKET_TIMER_WINDOW_UPDATE: {
+                    tcp_sendWindowUpdate(tcp);
+                    break;
+                }
+            }
+            break;
+        }
+        case EVENT_TYPE_TIMER_EXPIRE: {
+            timer_expire(event->data.timerExpire.timer, event->data.timerExpire.expireID);
+            break;
+        }
+        case EVENT_TYPE_INTERFACE_REFILL: {
+            networkinterface_refillTokenBuckets(event->data.interface);
+            break;
+        }
+        case EVENT_TYPE_PROCESS_WAKEUP: {
+            epoll_tryNotify(event->data.epoll);
+            break;
+        }
+        case EVENT_TYPE_HEARTBEAT: {
+            tracker_heartbeat(event->data.tracker);
+            break;
+        }
+    }
+}
+
 void event_execute(Event* event) {
     MAGIC_ASSERT(event);
 
-    host_lock(event->dstHost);
+    /* every scheduler policy runs a host on at most one worker at a time, so we
+     * don't lock the host. the worker charges it for the time this takes. */
     worker_setActiveHost(event->dstHost);
 
     /* check if we are allowed to execute or have to wait for cpu delays */
@@ -79,17 +263,26 @@ void event_execute(Event* event) {
         /* track the event delay time */
         tracker_addVirtualProcessingDelay(host_getTracker(event->dstHost), cpuDelay);
 
-        /* this event is delayed due to cpu, so reschedule it to ourselves */
-        worker_scheduleTask(event->task, cpuDelay);
+        /* hold back this and all of the host's other events until the cpu frees up.
+         * this happens once per blocked period rather than once per waiting event. */
+        SimulationTime unblockedTime = worker_getCurrentTime() + cpuDelay;
+        event_ref(event);
+        if(!worker_blockHost(event, unblockedTime)) {
+            /* the policy mixes hosts in its queues, so push it again for when the cpu
+             * frees up. it keeps its scheduled time, so the host's held events run in
+             * the same order as under the policies that hold the host's queue. */
+            event_setReadyTime(event, unblockedTime);
+            worker_scheduleEvent(event);
+        }
+        worker_incrementStatistic(STAT_EVENT_CPU_DELAYED);
     } else {
         /* cpu is not blocked, its ok to execute the event */
-        host_continueExecutionTimer(event->dstHost);
-        task_execute(event->task);
-        host_stopExecutionTimer(event->dstHost);
+        worker_incrementStatistic(STAT_EVENT_EXECUTED);
+        host_markActive(event->dstHost, event->time);
+        _event_dispatch(event);
     }
 
     worker_setActiveHost(NULL);
-    host_unlock(event->dstHost);
 }
 
 SimulationTime event_getTime(Event* event) {
@@ -105,6 +298,20 @@ gpointer event_getHost(Event* event) {
 void event_setTime(Event* event, SimulationTime time) {
     MAGIC_ASSERT(event);
     event->time = time;
+    event->scheduledTime = time;
+}
+
+/* runs the event at a later time because its host's cpu was blocked. the event is
+ * still ordered before the host's events that were scheduled after it. */
+void event_setReadyTime(Event* event, SimulationTime time) {
+    MAGIC_ASSERT(event);
+    event->time = time;
+}
+
+/* undoes event_setReadyTime, for queues that hold the event by its scheduled time */
+void event_clearReadyTime(Event* event) {
+    MAGIC_ASSERT(event);
+    event->time = event->scheduledTime;
 }
 
 gint event_compare(const Event* a, const Event* b, gpointer userData) {
@@ -115,6 +322,7 @@ gint event_compare(const Event* a, const Event* b, gpointer userData) {
      * The priority order is:
      *  - time (the sim time that the event will occur)
      *  - dst host id (where the packet is going to)
+     *  - scheduled time (events that a blocked cpu held back come first)
      *  - src host id (where the packet came from)
      *  - sequence in which the event was pushed (in case src hosts and dst hosts both match)
      *  (Host ids are guaranteed to be unique across hosts.)
@@ -129,6 +337,10 @@ gint event_compare(const Event* a, const Event* b, gpointer userData) {
             return 1;
         } else if (cmpresult < 0) {
             return -1;
+        } else if (a->scheduledTime > b->scheduledTime) {
+            return 1;
+        } else if (a->scheduledTime < b->scheduledTime) {
+            return -1;
         } else {
             cmpresult = host_compare(a->srcHost, b->srcHost, NULL);
             if (cmpresult > 0) {
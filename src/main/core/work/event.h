@@ -10,13 +10,64 @@
 
 #include "main/core/support/definitions.h"
 #include "main/core/work/task.h"
+#include "main/host/descriptor/epoll.h"
+#include "main/host/descriptor/tcp.h"
+#include "main/host/descriptor/timer.h"
+#include "main/host/network_interface.h"
+#include "main/host/tracker.h"
+#include "main/routing/packet.h"
 
 /* An event for a local virtual host, i.e.,
  * a host running on the same slave machine as the event initiator.
  * (These are packets sent between hosts on the same machine.) */
 typedef struct _Event Event;
 
+/* what an event does when it executes. the arguments of each kind are stored
+ * in the event itself, so only generic tasks need a separate object. */
+typedef enum _EventType EventType;
+enum _EventType {
+    /* runs a generic task */
+    EVENT_TYPE_TASK,
+    /* delivers a packet to the upstream router of the destination host */
+    EVENT_TYPE_PACKET,
+    /* delivers a packet that a host sent to its own address to its interface */
+    EVENT_TYPE_LOCAL_PACKET,
+    /* one of the timers of a tcp socket expires */
+    EVENT_TYPE_SOCKET_TIMER,
+    /* a timerfd expiration that may have been cancelled in the meantime */
+    EVENT_TYPE_TIMER_EXPIRE,
+    /* refills the token buckets of an interface */
+    EVENT_TYPE_INTERFACE_REFILL,
+    /* wakes up the process waiting on an epoll that has ready descriptors */
+    EVENT_TYPE_PROCESS_WAKEUP,
+    /* logs the tracker heartbeat of a host */
+    EVENT_TYPE_HEARTBEAT,
+};
+
+/* the timers of a tcp socket */
+typedef enum _EventSocketTimer EventSocketTimer;
+enum _EventSocketTimer {
+    EVENT_SOCKET_TIMER_CLOSE,
+    EVENT_SOCKET_TIMER_RETRANSMIT,
+    EVENT_SOCKET_TIMER_DELAYED_ACK,
+    EVENT_SOCKET_TIMER_WINDOW_UPDATE,
+};
+
 Event* event_new_(Task* task, SimulationTime time, gpointer srcHost, gpointer dstHost);
+/* the event takes over the caller's reference to the packet */
+Event* event_newPacket(Packet* packet, SimulationTime time, gpointer srcHost, gpointer dstHost);
+
+/* these events run on the host that creates them, and get their time and host
+ * when the worker schedules them. each takes over the caller's reference to its
+ * packet or descriptor. */
+Event* event_newLocalPacket(NetworkInterface* interface, Packet* packet);
+Event* event_newSocketTimer(TCP* tcp, EventSocketTimer timer);
+Event* event_newTimerExpire(Timer* timer, guint expireID);
+Event* event_newInterfaceRefill(NetworkInterface* interface);
+Event* event_newProcessWakeup(Epoll* epoll);
+Event* event_newHeartbeat(Tracker* tracker);
+void event_setLocal(Event* event, SimulationTime time, gpointer host);
+
 void event_ref(Event* event);
 void event_unref(Event* event);
 
@@ -26,5 +77,7 @@ gint event_compare(const Event* a, const Event* b, gpointer userData);
 gpointer event_getHost(Event* event);
 SimulationTime event_getTime(Event* event);
 void event_setTime(Event* event, SimulationTime time);
+void event_setReadyTime(Event* event, SimulationTime time);
+void event_clearReadyTime(Event* event);
 
 #endif /* SHD_EVENT_H_ */
@@ -6,7 +6,7 @@
 #include "main/core/work/task.h"
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/utility/utility.h"
 
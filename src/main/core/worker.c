@@ -15,17 +15,19 @@
 #include "main/core/scheduler/scheduler.h"
 #include "main/core/slave.h"
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/live_metrics.h"
 #include "main/core/support/options.h"
+#include "main/core/support/packet_trace.h"
+#include "main/core/support/statistics.h"
 #include "main/core/work/event.h"
 #include "main/core/work/task.h"
 #include "main/core/worker.h"
 #include "main/host/host.h"
 #include "main/host/process.h"
+#include "main/host/tracker.h"
 #include "main/routing/address.h"
 #include "main/routing/dns.h"
 #include "main/routing/packet.h"
-#include "main/routing/router.h"
 #include "main/routing/topology.h"
 #include "main/utility/count_down_latch.h"
 #include "main/utility/random.h"
@@ -57,9 +59,25 @@ struct _Worker {
         Process* process;
     } active;
 
+    /* the host whose run of events we are executing, and the cycles its events
+     * took so far. we only count the cycles spent in event_execute, not in the
+     * scheduler, and charge the run to the host when we move on to another host
+     * or the round ends. */
+    struct {
+        Host* host;
+        guint64 cycles;
+    } execution;
+
     SimulationTime bootstrapEndTime;
 
-    ObjectCounter* objectCounts;
+    /* counters that only this worker writes, aggregated by the slave */
+    Statistics* statistics;
+    /* our packet trace ring, NULL unless tracing is enabled */
+    PacketTraceBuffer* packetTraceBuffer;
+    /* packets sent between each ordered pair of vertices, keyed by the topology's vertex
+     * pair key. only this worker writes it, the slave merges it while we wait at the
+     * round barrier. */
+    GHashTable* pathPacketCounts;
 
     MAGIC_DECLARE;
 };
@@ -95,7 +113,12 @@ static Worker* _worker_new(Slave* slave, guint threadID) {
     worker->clock.now = SIMTIME_INVALID;
     worker->clock.last = SIMTIME_INVALID;
     worker->clock.barrier = SIMTIME_INVALID;
-    worker->objectCounts = objectcounter_new();
+    worker->statistics = statistics_new();
+    slave_registerStatistics(slave, worker->statistics);
+    worker->pathPacketCounts = g_hash_table_new(g_direct_hash, g_direct_equal);
+    slave_registerPathPacketCounts(slave, worker->pathPacketCounts);
+    /* the buffer is owned and freed by the slave's packet trace */
+    worker->packetTraceBuffer = slave_newPacketTraceBuffer(slave);
 
     worker->bootstrapEndTime = slave_getBootstrapEndTime(worker->slave);
 
@@ -107,8 +130,11 @@ static Worker* _worker_new(Slave* slave, guint threadID) {
 static void _worker_free(Worker* worker) {
     MAGIC_ASSERT(worker);
 
-    if(worker->objectCounts != NULL) {
-        objectcounter_free(worker->objectCounts);
+    if(worker->statistics != NULL) {
+        statistics_free(worker->statistics);
+    }
+    if(worker->pathPacketCounts != NULL) {
+        g_hash_table_destroy(worker->pathPacketCounts);
     }
 
     g_private_set(&workerKey, NULL);
@@ -144,6 +170,49 @@ Options* worker_getOptions() {
     return slave_getOptions(worker->slave);
 }
 
+static void _worker_updateHostLiveMetrics(Worker* worker, Host* host) {
+    LiveMetrics* metrics = slave_getLiveMetrics(worker->slave);
+    if(metrics != NULL) {
+        Tracker* tracker = host_getTracker(host);
+        livemetrics_updateHost(metrics, host_getID(host), host_getLastActiveTime(host),
+                host_getElapsedExecutionTime(host),
+                tracker ? tracker_getOutputBytesTotal(tracker) : 0,
+                tracker ? tracker_getInputBytesTotal(tracker) : 0,
+                tracker ? tracker_getAllocatedBytesTotal(tracker) : 0);
+    }
+}
+
+static void _worker_chargeExecutionTime(Worker* worker) {
+    if(worker->execution.host != NULL) {
+        host_addExecutionCycles(worker->execution.host, worker->execution.cycles);
+        /* we are done with the host's run of events, so its values are current */
+        _worker_updateHostLiveMetrics(worker, worker->execution.host);
+        worker->execution.host = NULL;
+        worker->execution.cycles = 0;
+    }
+}
+
+static void _worker_setExecutingHost(Worker* worker, Host* host) {
+    if(worker->execution.host != host) {
+        _worker_chargeExecutionTime(worker);
+        worker->execution.host = host;
+    }
+}
+
+void worker_flushExecutionTime() {
+    Worker* worker = _worker_getPrivate();
+    _worker_chargeExecutionTime(worker);
+}
+
+void worker_updateLiveMetrics(gdouble idleSeconds) {
+    Worker* worker = _worker_getPrivate();
+    LiveMetrics* metrics = slave_getLiveMetrics(worker->slave);
+    if(metrics != NULL) {
+        livemetrics_updateWorker(metrics, worker->threadID,
+                statistics_get(worker->statistics, STAT_EVENT_EXECUTED), idleSeconds);
+    }
+}
+
 /* this is the entry point for worker threads when running in parallel mode,
  * and otherwise is the main event loop when running in serial mode */
 gpointer worker_run(WorkerRunData* data) {
@@ -165,15 +234,19 @@ gpointer worker_run(WorkerRunData* data) {
     while((event = scheduler_pop(worker->scheduler)) != NULL) {
         /* update cache, reset clocks */
         worker->clock.now = event_getTime(event);
+        _worker_setExecutingHost(worker, event_getHost(event));
 
         /* process the local event */
+        guint64 startCycles = utility_getCycleCount();
         event_execute(event);
+        worker->execution.cycles += utility_getCycleCount() - startCycles;
         event_unref(event);
 
         /* update times */
         worker->clock.last = worker->clock.now;
         worker->clock.now = SIMTIME_INVALID;
     }
+    worker_flushExecutionTime();
 
     /* this will free the host data that we have been managing */
     scheduler_awaitFinish(worker->scheduler);
@@ -190,8 +263,9 @@ gpointer worker_run(WorkerRunData* data) {
         countdownlatch_await(data->notifyReadyToJoin);
     }
 
-    /* cleanup is all done, send object counts to slave */
-    slave_storeCounts(worker->slave, worker->objectCounts);
+    /* cleanup is all done, send our counters to slave */
+    slave_storeStatistics(worker->slave, worker->statistics);
+    slave_storePathPacketCounts(worker->slave, worker->pathPacketCounts);
 
     /* synchronize thread join */
     CountDownLatch* notifyJoined = data->notifyJoined;
@@ -233,11 +307,57 @@ gboolean worker_scheduleTask(Task* task, SimulationTime nanoDelay) {
     }
 }
 
-static void _worker_runDeliverPacketTask(Packet* packet, gpointer userData) {
-    in_addr_t ip = packet_getDestinationIP(packet);
-    Router* router = host_getUpstreamRouter(_worker_getPrivate()->active.host, ip);
-    utility_assert(router != NULL);
-    router_enqueue(router, packet);
+/* like worker_scheduleTask, but for the typed events that store their arguments
+ * inline, which saves allocating and reference counting a separate task.
+ * takes over the caller's reference to the event. */
+gboolean worker_scheduleLocalEvent(Event* event, SimulationTime nanoDelay) {
+    utility_assert(event);
+
+    Worker* worker = _worker_getPrivate();
+
+    if(slave_schedulerIsRunning(worker->slave)) {
+        utility_assert(worker->clock.now != SIMTIME_INVALID);
+        utility_assert(worker->active.host != NULL);
+
+        Host* host = worker->active.host;
+        event_setLocal(event, worker->clock.now + nanoDelay, host);
+        return scheduler_push(worker->scheduler, event, host, host);
+    } else {
+        /* freeing the event releases the objects it holds */
+        event_unref(event);
+        return FALSE;
+    }
+}
+
+/* pushes an event the caller already set up, consuming the caller's reference */
+gboolean worker_scheduleEvent(Event* event) {
+    utility_assert(event);
+
+    Worker* worker = _worker_getPrivate();
+
+    if(slave_schedulerIsRunning(worker->slave)) {
+        Host* host = event_getHost(event);
+        return scheduler_push(worker->scheduler, event, host, host);
+    } else {
+        event_unref(event);
+        return FALSE;
+    }
+}
+
+/* hands the event back to the scheduler, which holds it and every other event
+ * of its host until the host's cpu frees up. returns FALSE if the scheduler
+ * policy can't hold hosts, in which case the caller still owns the event. */
+gboolean worker_blockHost(Event* event, SimulationTime untilTime) {
+    utility_assert(event);
+    Worker* worker = _worker_getPrivate();
+    return scheduler_blockHost(worker->scheduler, event, untilTime);
+}
+
+static void _worker_countPathPacket(Worker* worker, gpointer vertexPair) {
+    /* counts by the actual source and destination vertices, not by the cached path,
+     * which may be shared by equivalent vertices and by both directions */
+    guint64 count = (guint64)g_hash_table_lookup(worker->pathPacketCounts, vertexPair);
+    g_hash_table_replace(worker->pathPacketCounts, vertexPair, (gpointer)(count + 1));
 }
 
 void worker_sendPacket(Packet* packet) {
@@ -263,8 +383,13 @@ void worker_sendPacket(Packet* packet) {
 
     gboolean bootstrapping = worker_isBootstrapActive();
 
+    /* resolve the path once for everything we need to know about it */
+    gdouble latency = -1, reliability = -1;
+    gpointer vertexPair = NULL;
+    gboolean hasPath = topology_lookupPath(worker_getTopology(), srcAddress, dstAddress,
+            &latency, &reliability, &vertexPair);
+
     /* check if network reliability forces us to 'drop' the packet */
-    gdouble reliability = topology_getReliability(worker_getTopology(), srcAddress, dstAddress);
     Random* random = host_getRandom(worker_getActiveHost());
     gdouble chance = random_nextDouble(random);
 
@@ -272,11 +397,15 @@ void worker_sendPacket(Packet* packet) {
      * control has problems responding to packet loss */
     if(bootstrapping || chance <= reliability || packet_getPayloadLength(packet) == 0) {
         /* the sender's packet will make it through, find latency */
-        gdouble latency = topology_getLatency(worker_getTopology(), srcAddress, dstAddress);
         SimulationTime delay = (SimulationTime) ceil(latency * SIMTIME_ONE_MILLISECOND);
         SimulationTime deliverTime = worker->clock.now + delay;
 
-        topology_incrementPathPacketCounter(worker_getTopology(), srcAddress, dstAddress);
+        if(hasPath) {
+            _worker_countPathPacket(worker, vertexPair);
+        } else {
+            error("unable to find path between node %s and node %s",
+                    address_toString(srcAddress), address_toString(dstAddress));
+        }
 
         /* TODO this should change for sending to remote slave (on a different machine)
          * this is the only place where tasks are sent between separate hosts */
@@ -288,14 +417,10 @@ void worker_sendPacket(Packet* packet) {
 
         packet_addDeliveryStatus(packet, PDS_INET_SENT);
 
-        /* the packetCopy starts with 1 ref, which will be held by the packet task
-         * and unreffed after the task is finished executing. */
+        /* the packetCopy starts with 1 ref, which will be held by the packet event
+         * and unreffed after the event is finished executing. */
         Packet* packetCopy = packet_copy(packet);
-
-        Task* packetTask = task_new((TaskCallbackFunc)_worker_runDeliverPacketTask,
-                packetCopy, NULL, (TaskObjectFreeFunc)packet_unref, NULL);
-        Event* packetEvent = event_new_(packetTask, deliverTime, srcHost, dstHost);
-        task_unref(packetTask);
+        Event* packetEvent = event_newPacket(packetCopy, deliverTime, srcHost, dstHost);
 
         scheduler_push(worker->scheduler, packetEvent, srcHost, dstHost);
     } else {
@@ -339,6 +464,20 @@ void worker_freeHosts(GQueue* hosts) {
     g_queue_foreach(hosts, (GFunc)_worker_shutdownHost, worker);
 }
 
+static void _worker_flushHost(Host* host, Worker* worker) {
+    worker_setActiveHost(host);
+    host_flush(host);
+    worker_setActiveHost(NULL);
+}
+
+void worker_flushHosts(GQueue* hosts) {
+    Worker* worker = _worker_getPrivate();
+    /* the processes still exit so that their atexit functions run and
+     * their output files get flushed and closed */
+    g_queue_foreach(hosts, (GFunc)_worker_freeHostProcesses, worker);
+    g_queue_foreach(hosts, (GFunc)_worker_flushHost, worker);
+}
+
 Process* worker_getActiveProcess() {
     Worker* worker = _worker_getPrivate();
     return worker->active.process;
@@ -420,6 +559,10 @@ void worker_setCurrentTime(SimulationTime time) {
 }
 
 gboolean worker_isFiltered(LogLevel level) {
+    /* cheap check first, this runs for every packet status change */
+    if(slave_isLogLevelFiltered(level)) {
+        return TRUE;
+    }
     return shadow_logger_shouldFilter(shadow_logger_getDefault(), level);
 }
 
@@ -433,12 +576,33 @@ void worker_countObject(ObjectType otype, CounterType ctype) {
      * are created by the worker threads. but the slave thread does
      * not have a worker object. this is only an issue when running
      * with multiple workers. */
-    if(worker_isAlive()) {
-        Worker* worker = _worker_getPrivate();
-        objectcounter_incrementOne(worker->objectCounts, otype, ctype);
+    if(otype == OBJECT_TYPE_NONE || ctype == COUNTER_TYPE_NONE) {
+        return;
+    }
+    worker_incrementStatistic(STATISTICS_OBJECT_COUNTER(otype, ctype));
+}
+
+void worker_incrementStatistic(StatisticsCounter counter) {
+    Worker* worker = g_private_get(&workerKey);
+    if(worker) {
+        statistics_increment(worker->statistics, counter);
+    } else {
+        /* has a global lock, so don't do it unless there is no worker object */
+        slave_incrementStatistic(counter);
+    }
+}
+
+void worker_tracePacketStatus(guint packetHostID, guint64 packetID, guint status) {
+    Worker* worker = g_private_get(&workerKey);
+    if(worker) {
+        if(worker->packetTraceBuffer) {
+            guint hostID = worker->active.host ? (guint)host_getID(worker->active.host) : 0;
+            packettracebuffer_append(worker->packetTraceBuffer, worker->clock.now,
+                    packetHostID, packetID, hostID, status);
+        }
     } else {
         /* has a global lock, so don't do it unless there is no worker object */
-        slave_countObject(otype, ctype);
+        slave_tracePacketStatus(SIMTIME_INVALID, packetHostID, packetID, 0, status);
     }
 }
 
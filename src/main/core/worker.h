@@ -12,8 +12,8 @@
 
 #include "main/core/scheduler/scheduler.h"
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
 #include "main/core/support/options.h"
+#include "main/core/support/statistics.h"
 #include "main/core/work/task.h"
 #include "main/host/host.h"
 #include "main/routing/address.h"
@@ -40,10 +40,15 @@ Topology* worker_getTopology();
 Options* worker_getOptions();
 gpointer worker_run(WorkerRunData*);
 gboolean worker_scheduleTask(Task* task, SimulationTime nanoDelay);
+gboolean worker_scheduleLocalEvent(Event* event, SimulationTime nanoDelay);
+gboolean worker_scheduleEvent(Event* event);
+gboolean worker_blockHost(Event* event, SimulationTime untilTime);
 void worker_sendPacket(Packet* packet);
 gboolean worker_isAlive();
 
 void worker_countObject(ObjectType otype, CounterType ctype);
+void worker_incrementStatistic(StatisticsCounter counter);
+void worker_tracePacketStatus(guint packetHostID, guint64 packetID, guint status);
 
 SimulationTime worker_getCurrentTime();
 EmulatedTime worker_getEmulatedTime();
@@ -60,6 +65,10 @@ gboolean worker_isFiltered(LogLevel level);
 
 void worker_bootHosts(GQueue* hosts);
 void worker_freeHosts(GQueue* hosts);
+void worker_flushHosts(GQueue* hosts);
+
+void worker_flushExecutionTime();
+void worker_updateLiveMetrics(gdouble idleSeconds);
 
 Host* worker_getActiveHost();
 void worker_setActiveHost(Host* host);
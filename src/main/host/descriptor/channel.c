@@ -11,7 +11,7 @@
 #include <stddef.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/host/descriptor/descriptor.h"
 #include "main/host/descriptor/transport.h"
@@ -8,7 +8,7 @@
 
 #include <stddef.h>
 
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/host/descriptor/epoll.h"
 #include "main/host/host.h"
@@ -92,6 +92,16 @@ static void _descriptor_notifyEpollListener(gpointer key, gpointer value, gpoint
     epoll_descriptorStatusChanged(epoll, descriptor);
 }
 
+static void _descriptor_notifyStatusListeners(Descriptor* descriptor) {
+    /* tell our epoll listeners their was some activity on this descriptor */
+    g_hash_table_foreach(descriptor->epollListeners, _descriptor_notifyEpollListener, descriptor);
+
+    /* and any internal listener, e.g., a native traffic model */
+    if(descriptor->statusCallback) {
+        descriptor->statusCallback(descriptor, descriptor->statusCallbackData);
+    }
+}
+
 void descriptor_adjustStatus(Descriptor* descriptor, DescriptorStatus status, gboolean doSetBits){
     MAGIC_ASSERT(descriptor);
 
@@ -132,8 +142,29 @@ void descriptor_adjustStatus(Descriptor* descriptor, DescriptorStatus status, gb
         }
     }
 
-    /* tell our epoll listeners their was some activity on this descriptor */
-    g_hash_table_foreach(descriptor->epollListeners, _descriptor_notifyEpollListener, descriptor);
+    /* listeners learn about all held changes at once when they are released */
+    if(descriptor->statusHoldCount > 0) {
+        descriptor->statusNotificationPending = TRUE;
+        return;
+    }
+
+    _descriptor_notifyStatusListeners(descriptor);
+}
+
+void descriptor_holdStatusNotifications(Descriptor* descriptor) {
+    MAGIC_ASSERT(descriptor);
+    descriptor->statusHoldCount++;
+}
+
+void descriptor_releaseStatusNotifications(Descriptor* descriptor) {
+    MAGIC_ASSERT(descriptor);
+    utility_assert(descriptor->statusHoldCount > 0);
+
+    descriptor->statusHoldCount--;
+    if(descriptor->statusHoldCount == 0 && descriptor->statusNotificationPending) {
+        descriptor->statusNotificationPending = FALSE;
+        _descriptor_notifyStatusListeners(descriptor);
+    }
 }
 
 DescriptorStatus descriptor_getStatus(Descriptor* descriptor) {
@@ -170,6 +201,14 @@ void descriptor_removeEpollListener(Descriptor* descriptor, Descriptor* epoll) {
     g_hash_table_remove(descriptor->epollListeners, &epoll->handle);
 }
 
+void descriptor_setStatusCallback(Descriptor* descriptor,
+        DescriptorStatusCallbackFunc callback, gpointer data) {
+    MAGIC_ASSERT(descriptor);
+    /* the listener must clear this before it is freed, we hold no reference */
+    descriptor->statusCallback = callback;
+    descriptor->statusCallbackData = callback ? data : NULL;
+}
+
 gint descriptor_getFlags(Descriptor* descriptor) {
     MAGIC_ASSERT(descriptor);
     return descriptor->flags;
@@ -36,6 +36,9 @@ typedef struct _DescriptorFunctionTable DescriptorFunctionTable;
 /* required functions */
 typedef void (*DescriptorFunc)(Descriptor* descriptor);
 
+/* optional status listener for in-simulator users that have no epoll/process */
+typedef void (*DescriptorStatusCallbackFunc)(Descriptor* descriptor, gpointer data);
+
 /*
  * Virtual function table for base descriptor, storing pointers to required
  * callable functions.
@@ -52,8 +55,13 @@ struct _Descriptor {
     DescriptorType type;
     DescriptorStatus status;
     GHashTable* epollListeners;
+    DescriptorStatusCallbackFunc statusCallback;
+    gpointer statusCallbackData;
     gint referenceCount;
     gint flags;
+    /* while held, status changes are collected into a single notification */
+    gint statusHoldCount;
+    gboolean statusNotificationPending;
     MAGIC_DECLARE;
 };
 
@@ -68,11 +76,16 @@ DescriptorType descriptor_getType(Descriptor* descriptor);
 gint* descriptor_getHandleReference(Descriptor* descriptor);
 
 void descriptor_adjustStatus(Descriptor* descriptor, DescriptorStatus status, gboolean doSetBits);
+void descriptor_holdStatusNotifications(Descriptor* descriptor);
+void descriptor_releaseStatusNotifications(Descriptor* descriptor);
 DescriptorStatus descriptor_getStatus(Descriptor* descriptor);
 
 void descriptor_addEpollListener(Descriptor* descriptor, Descriptor* epoll);
 void descriptor_removeEpollListener(Descriptor* descriptor, Descriptor* epoll);
 
+void descriptor_setStatusCallback(Descriptor* descriptor,
+        DescriptorStatusCallbackFunc callback, gpointer data);
+
 gint descriptor_getFlags(Descriptor* descriptor);
 void descriptor_setFlags(Descriptor* descriptor, gint flags);
 
@@ -11,8 +11,8 @@
 #include <unistd.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
-#include "main/core/work/task.h"
+#include "main/core/support/statistics.h"
+#include "main/core/work/event.h"
 #include "main/core/worker.h"
 #include "main/host/descriptor/descriptor.h"
 #include "main/host/descriptor/epoll.h"
@@ -62,6 +62,9 @@ struct _EpollWatch {
     struct epoll_event event;
     /* current status of the underlying shadow descriptor */
     EpollWatchFlags flags;
+    /* links the watch into the ready queue. the data is only set while the
+     * watch is in the queue, which holds a reference to it. */
+    GList readyLink;
     gint referenceCount;
     MAGIC_DECLARE;
 };
@@ -90,7 +93,7 @@ struct _Epoll {
     GHashTable* watching;
 
     /* holds the descriptors that we are watching that have events */
-    GHashTable* ready;
+    GQueue ready;
 
     Process* ownerProcess;
     gint osEpollChild;
@@ -100,8 +103,6 @@ struct _Epoll {
 };
 
 /* forward declaration */
-static void _epoll_tryNotify(Epoll* epoll, gpointer userData);
-
 static EpollWatch* _epollwatch_new(Epoll* epoll, Descriptor* descriptor, struct epoll_event* event) {
     EpollWatch* watch = g_new0(EpollWatch, 1);
     MAGIC_INIT(watch);
@@ -140,13 +141,35 @@ static void _epollwatch_unref(EpollWatch* watch) {
     }
 }
 
+static gboolean _epoll_isWatchQueued(EpollWatch* watch) {
+    return watch->readyLink.data != NULL ? TRUE : FALSE;
+}
+
+static void _epoll_addReadyWatch(Epoll* epoll, EpollWatch* watch) {
+    if(!_epoll_isWatchQueued(watch)) {
+        _epollwatch_ref(watch);
+        watch->readyLink.data = watch;
+        g_queue_push_tail_link(&(epoll->ready), &(watch->readyLink));
+    }
+}
+
+static void _epoll_removeReadyWatch(Epoll* epoll, EpollWatch* watch) {
+    if(_epoll_isWatchQueued(watch)) {
+        g_queue_unlink(&(epoll->ready), &(watch->readyLink));
+        watch->readyLink.data = NULL;
+        _epollwatch_unref(watch);
+    }
+}
+
 /* should only be called from descriptor dereferencing the functionTable */
 static void _epoll_free(Epoll* epoll) {
     MAGIC_ASSERT(epoll);
 
     /* this unrefs all of the remaining watches */
+    while(!g_queue_is_empty(&(epoll->ready))) {
+        _epoll_removeReadyWatch(epoll, g_queue_peek_head(&(epoll->ready)));
+    }
     g_hash_table_destroy(epoll->watching);
-    g_hash_table_destroy(epoll->ready);
 
     epoll_ctl(epoll->osEpollParent, EPOLL_CTL_DEL, epoll->osEpollChild, NULL);
     close(epoll->osEpollChild);
@@ -212,7 +235,7 @@ Epoll* epoll_new(gint handle) {
 
     /* allocate backend needed for managing events for this descriptor */
     epoll->watching = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, (GDestroyNotify)_epollwatch_unref);
-    epoll->ready = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, (GDestroyNotify)_epollwatch_unref);
+    g_queue_init(&(epoll->ready));
 
     /* the application may want us to watch some system files, so we need a
      * real OS epoll fd so we can offload that task.
@@ -355,13 +378,9 @@ static void _epoll_scheduleNotification(Epoll* epoll) {
     /* schedule a notification event for our node, if wanted and one isnt already scheduled */
     if(!(epoll->flags & EF_SCHEDULED) && process_wantsNotify(epoll->ownerProcess, epoll->super.handle)) {
         descriptor_ref(epoll);
-        Task* notifyTask = task_new((TaskCallbackFunc)_epoll_tryNotify,
-                epoll, NULL, descriptor_unref, NULL);
-
-        if(worker_scheduleTask(notifyTask, 1)) {
+        if(worker_scheduleLocalEvent(event_newProcessWakeup(epoll), 1)) {
             epoll->flags |= EF_SCHEDULED;
         }
-        task_unref(notifyTask);
     }
 }
 
@@ -376,7 +395,7 @@ static gboolean _epoll_adjustStatus(Epoll* epoll) {
     DescriptorStatus status = descriptor_getStatus(&epoll->super);
 
     /* check status to see if we need to schedule a notification */
-    gboolean isReady = g_hash_table_size(epoll->ready) > 0 || _epoll_isReadyOS(epoll) ? TRUE : FALSE;
+    gboolean isReady = !g_queue_is_empty(&(epoll->ready)) || _epoll_isReadyOS(epoll) ? TRUE : FALSE;
 
     /* for epoll fd, readable means some children watch fds have events.
      * we only need to take action if the status changed. */
@@ -472,7 +491,7 @@ gint epoll_control(Epoll* epoll, gint operation, Descriptor* descriptor, struct
             descriptor_removeEpollListener(watch->descriptor, (Descriptor*)epoll);
 
             /* unref gets called on the watch when it is removed from these tables */
-            g_hash_table_remove(epoll->ready, watchHandleRef);
+            _epoll_removeReadyWatch(epoll, watch);
             g_hash_table_remove(epoll->watching, watchHandleRef);
 
             break;
@@ -506,11 +525,8 @@ gint epoll_getEvents(Epoll* epoll, struct epoll_event* eventArray, gint eventArr
      * overflow. the number of actual events is returned in nEvents. */
     gint eventIndex = 0;
 
-    GHashTableIter iter;
-    gpointer key, value;
-    g_hash_table_iter_init(&iter, epoll->ready);
-    while(g_hash_table_iter_next(&iter, &key, &value) && (eventIndex < eventArrayLength)) {
-        EpollWatch* watch = value;
+    for(GList* link = epoll->ready.head; link && (eventIndex < eventArrayLength); link = link->next) {
+        EpollWatch* watch = link->data;
         MAGIC_ASSERT(watch);
 
         if(_epollwatch_isReady(watch)) {
@@ -597,13 +613,10 @@ void epoll_descriptorStatusChanged(Epoll* epoll, Descriptor* descriptor) {
 
     /* check if its ready (has an event to report) now */
     if(_epollwatch_isReady(watch)) {
-        if(!g_hash_table_contains(epoll->ready, watchHandleRef)) {
-            _epollwatch_ref(watch);
-            g_hash_table_replace(epoll->ready, watchHandleRef, watch);
-        }
+        _epoll_addReadyWatch(epoll, watch);
     } else {
-        /* this calls unref on the watch if its in the table */
-        g_hash_table_remove(epoll->ready, watchHandleRef);
+        /* this calls unref on the watch if its in the queue */
+        _epoll_removeReadyWatch(epoll, watch);
     }
 
     /* check the status on the parent epoll fd and adjust as needed */
@@ -635,7 +648,7 @@ static gchar* _epoll_getChildrenStatus(Epoll* epoll, GString* message) {
 }
 #endif
 
-static void _epoll_tryNotify(Epoll* epoll, gpointer userData) {
+void epoll_tryNotify(Epoll* epoll) {
     MAGIC_ASSERT(epoll);
 
     /* event is being executed from the scheduler, so its no longer scheduled */
@@ -652,7 +665,7 @@ static void _epoll_tryNotify(Epoll* epoll, gpointer userData) {
      * check if there is events on the OS epoll instance, but only if we would otherwise
      * not call the process. this ensures the process can collect events for which we are
      * using the OS as a backend, even if none of our own watches have ready events. */
-    gboolean isReady = g_hash_table_size(epoll->ready) > 0 || _epoll_isReadyOS(epoll) ? TRUE : FALSE;
+    gboolean isReady = !g_queue_is_empty(&(epoll->ready)) || _epoll_isReadyOS(epoll) ? TRUE : FALSE;
 
     if(isReady) {
         /* an event should have only been scheduled for the special epollfd */
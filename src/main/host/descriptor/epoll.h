@@ -8,6 +8,7 @@
 #define SHD_EPOLL_H_
 
 #include <glib.h>
+#include <sys/epoll.h>
 
 #include "main/host/descriptor/descriptor.h"
 
@@ -25,5 +26,6 @@ gint epoll_getEvents(Epoll* epoll, struct epoll_event* eventArray,
 
 void epoll_descriptorStatusChanged(Epoll* epoll, Descriptor* descriptor);
 void epoll_clearWatchListeners(Epoll* epoll);
+void epoll_tryNotify(Epoll* epoll);
 
 #endif /* SHD_EPOLL_H_ */
@@ -22,6 +22,19 @@
 #include "main/routing/packet.h"
 #include "main/utility/utility.h"
 
+static Packet* _socket_popBuffer(GQueue* buffer) {
+    /* the link is embedded in the packet, so there is nothing to free */
+    GList* link = g_queue_pop_head_link(buffer);
+    return link ? link->data : NULL;
+}
+
+static void _socket_clearBuffer(GQueue* buffer) {
+    Packet* packet = NULL;
+    while((packet = _socket_popBuffer(buffer)) != NULL) {
+        packet_unref(packet);
+    }
+}
+
 void socket_free(gpointer data) {
     Socket* socket = data;
     MAGIC_ASSERT(socket);
@@ -38,20 +51,9 @@ void socket_free(gpointer data) {
         g_free(socket->unixPath);
     }
 
-    while(g_queue_get_length(socket->inputBuffer) > 0) {
-        packet_unref(g_queue_pop_head(socket->inputBuffer));
-    }
-    g_queue_free(socket->inputBuffer);
-
-    while(g_queue_get_length(socket->outputBuffer) > 0) {
-        packet_unref(g_queue_pop_head(socket->outputBuffer));
-    }
-    g_queue_free(socket->outputBuffer);
-
-    while(g_queue_get_length(socket->outputControlBuffer) > 0) {
-        packet_unref(g_queue_pop_head(socket->outputControlBuffer));
-    }
-    g_queue_free(socket->outputControlBuffer);
+    _socket_clearBuffer(&(socket->inputBuffer));
+    _socket_clearBuffer(&(socket->outputBuffer));
+    _socket_clearBuffer(&(socket->outputControlBuffer));
 
     MAGIC_CLEAR(socket);
     socket->vtable->free((Descriptor*)socket);
@@ -102,10 +104,11 @@ void socket_init(Socket* socket, SocketFunctionTable* vtable, DescriptorType typ
     socket->vtable = vtable;
 
     socket->protocol = type == DT_TCPSOCKET ? PTCP : type == DT_UDPSOCKET ? PUDP : PLOCAL;
-    socket->inputBuffer = g_queue_new();
+    /* the buffers link the packets through links embedded in the packets */
+    g_queue_init(&(socket->inputBuffer));
     socket->inputBufferSize = receiveBufferSize;
-    socket->outputBuffer = g_queue_new();
-    socket->outputControlBuffer = g_queue_new();
+    g_queue_init(&(socket->outputBuffer));
+    g_queue_init(&(socket->outputControlBuffer));
     socket->outputBufferSize = sendBufferSize;
 
     Tracker* tracker = host_getTracker(worker_getActiveHost());
@@ -158,13 +161,21 @@ Packet* socket_pullOutPacket(Socket* socket) {
 
 Packet* socket_peekNextPacket(const Socket* socket) {
     MAGIC_ASSERT(socket);
-    if(!g_queue_is_empty(socket->outputControlBuffer)) {
-        return g_queue_peek_head(socket->outputControlBuffer);
+    /* the queues are embedded, so read the heads directly to keep the socket const */
+    if(socket->outputControlBuffer.head) {
+        return socket->outputControlBuffer.head->data;
+    } else if(socket->outputBuffer.head) {
+        return socket->outputBuffer.head->data;
     } else {
-        return g_queue_peek_head(socket->outputBuffer);
+        return NULL;
     }
 }
 
+GList* socket_getInterfaceLink(Socket* socket, gboolean isLoopback) {
+    MAGIC_ASSERT(socket);
+    return &(socket->interfaceLinks[isLoopback ? 0 : 1]);
+}
+
 gboolean socket_getPeerName(Socket* socket, in_addr_t* ip, in_port_t* port) {
     MAGIC_ASSERT(socket);
 
@@ -324,7 +335,7 @@ gboolean socket_addToInputBuffer(Socket* socket, Packet* packet) {
     }
 
     /* add to our queue */
-    g_queue_push_tail(socket->inputBuffer, packet);
+    g_queue_push_tail_link(&(socket->inputBuffer), packet_getSocketInputLink(packet));
     packet_ref(packet);
     socket->inputBufferLength += length;
     packet_addDeliveryStatus(packet, PDS_RCV_SOCKET_BUFFERED);
@@ -346,7 +357,7 @@ Packet* socket_removeFromInputBuffer(Socket* socket) {
     MAGIC_ASSERT(socket);
 
     /* see if we have any packets */
-    Packet* packet = g_queue_pop_head(socket->inputBuffer);
+    Packet* packet = _socket_popBuffer(&(socket->inputBuffer));
     if(packet) {
         /* just removed a packet */
         guint length = packet_getPayloadLength(packet);
@@ -396,9 +407,9 @@ gboolean socket_addToOutputBuffer(Socket* socket, Packet* packet) {
     /* add to our queue */
     if(packet_getPriority(packet) == 0.0f) {
         /* control packets get sent first */
-        g_queue_push_tail(socket->outputControlBuffer, packet);
+        g_queue_push_tail_link(&(socket->outputControlBuffer), packet_getSocketOutputLink(packet));
     } else {
-        g_queue_push_tail(socket->outputBuffer, packet);
+        g_queue_push_tail_link(&(socket->outputBuffer), packet_getSocketOutputLink(packet));
     }
 
     socket->outputBufferLength += length;
@@ -426,8 +437,8 @@ Packet* socket_removeFromOutputBuffer(Socket* socket) {
     MAGIC_ASSERT(socket);
 
     /* see if we have any packets */
-    Packet* packet = !g_queue_is_empty(socket->outputControlBuffer) ?
-            g_queue_pop_head(socket->outputControlBuffer) : g_queue_pop_head(socket->outputBuffer);
+    Packet* packet = !g_queue_is_empty(&(socket->outputControlBuffer)) ?
+            _socket_popBuffer(&(socket->outputControlBuffer)) : _socket_popBuffer(&(socket->outputBuffer));
 
     if(packet) {
         /* just removed a packet */
@@ -62,18 +62,22 @@ struct _Socket {
     gchar* unixPath;
 
     /* buffering packets readable by user */
-    GQueue* inputBuffer;
+    GQueue inputBuffer;
     gsize inputBufferSize;
     gsize inputBufferSizePending;
     gsize inputBufferLength;
 
     /* buffering packets ready to send */
-    GQueue* outputBuffer;
-    GQueue* outputControlBuffer;
+    GQueue outputBuffer;
+    GQueue outputControlBuffer;
     gsize outputBufferSize;
     gsize outputBufferSizePending;
     gsize outputBufferLength;
 
+    /* links for the round robin send queues of the loopback and the
+     * ethernet interface, so queuing us to send does not allocate */
+    GList interfaceLinks[2];
+
     MAGIC_DECLARE;
 };
 
@@ -84,6 +88,7 @@ void socket_pushInPacket(Socket* socket, Packet* packet);
 void socket_dropPacket(Socket* socket, Packet* packet);
 Packet* socket_pullOutPacket(Socket* socket);
 Packet* socket_peekNextPacket(const Socket* socket);
+GList* socket_getInterfaceLink(Socket* socket, gboolean isLoopback);
 
 gsize socket_getInputBufferSize(Socket* socket);
 void socket_setInputBufferSize(Socket* socket, gsize newSize);
@@ -20,14 +20,15 @@
 #include <sys/types.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
 #include "main/core/support/options.h"
-#include "main/core/work/task.h"
+#include "main/core/support/statistics.h"
+#include "main/core/work/event.h"
 #include "main/core/worker.h"
 #include "main/host/descriptor/descriptor.h"
 #include "main/host/descriptor/socket.h"
 #include "main/host/descriptor/tcp_cong.h"
 #include "main/host/descriptor/tcp_cong_reno.h"
+#include "main/host/descriptor/tcp_reassembly.h"
 #include "main/host/descriptor/tcp_retransmit_tally.h"
 #include "main/host/descriptor/transport.h"
 #include "main/host/host.h"
@@ -35,6 +36,7 @@
 #include "main/host/protocol.h"
 #include "main/host/tracker.h"
 #include "main/routing/address.h"
+#include "main/utility/byte_queue.h"
 #include "main/utility/priority_queue.h"
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
@@ -168,8 +170,10 @@ struct _TCP {
         guint32 numQuickACKsSent;
         gboolean delayedACKIsScheduled;
         guint32 delayedACKCounter;
-        /* list of selective ACKs, packets received after a missing packet */
+        /* list of selective ACKs, packets received after a missing packet.
+         * rebuilt from the unordered input before sending when it is stale. */
         GList* selectiveACKs;
+        gboolean selectiveACKsAreStale;
     } send;
 
     struct {
@@ -225,7 +229,7 @@ struct _TCP {
     gsize throttledOutputLength;
 
     /* TCP ensures that the user receives data in-order */
-    PriorityQueue* unorderedInput;
+    TCPReassembly* unorderedInput;
     /* track amount of queued application data */
     gsize unorderedInputLength;
 
@@ -239,6 +243,14 @@ struct _TCP {
     /* if I am a multiplexed child, I have a pointer to my parent */
     TCPChild* child;
 
+    /* when both ends of an established connection are on this host, the peer
+     * writes its user data straight into our input here instead of sending packets */
+    struct {
+        TCP* peer;
+        ByteQueue* input;
+        gsize inputLength;
+    } loopback;
+
     MAGIC_DECLARE;
 };
 
@@ -601,8 +613,9 @@ void tcp_disableReceiveBufferAutotuning(TCP* tcp) {
 }
 
 // XXX declaration
-static void _tcp_runCloseTimerExpiredTask(TCP* tcp, gpointer userData);
 static void _tcp_clearRetransmit(TCP* tcp, guint sequence);
+static void _tcp_loopbackUnpair(TCP* tcp);
+static TCP* _tcp_getSourceTCP(TCP* tcp, in_addr_t ip, in_port_t port);
 
 static void _tcp_setState(TCP* tcp, enum TCPState state) {
     MAGIC_ASSERT(tcp);
@@ -638,6 +651,7 @@ static void _tcp_setState(TCP* tcp, enum TCPState state) {
         }
         case TCPS_CLOSED: {
             _tcp_clearRetransmit(tcp, (guint)-1);
+            _tcp_loopbackUnpair(tcp);
 
             /* user can no longer use socket */
             descriptor_adjustStatus((Descriptor*)tcp, DS_ACTIVE, FALSE);
@@ -674,8 +688,6 @@ static void _tcp_setState(TCP* tcp, enum TCPState state) {
         case TCPS_TIMEWAIT: {
             /* schedule a close timer self-event to finish out the closing process */
             descriptor_ref(tcp);
-            Task* closeTask = task_new((TaskCallbackFunc)_tcp_runCloseTimerExpiredTask,
-                    tcp, NULL, descriptor_unref, NULL);
             SimulationTime delay = CONFIG_TCPCLOSETIMER_DELAY;
 
             /* if a child of a server initiated the close, close more quickly */
@@ -683,8 +695,7 @@ static void _tcp_setState(TCP* tcp, enum TCPState state) {
                 delay = SIMTIME_ONE_SECOND;
             }
 
-            worker_scheduleTask(closeTask, delay);
-            task_unref(closeTask);
+            worker_scheduleLocalEvent(event_newSocketTimer(tcp, EVENT_SOCKET_TIMER_CLOSE), delay);
             break;
         }
         default:
@@ -692,7 +703,7 @@ static void _tcp_setState(TCP* tcp, enum TCPState state) {
     }
 }
 
-static void _tcp_runCloseTimerExpiredTask(TCP* tcp, gpointer userData) {
+void tcp_closeTimerExpired(TCP* tcp) {
     MAGIC_ASSERT(tcp);
     _tcp_setState(tcp, TCPS_CLOSED);
 }
@@ -708,22 +719,135 @@ gsize tcp_getOutputBufferLength(TCP* tcp) {
 /* returns the total amount of buffered data in this TCP socket, including TCP-specific buffers */
 gsize tcp_getInputBufferLength(TCP* tcp) {
     MAGIC_ASSERT(tcp);
-    return socket_getInputBufferLength(&(tcp->super)) + tcp->unorderedInputLength;
+    return socket_getInputBufferLength(&(tcp->super)) + tcp->unorderedInputLength +
+            tcp->loopback.inputLength;
+}
+
+static gsize _tcp_getBufferSpaceIn(TCP* tcp) {
+    MAGIC_ASSERT(tcp);
+    /* account for unordered input buffer and data written by a loopback peer */
+    gssize space = (gssize)(socket_getInputBufferSpace(&(tcp->super)) -
+            tcp->unorderedInputLength - tcp->loopback.inputLength);
+    return MAX(0, space);
 }
 
 static gsize _tcp_getBufferSpaceOut(TCP* tcp) {
     MAGIC_ASSERT(tcp);
+    /* a loopback peer's input buffer is the only place our data goes */
+    if(tcp->loopback.peer) {
+        return _tcp_getBufferSpaceIn(tcp->loopback.peer);
+    }
     /* account for throttled and retransmission buffer */
     gssize s = (gssize)(socket_getOutputBufferSpace(&(tcp->super)) - tcp_getOutputBufferLength(tcp));
     gsize space = (gsize) MAX(0, s);
     return space;
 }
 
-static gsize _tcp_getBufferSpaceIn(TCP* tcp) {
+static void _tcp_loopbackUpdateWritable(TCP* tcp) {
     MAGIC_ASSERT(tcp);
-    /* account for unordered input buffer */
-    gssize space = (gssize)(socket_getInputBufferSpace(&(tcp->super)) - tcp->unorderedInputLength);
-    return MAX(0, space);
+    if(!(tcp->error & TCPE_SEND_EOF) && _tcp_getBufferSpaceOut(tcp) > 0) {
+        descriptor_adjustStatus((Descriptor*)tcp, DS_WRITABLE, TRUE);
+    }
+}
+
+/* connects the user data paths of a socket that just received the SYNACK and the
+ * child that sent it, if that child is on this host, so they no longer need packets
+ * to exchange data. we pair before the connecting socket can write anything. */
+static void _tcp_loopbackPair(TCP* tcp, PacketTCPHeader* header) {
+    MAGIC_ASSERT(tcp);
+
+    if(!options_doTCPLoopbackFastPath(worker_getOptions())) {
+        return;
+    }
+
+    /* the server must be bound to one of our own interfaces */
+    NetworkInterface* interface = host_lookupInterface(worker_getActiveHost(), header->sourceIP);
+    if(!interface) {
+        return;
+    }
+
+    Socket* socket = networkinterface_lookupConnectedSocket(interface, PTCP,
+            header->sourcePort, 0, 0);
+    if(!socket || descriptor_getType((Descriptor*)socket) != DT_TCPSOCKET) {
+        return;
+    }
+
+    /* the child that answered us is keyed by our address */
+    TCP* server = (TCP*)socket;
+    MAGIC_ASSERT(server);
+    TCP* peer = _tcp_getSourceTCP(server, header->destinationIP, header->destinationPort);
+    if(peer == server || !peer->child) {
+        return;
+    }
+    MAGIC_ASSERT(peer);
+
+    /* only pair before any user data was exchanged, so nothing can still be in
+     * flight and the sequence numbers stay valid if we fall back to packets. the
+     * child is still waiting for our ACK, and will get our data once accepted. */
+    enum TCPFlags closedFlags = TCPF_LOCAL_CLOSED_RD|TCPF_LOCAL_CLOSED_WR|TCPF_REMOTE_CLOSED;
+    if(peer->state != TCPS_SYNRECEIVED || peer->loopback.peer || (peer->flags & closedFlags) ||
+            (tcp->flags & closedFlags) || tcp_getOutputBufferLength(peer) > 0 ||
+            tcp_getInputBufferLength(peer) > 0 || tcp_getOutputBufferLength(tcp) > 0 ||
+            tcp_getInputBufferLength(tcp) > 0) {
+        return;
+    }
+
+    tcp->loopback.peer = peer;
+    peer->loopback.peer = tcp;
+    if(!tcp->loopback.input) {
+        tcp->loopback.input = bytequeue_new(8192);
+    }
+    if(!peer->loopback.input) {
+        peer->loopback.input = bytequeue_new(8192);
+    }
+
+    debug("%s <-> %s: paired with loopback peer %s <-> %s, user data will bypass packets",
+            tcp->super.boundString, tcp->super.peerString,
+            peer->super.boundString, peer->super.peerString);
+}
+
+static void _tcp_loopbackUnpair(TCP* tcp) {
+    MAGIC_ASSERT(tcp);
+
+    TCP* peer = tcp->loopback.peer;
+    if(!peer) {
+        return;
+    }
+    MAGIC_ASSERT(peer);
+
+    /* data that was already handed over stays readable, and is always read
+     * before anything that arrives later in packets */
+    tcp->loopback.peer = NULL;
+    peer->loopback.peer = NULL;
+
+    debug("%s <-> %s: unpaired from loopback peer, user data will use packets",
+            tcp->super.boundString, tcp->super.peerString);
+
+    /* the peer may have been blocked on our input, it now uses its own output buffer */
+    _tcp_loopbackUpdateWritable(peer);
+}
+
+static gssize _tcp_loopbackSendUserData(TCP* tcp, gconstpointer buffer, gsize nBytes) {
+    MAGIC_ASSERT(tcp);
+
+    TCP* peer = tcp->loopback.peer;
+    MAGIC_ASSERT(peer);
+
+    gsize copyLength = MIN(nBytes, _tcp_getBufferSpaceIn(peer));
+    if(copyLength > 0) {
+        bytequeue_push(peer->loopback.input, buffer, copyLength);
+        peer->loopback.inputLength += copyLength;
+        descriptor_adjustStatus((Descriptor*)peer, DS_READABLE, TRUE);
+    }
+
+    if(_tcp_getBufferSpaceOut(tcp) == 0) {
+        descriptor_adjustStatus((Descriptor*)tcp, DS_WRITABLE, FALSE);
+    }
+
+    debug("%s <-> %s: passed %"G_GSIZE_FORMAT" user bytes to loopback peer",
+            tcp->super.boundString, tcp->super.peerString, copyLength);
+
+    return (gssize) (copyLength == 0 ? -1 : copyLength);
 }
 
 static void _tcp_bufferPacketOut(TCP* tcp, Packet* packet) {
@@ -747,15 +871,24 @@ static void _tcp_bufferPacketOut(TCP* tcp, Packet* packet) {
 static void _tcp_bufferPacketIn(TCP* tcp, Packet* packet) {
     MAGIC_ASSERT(tcp);
 
-    if(!priorityqueue_find(tcp->unorderedInput, packet)) {
-        /* TCP wants in-order data */
-        priorityqueue_push(tcp->unorderedInput, packet);
+    guint sequence = packet_getTCPHeader(packet)->sequence;
+
+    /* TCP wants in-order data, and duplicates are dropped */
+    if(tcpreassembly_add(tcp->unorderedInput, packet)) {
         packet_ref(packet);
 
+        if(sequence != tcp->receive.next) {
+            debug("%s buffered out-of-order packet %u while expecting %u",
+                    tcp->super.boundString, sequence, tcp->receive.next);
+        }
+
         /* account for the packet length */
         tcp->unorderedInputLength += packet_getPayloadLength(packet);
+        tcp->send.selectiveACKsAreStale = TRUE;
 
         packet_addDeliveryStatus(packet, PDS_RCV_TCP_ENQUEUE_UNORDERED);
+    } else {
+        debug("%s dropped duplicate packet %u", tcp->super.boundString, sequence);
     }
 }
 
@@ -920,8 +1053,6 @@ static void _tcp_clearRetransmitRange(TCP* tcp, guint begin, guint end) {
 }
 
 // XXX forward declaration
-static void _tcp_runRetransmitTimerExpiredTask(TCP* tcp, gpointer userData);
-
 static void _tcp_scheduleRetransmitTimer(TCP* tcp, SimulationTime now, SimulationTime delay) {
     MAGIC_ASSERT(tcp);
 
@@ -931,10 +1062,7 @@ static void _tcp_scheduleRetransmitTimer(TCP* tcp, SimulationTime now, Simulatio
 
     if(success) {
         descriptor_ref(tcp);
-        Task* retexpTask = task_new((TaskCallbackFunc)_tcp_runRetransmitTimerExpiredTask,
-                tcp, NULL, descriptor_unref, NULL);
-        worker_scheduleTask(retexpTask, delay);
-        task_unref(retexpTask);
+        worker_scheduleLocalEvent(event_newSocketTimer(tcp, EVENT_SOCKET_TIMER_RETRANSMIT), delay);
 
         debug("%s retransmit timer scheduled for %"G_GUINT64_FORMAT" ns",
                 tcp->super.boundString, *expireTimePtr);
@@ -1092,6 +1220,15 @@ void tcp_networkInterfaceIsAboutToSendPacket(TCP* tcp, Packet* packet) {
 
     SimulationTime now = worker_getCurrentTime();
 
+    /* the selective ACKs are exactly the packets we hold beyond the next expected one */
+    if(tcp->send.selectiveACKsAreStale) {
+        if(tcp->send.selectiveACKs) {
+            g_list_free(tcp->send.selectiveACKs);
+        }
+        tcp->send.selectiveACKs = tcpreassembly_getSequences(tcp->unorderedInput);
+        tcp->send.selectiveACKsAreStale = FALSE;
+    }
+
     /* update TCP header to our current advertised window and acknowledgment and timestamps */
     packet_updateTCP(packet, tcp->receive.next, tcp->send.selectiveACKs, tcp->receive.window, now, tcp->receive.lastTimestamp);
 
@@ -1207,8 +1344,8 @@ static void _tcp_flush(TCP* tcp) {
     }
 
     /* any packets now in order can be pushed to our user input buffer */
-    while(!priorityqueue_isEmpty(tcp->unorderedInput)) {
-        Packet* packet = priorityqueue_peek(tcp->unorderedInput);
+    while(!tcpreassembly_isEmpty(tcp->unorderedInput)) {
+        Packet* packet = tcpreassembly_peek(tcp->unorderedInput);
 
         PacketTCPHeader* header = packet_getTCPHeader(packet);
 
@@ -1220,9 +1357,10 @@ static void _tcp_flush(TCP* tcp) {
             if(fitInBuffer) {
                 // fprintf(stderr, "SND/RCV Recv %s %s %d @ %f\n", tcp->super.boundString, tcp->super.peerString, header.sequence, dtime);
                 tcp->receive.lastSequence = header->sequence;
-                priorityqueue_pop(tcp->unorderedInput);
-                packet_unref(packet);
+                tcpreassembly_pop(tcp->unorderedInput);
                 tcp->unorderedInputLength -= packet_getPayloadLength(packet);
+                packet_unref(packet);
+                tcp->send.selectiveACKsAreStale = TRUE;
                 (tcp->receive.next)++;
                 continue;
             }
@@ -1277,7 +1415,7 @@ static void _tcp_flush(TCP* tcp) {
     }
 }
 
-static void _tcp_runRetransmitTimerExpiredTask(TCP* tcp, gpointer userData) {
+void tcp_retransmitTimerExpired(TCP* tcp) {
     MAGIC_ASSERT(tcp);
 
     /* a timer expired, update our timer tracking state */
@@ -1576,24 +1714,6 @@ static TCP* _tcp_getSourceTCP(TCP* tcp, in_addr_t ip, in_port_t port) {
     return tcp;
 }
 
-static GList* _tcp_removeSacks(GList* selectiveACKs, gint sequence) {
-    GList *unacked = NULL;
-    if(selectiveACKs) {
-        GList *iter = selectiveACKs;
-        while(iter) {
-            gint sackSequence = GPOINTER_TO_INT(iter->data);
-
-            if(sackSequence > sequence) {
-                unacked = g_list_append(unacked, iter->data);
-            }
-
-            iter = g_list_next(iter);
-        }
-        g_list_free(selectiveACKs);
-    }
-    return unacked;
-}
-
 TCPProcessFlags _tcp_dataProcessing(TCP* tcp, Packet* packet, PacketTCPHeader *header) {
     MAGIC_ASSERT(tcp);
 
@@ -1617,30 +1737,8 @@ TCPProcessFlags _tcp_dataProcessing(TCP* tcp, Packet* packet, PacketTCPHeader *h
         gboolean isNextPacket = (header->sequence == tcp->receive.next) ? TRUE : FALSE;
         gboolean packetFits = (packetLength <= _tcp_getBufferSpaceIn(tcp)) ? TRUE : FALSE;
 
-        /* SACK: if not next packet, one was dropped and we need to include this in the selective ACKs */
-        if(!isNextPacket && packetFits) {
-            tcp->send.selectiveACKs = g_list_append(tcp->send.selectiveACKs, GINT_TO_POINTER(header->sequence));
-        } else if(tcp->send.selectiveACKs && g_list_length(tcp->send.selectiveACKs) > 0) {
-            /* find the first gap in SACKs and remove everything before it */
-            GList *iter = g_list_first(tcp->send.selectiveACKs);
-            GList *next = g_list_next(iter);
-
-            gint firstSequence = GPOINTER_TO_INT(iter->data);
-            if(firstSequence <= header->sequence + 1) {
-                while(next) {
-                    gint currSequence = GPOINTER_TO_INT(iter->data);
-                    gint nextSequence = GPOINTER_TO_INT(next->data);
-                    /* check for a gap in sequences */
-                    if(currSequence + 1 < nextSequence && currSequence > header->sequence) {
-                        break;
-                    }
-                    iter = next;
-                    next = g_list_next(iter);
-                }
-
-                tcp->send.selectiveACKs = _tcp_removeSacks(tcp->send.selectiveACKs, GPOINTER_TO_INT(iter->data));
-            }
-        }
+        /* SACK: packets that are not next are held in the unordered input, and
+         * the selective ACKs are regenerated from it when we send */
 
         DescriptorStatus s = descriptor_getStatus((Descriptor*) tcp);
         gboolean waitingUserRead = (s & DS_READABLE) ? TRUE : FALSE;
@@ -1764,7 +1862,7 @@ static void _tcp_logCongestionInfo(TCP* tcp) {
             tcp->super.super.super.handle);
 }
 
-static void _tcp_sendACKTaskCallback(TCP* tcp, gpointer userData) {
+void tcp_sendDelayedACK(TCP* tcp) {
     MAGIC_ASSERT(tcp);
     tcp->send.delayedACKIsScheduled = FALSE;
     if(tcp->send.delayedACKCounter > 0) {
@@ -1866,6 +1964,9 @@ void tcp_processPacket(TCP* tcp, Packet* packet) {
 
                 /* remove the SYN from the retransmit queue */
                 _tcp_clearRetransmit(tcp, 1);
+
+                /* the server may be on this host too */
+                _tcp_loopbackPair(tcp, header);
             }
             /* receive SYN, send ACK, move to SYNRECEIVED (simultaneous open) */
             else if(header->flags & PTCP_SYN) {
@@ -2066,9 +2167,7 @@ void tcp_processPacket(TCP* tcp, Packet* packet) {
             if(tcp->send.delayedACKIsScheduled == FALSE) {
                 /* we need to send an ACK, lets schedule a task so we don't send an ACK
                  * for all packets that are received during this same simtime receiving round. */
-                Task* sendACKTask = task_new((TaskCallbackFunc)_tcp_sendACKTaskCallback,
-                                tcp, NULL, descriptor_unref, NULL);
-                /* taks holds a ref to tcp */
+                /* the event holds a ref to tcp */
                 descriptor_ref(tcp);
 
                 /* figure out what we should use as delay */
@@ -2082,8 +2181,7 @@ void tcp_processPacket(TCP* tcp, Packet* packet) {
                     delay = 5*SIMTIME_ONE_MILLISECOND;
                 }
 
-                worker_scheduleTask(sendACKTask, delay);
-                task_unref(sendACKTask);
+                worker_scheduleLocalEvent(event_newSocketTimer(tcp, EVENT_SOCKET_TIMER_DELAYED_ACK), delay);
 
                 tcp->send.delayedACKIsScheduled = TRUE;
             }
@@ -2139,6 +2237,10 @@ gssize tcp_sendUserData(TCP* tcp, gconstpointer buffer, gsize nBytes, in_addr_t
         }
     }
 
+    if(tcp->loopback.peer) {
+        return _tcp_loopbackSendUserData(tcp, buffer, nBytes);
+    }
+
     /* maximum data we can send network, o/w tcp truncates and only sends 65536*/
     gsize acceptable = MIN(nBytes, 65535);
     gsize space = _tcp_getBufferSpaceOut(tcp);
@@ -2177,7 +2279,7 @@ gssize tcp_sendUserData(TCP* tcp, gconstpointer buffer, gsize nBytes, in_addr_t
     return (gssize) (bytesCopied == 0 ? -1 : bytesCopied);
 }
 
-static void _tcp_sendWindowUpdate(TCP* tcp, gpointer data) {
+void tcp_sendWindowUpdate(TCP* tcp) {
     MAGIC_ASSERT(tcp);
     debug("%s <-> %s: receive window opened, advertising the new "
             "receive window %"G_GUINT32_FORMAT" as an ACK control packet",
@@ -2209,6 +2311,21 @@ gssize tcp_receiveUserData(TCP* tcp, gpointer buffer, gsize nBytes, in_addr_t* i
     gsize offset = 0;
     gsize copyLength = 0;
 
+    /* data from a loopback peer was always written before any data still in packets */
+    if(remaining > 0 && tcp->loopback.inputLength > 0) {
+        copyLength = MIN(tcp->loopback.inputLength, remaining);
+        bytesCopied = bytequeue_pop(tcp->loopback.input, buffer, copyLength);
+        tcp->loopback.inputLength -= bytesCopied;
+        totalCopied += bytesCopied;
+        remaining -= bytesCopied;
+        offset += bytesCopied;
+
+        /* the peer may be waiting for space in our input */
+        if(tcp->loopback.peer) {
+            _tcp_loopbackUpdateWritable(tcp->loopback.peer);
+        }
+    }
+
     /* check if we have a partial packet waiting to get finished */
     if(remaining > 0 && tcp->partialUserDataPacket) {
         guint partialLength = packet_getPayloadLength(tcp->partialUserDataPacket);
@@ -2216,7 +2333,7 @@ gssize tcp_receiveUserData(TCP* tcp, gpointer buffer, gsize nBytes, in_addr_t* i
         utility_assert(partialBytes > 0);
 
         copyLength = MIN(partialBytes, remaining);
-        bytesCopied = packet_copyPayload(tcp->partialUserDataPacket, tcp->partialOffset, buffer, copyLength);
+        bytesCopied = packet_copyPayload(tcp->partialUserDataPacket, tcp->partialOffset, buffer + offset, copyLength);
         totalCopied += bytesCopied;
         remaining -= bytesCopied;
         offset += bytesCopied;
@@ -2268,7 +2385,8 @@ gssize tcp_receiveUserData(TCP* tcp, gpointer buffer, gsize nBytes, in_addr_t* i
     }
 
     /* now we update readability of the socket */
-    if((socket_getInputBufferLength(&(tcp->super)) > 0) || (tcp->partialUserDataPacket != NULL)) {
+    if((socket_getInputBufferLength(&(tcp->super)) > 0) || (tcp->partialUserDataPacket != NULL) ||
+            (tcp->loopback.inputLength > 0)) {
         /* we still have readable data */
         descriptor_adjustStatus(&(tcp->super.super.super), DS_READABLE, TRUE);
     } else {
@@ -2307,16 +2425,14 @@ gssize tcp_receiveUserData(TCP* tcp, gpointer buffer, gsize nBytes, in_addr_t* i
     /* if we have advertised a 0 window because the application wasn't reading,
      * we now have to update the window and let the sender know */
     _tcp_updateReceiveWindow(tcp);
-    if(tcp->receive.window > tcp->send.lastWindow && !tcp->receive.windowUpdatePending) {
+    if(tcp->receive.window > tcp->send.lastWindow && !tcp->receive.windowUpdatePending &&
+            !tcp->loopback.peer) {
         /* our receive window just opened, make sure the sender knows it can
          * send more. otherwise we get into a deadlock situation!
          * make sure we don't send multiple events when read is called many times per instant */
         descriptor_ref(tcp);
 
-        Task* updateWindowTask = task_new((TaskCallbackFunc)_tcp_sendWindowUpdate,
-                tcp, NULL, descriptor_unref, NULL);
-        worker_scheduleTask(updateWindowTask, 1);
-        task_unref(updateWindowTask);
+        worker_scheduleLocalEvent(event_newSocketTimer(tcp, EVENT_SOCKET_TIMER_WINDOW_UPDATE), 1);
 
         tcp->receive.windowUpdatePending = TRUE;
     }
@@ -2330,10 +2446,18 @@ void tcp_free(TCP* tcp) {
     MAGIC_ASSERT(tcp);
 
     priorityqueue_free(tcp->throttledOutput);
-    priorityqueue_free(tcp->unorderedInput);
+    tcpreassembly_free(tcp->unorderedInput);
+    if(tcp->send.selectiveACKs) {
+        g_list_free(tcp->send.selectiveACKs);
+    }
     g_hash_table_destroy(tcp->retransmit.queue);
     priorityqueue_free(tcp->retransmit.scheduledTimerExpirations);
 
+    _tcp_loopbackUnpair(tcp);
+    if(tcp->loopback.input) {
+        bytequeue_free(tcp->loopback.input);
+    }
+
     if(tcp->child) {
         MAGIC_ASSERT(tcp->child);
         MAGIC_ASSERT(tcp->child->parent);
@@ -2367,6 +2491,9 @@ void tcp_close(TCP* tcp) {
     tcp->flags |= TCPF_LOCAL_CLOSED_WR;
     tcp->flags |= TCPF_LOCAL_CLOSED_RD;
 
+    /* anything the peer writes from now on goes through the regular close handling */
+    _tcp_loopbackUnpair(tcp);
+
     /* the user closed the connection, so should never interact with the socket again */
     descriptor_adjustStatus((Descriptor*)tcp, DS_ACTIVE, FALSE);
 
@@ -2419,6 +2546,7 @@ gint tcp_shutdown(TCP* tcp, gint how) {
         /* can't receive any more */
         tcp->flags |= TCPF_LOCAL_CLOSED_RD;
         tcp->error |= TCPE_RECEIVE_EOF;
+        _tcp_loopbackUnpair(tcp);
     }
 
     if((how == SHUT_WR || how == SHUT_RDWR) && !(tcp->flags & TCPF_LOCAL_CLOSED_WR)) {
@@ -2494,8 +2622,7 @@ TCP* tcp_new(gint handle, guint receiveBufferSize, guint sendBufferSize) {
 
     tcp->throttledOutput =
             priorityqueue_new((GCompareDataFunc)packet_compareTCPSequence, NULL, (GDestroyNotify)packet_unref);
-    tcp->unorderedInput =
-            priorityqueue_new((GCompareDataFunc)packet_compareTCPSequence, NULL, (GDestroyNotify)packet_unref);
+    tcp->unorderedInput = tcpreassembly_new();
     tcp->retransmit.queue =
             g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)packet_unref);
 
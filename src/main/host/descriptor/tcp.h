@@ -62,6 +62,12 @@ gint tcp_shutdown(TCP* tcp, gint how);
 
 void tcp_networkInterfaceIsAboutToSendPacket(TCP* tcp, Packet* packet);
 
+/* called when the timer events that a socket scheduled on its own host run */
+void tcp_closeTimerExpired(TCP* tcp);
+void tcp_retransmitTimerExpired(TCP* tcp);
+void tcp_sendDelayedACK(TCP* tcp);
+void tcp_sendWindowUpdate(TCP* tcp);
+
 TCPCongestionType tcpCongestion_getType(const gchar* type);
 
 #endif /* SHD_TCP_H_ */
@@ -0,0 +1,194 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <glib.h>
+
+#include "main/host/descriptor/tcp_reassembly.h"
+#include "main/routing/packet.h"
+#include "main/utility/utility.h"
+
+/* packets with the consecutive sequence numbers start, start+1, ... */
+typedef struct _TCPReassemblyRun TCPReassemblyRun;
+struct _TCPReassemblyRun {
+    guint start;
+    GQueue packets;
+};
+
+struct _TCPReassembly {
+    /* runs sorted by start, no two of them adjacent or overlapping */
+    GArray* runs;
+    MAGIC_DECLARE;
+};
+
+static inline TCPReassemblyRun* _tcpreassembly_getRun(TCPReassembly* reassembly, guint index) {
+    return &g_array_index(reassembly->runs, TCPReassemblyRun, index);
+}
+
+static inline guint _tcpreassemblyrun_getEnd(TCPReassemblyRun* run) {
+    return run->start + g_queue_get_length(&run->packets);
+}
+
+static inline guint _tcpreassembly_getSequence(Packet* packet) {
+    return packet_getTCPHeader(packet)->sequence;
+}
+
+TCPReassembly* tcpreassembly_new() {
+    TCPReassembly* reassembly = g_new0(TCPReassembly, 1);
+    MAGIC_INIT(reassembly);
+
+    reassembly->runs = g_array_new(FALSE, FALSE, sizeof(TCPReassemblyRun));
+
+    return reassembly;
+}
+
+void tcpreassembly_free(TCPReassembly* reassembly) {
+    MAGIC_ASSERT(reassembly);
+
+    for(guint i = 0; i < reassembly->runs->len; i++) {
+        TCPReassemblyRun* run = _tcpreassembly_getRun(reassembly, i);
+        while(!g_queue_is_empty(&run->packets)) {
+            packet_unref(g_queue_pop_head(&run->packets));
+        }
+    }
+    g_array_free(reassembly->runs, TRUE);
+
+    MAGIC_CLEAR(reassembly);
+    g_free(reassembly);
+}
+
+/* returns the index of the last run starting at or before sequence, or -1 if there is none */
+static gint _tcpreassembly_findRun(TCPReassembly* reassembly, guint sequence) {
+    gint low = 0;
+    gint high = (gint)reassembly->runs->len - 1;
+    gint found = -1;
+
+    while(low <= high) {
+        gint middle = low + (high - low) / 2;
+        if(_tcpreassembly_getRun(reassembly, (guint)middle)->start <= sequence) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return found;
+}
+
+static void _tcpreassembly_insertRun(TCPReassembly* reassembly, guint index, Packet* packet, guint sequence) {
+    TCPReassemblyRun run = {.start = sequence};
+    g_queue_init(&run.packets);
+    g_queue_push_tail(&run.packets, packet);
+    g_array_insert_val(reassembly->runs, index, run);
+}
+
+gboolean tcpreassembly_add(TCPReassembly* reassembly, Packet* packet) {
+    MAGIC_ASSERT(reassembly);
+    utility_assert(packet);
+
+    guint sequence = _tcpreassembly_getSequence(packet);
+    guint nRuns = reassembly->runs->len;
+
+    /* after a loss, the following packets usually arrive in order at the end */
+    if(nRuns > 0) {
+        TCPReassemblyRun* last = _tcpreassembly_getRun(reassembly, nRuns - 1);
+        guint end = _tcpreassemblyrun_getEnd(last);
+        if(sequence == end) {
+            g_queue_push_tail(&last->packets, packet);
+            return TRUE;
+        } else if(sequence > end) {
+            _tcpreassembly_insertRun(reassembly, nRuns, packet, sequence);
+            return TRUE;
+        }
+    }
+
+    gint index = _tcpreassembly_findRun(reassembly, sequence);
+
+    if(index >= 0) {
+        TCPReassemblyRun* run = _tcpreassembly_getRun(reassembly, (guint)index);
+        guint end = _tcpreassemblyrun_getEnd(run);
+
+        if(sequence < end) {
+            /* we already have this one */
+            return FALSE;
+        } else if(sequence == end) {
+            g_queue_push_tail(&run->packets, packet);
+
+            /* the packet may have closed the gap to the next run */
+            if((guint)index + 1 < reassembly->runs->len) {
+                TCPReassemblyRun* next = _tcpreassembly_getRun(reassembly, (guint)index + 1);
+                if(next->start == sequence + 1) {
+                    while(!g_queue_is_empty(&next->packets)) {
+                        g_queue_push_tail(&run->packets, g_queue_pop_head(&next->packets));
+                    }
+                    g_array_remove_index(reassembly->runs, (guint)index + 1);
+                }
+            }
+            return TRUE;
+        }
+    }
+
+    /* the packet comes after the gap following run index, if any */
+    guint nextIndex = (guint)(index + 1);
+    if(nextIndex < reassembly->runs->len) {
+        TCPReassemblyRun* next = _tcpreassembly_getRun(reassembly, nextIndex);
+        if(next->start == sequence + 1) {
+            g_queue_push_head(&next->packets, packet);
+            next->start = sequence;
+            return TRUE;
+        }
+    }
+
+    _tcpreassembly_insertRun(reassembly, nextIndex, packet, sequence);
+    return TRUE;
+}
+
+Packet* tcpreassembly_peek(TCPReassembly* reassembly) {
+    MAGIC_ASSERT(reassembly);
+
+    if(reassembly->runs->len == 0) {
+        return NULL;
+    }
+    return g_queue_peek_head(&_tcpreassembly_getRun(reassembly, 0)->packets);
+}
+
+Packet* tcpreassembly_pop(TCPReassembly* reassembly) {
+    MAGIC_ASSERT(reassembly);
+
+    if(reassembly->runs->len == 0) {
+        return NULL;
+    }
+
+    TCPReassemblyRun* first = _tcpreassembly_getRun(reassembly, 0);
+    Packet* packet = g_queue_pop_head(&first->packets);
+    first->start++;
+
+    if(g_queue_is_empty(&first->packets)) {
+        g_array_remove_index(reassembly->runs, 0);
+    }
+
+    return packet;
+}
+
+gboolean tcpreassembly_isEmpty(TCPReassembly* reassembly) {
+    MAGIC_ASSERT(reassembly);
+    return (reassembly->runs->len == 0) ? TRUE : FALSE;
+}
+
+GList* tcpreassembly_getSequences(TCPReassembly* reassembly) {
+    MAGIC_ASSERT(reassembly);
+
+    GList* sequences = NULL;
+
+    /* prepend from the back so we do not walk the list for every element */
+    for(guint i = reassembly->runs->len; i > 0; i--) {
+        TCPReassemblyRun* run = _tcpreassembly_getRun(reassembly, i - 1);
+        for(guint sequence = _tcpreassemblyrun_getEnd(run); sequence > run->start; sequence--) {
+            sequences = g_list_prepend(sequences, GINT_TO_POINTER(sequence - 1));
+        }
+    }
+
+    return sequences;
+}
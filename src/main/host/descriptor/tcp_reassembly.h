@@ -0,0 +1,39 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SHD_TCP_REASSEMBLY_H_
+#define SHD_TCP_REASSEMBLY_H_
+
+#include <glib.h>
+
+#include "main/routing/packet.h"
+
+/**
+ * Holds the TCP packets that arrived ahead of the next expected sequence
+ * number until the missing packets arrive. Packets are kept in sorted runs of
+ * consecutive sequence numbers, so appending to a run, detecting duplicates
+ * and taking the lowest packet do not need a heap or a hash probe.
+ */
+
+typedef struct _TCPReassembly TCPReassembly;
+
+TCPReassembly* tcpreassembly_new();
+/* unrefs all packets that are still buffered */
+void tcpreassembly_free(TCPReassembly* reassembly);
+
+/* returns FALSE without taking the packet if its sequence is already buffered.
+ * on success the buffer takes over the caller's packet reference. */
+gboolean tcpreassembly_add(TCPReassembly* reassembly, Packet* packet);
+/* the buffered packet with the lowest sequence number, or NULL if empty */
+Packet* tcpreassembly_peek(TCPReassembly* reassembly);
+/* removes the packet returned by peek, and returns it with its reference */
+Packet* tcpreassembly_pop(TCPReassembly* reassembly);
+gboolean tcpreassembly_isEmpty(TCPReassembly* reassembly);
+
+/* a new list of the buffered sequence numbers in ascending order, which
+ * the caller must free with g_list_free() */
+GList* tcpreassembly_getSequences(TCPReassembly* reassembly);
+
+#endif /* SHD_TCP_REASSEMBLY_H_ */
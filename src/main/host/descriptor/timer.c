@@ -12,8 +12,8 @@
 #include <time.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
-#include "main/core/work/task.h"
+#include "main/core/support/statistics.h"
+#include "main/core/work/event.h"
 #include "main/core/worker.h"
 #include "main/host/descriptor/descriptor.h"
 #include "main/host/host.h"
@@ -196,38 +196,27 @@ static void _timer_setCurrentInterval(Timer* timer, const struct timespec* confi
     timer->expireInterval = _timer_timespecToSimTime(config, FALSE);
 }
 
-static void _timer_expire(Timer* timer, gpointer data);
-
 static void _timer_scheduleNewExpireEvent(Timer* timer) {
     MAGIC_ASSERT(timer);
 
-    /* callback to our own node */
-    gpointer next = GUINT_TO_POINTER(timer->nextExpireID);
-
-    /* ref the timer storage in the callback event */
+    /* ref the timer storage in the expire event */
     descriptor_ref(timer);
-    Task* task = task_new((TaskCallbackFunc)_timer_expire,
-            timer, next, descriptor_unref, NULL);
-
     SimulationTime delay = timer->nextExpireTime - worker_getCurrentTime();
 
     /* if the user set a super long delay, let's call back sooner to check if they closed
      * or disarmed the timer in the meantime. This prevents queueing the task indefinitely. */
     delay = MIN(delay, SIMTIME_ONE_SECOND);
 
-    worker_scheduleTask(task, delay);
-    task_unref(task);
+    worker_scheduleLocalEvent(event_newTimerExpire(timer, timer->nextExpireID), delay);
 
     timer->nextExpireID++;
     timer->numEventsScheduled++;
 }
 
-static void _timer_expire(Timer* timer, gpointer data) {
+/* called when an expire event that we scheduled on our own host runs */
+void timer_expire(Timer* timer, guint expireID) {
     MAGIC_ASSERT(timer);
 
-    /* this is a task callback event */
-
-    guint expireID = GPOINTER_TO_UINT(data);
     debug("timer fd %i expired; isClosed=%i expireID=%u minValidExpireID=%u", timer->super.handle, timer->isClosed, expireID, timer->minValidExpireID);
 
     timer->numEventsScheduled--;
@@ -19,5 +19,6 @@ gint timer_setTime(Timer* timer, gint flags,
 gint timer_getTime(Timer* timer, struct itimerspec *curr_value);
 ssize_t timer_read(Timer* timer, void *buf, size_t count);
 gint timer_close(Timer* timer);
+void timer_expire(Timer* timer, guint expireID);
 
 #endif /* SHD_TIMER_H_ */
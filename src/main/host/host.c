@@ -18,7 +18,7 @@
 #include <sys/un.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/host/cpu.h"
 #include "main/host/descriptor/channel.h"
@@ -34,6 +34,7 @@
 #include "main/host/process.h"
 #include "main/host/protocol.h"
 #include "main/host/tracker.h"
+#include "main/host/traffic_model.h"
 #include "main/routing/address.h"
 #include "main/routing/dns.h"
 #include "main/routing/packet.h"
@@ -45,10 +46,6 @@
 #include "support/logger/logger.h"
 
 struct _Host {
-    /* general node lock. nothing that belongs to the node should be touched
-     * unless holding this lock. everything following this falls under the lock. */
-    GMutex lock;
-
     HostParameters params;
 
     /* The router upstream from the host, from which we receive packets. */
@@ -61,11 +58,15 @@ struct _Host {
     /* the virtual processes this host is running */
     GQueue* processes;
 
+    /* the built-in traffic models this host is running without a process */
+    GQueue* trafficModels;
+
     /* a statistics tracker for in/out bytes, CPU, memory, etc. */
     Tracker* tracker;
 
-    /* virtual descriptor numbers */
-    GQueue* availableDescriptors;
+    /* virtual descriptor numbers. the returned handles are sorted in
+     * decreasing order so that the lowest one is popped off the end. */
+    GArray* availableDescriptors;
     gint descriptorHandleCounter;
 
     /* virtual process and event id counter */
@@ -95,8 +96,19 @@ struct _Host {
     /* random stream */
     Random* random;
 
-    /* track the time spent executing this host */
-    GTimer* executionTimer;
+    /* track the time spent executing this host, in cycle counter units */
+    struct {
+        guint64 cycles;
+        guint64 startCycles;
+    } execution;
+
+    /* when this host last executed an event, and if its process memory was
+     * paged out since then */
+    SimulationTime lastActiveTime;
+    gboolean isSpilled;
+
+    /* opaque state owned by the scheduler policy, e.g. this host's event queue */
+    gpointer schedulerData;
 
     gchar* dataDirPath;
 
@@ -111,9 +123,8 @@ Host* host_new(HostParameters* params) {
     Host* host = g_new0(Host, 1);
     MAGIC_INIT(host);
 
-    /* start tracking execution time for this host.
-     * creating the timer automatically starts it. */
-    host->executionTimer = g_timer_new();
+    /* start tracking execution time for this host */
+    host_continueExecutionTimer(host);
 
     /* first copy the entire struct of params */
     host->params = *params;
@@ -127,12 +138,9 @@ Host* host_new(HostParameters* params) {
     if(params->typeHint) host->params.typeHint = g_strdup(params->typeHint);
     if(params->pcapDir) host->params.pcapDir = g_strdup(params->pcapDir);
 
-    /* thread-level event communication with other nodes */
-    g_mutex_init(&(host->lock));
-
     host->interfaces = g_hash_table_new_full(g_direct_hash, g_direct_equal,
             NULL, (GDestroyNotify) networkinterface_free);
-    host->availableDescriptors = g_queue_new();
+    host->availableDescriptors = g_array_new(FALSE, FALSE, sizeof(gint));
     host->descriptorHandleCounter = MIN_DESCRIPTOR;
 
     /* virtual descriptor management */
@@ -144,6 +152,7 @@ Host* host_new(HostParameters* params) {
 
     /* applications this node will run */
     host->processes = g_queue_new();
+    host->trafficModels = g_queue_new();
 
     message("Created host id '%u' name '%s'", (guint)host->params.id, g_quark_to_string(host->params.id));
 
@@ -151,7 +160,7 @@ Host* host_new(HostParameters* params) {
     host->referenceCount = 1;
 
     /* we go back to the slave setup process here, so stop counting this host execution */
-    g_timer_stop(host->executionTimer);
+    host_stopExecutionTimer(host);
 
     worker_countObject(OBJECT_TYPE_HOST, COUNTER_TYPE_NEW);
 
@@ -231,7 +240,7 @@ static void _host_free(Host* host) {
  * process that actually hold references to the host. if you just called host_unref instead
  * of this function, then host_free would never actually get called. */
 void host_shutdown(Host* host) {
-    g_timer_continue(host->executionTimer);
+    host_continueExecutionTimer(host);
 
     info("shutting down host %s", host->params.hostname);
 
@@ -239,6 +248,10 @@ void host_shutdown(Host* host) {
         g_queue_free(host->processes);
     }
 
+    if(host->trafficModels) {
+        g_queue_free(host->trafficModels);
+    }
+
     if(host->defaultAddress) {
         topology_detach(worker_getTopology(), host->defaultAddress);
         //address_unref(host->defaultAddress);
@@ -292,7 +305,7 @@ void host_shutdown(Host* host) {
     }
 
     if(host->availableDescriptors) {
-        g_queue_free(host->availableDescriptors);
+        g_array_free(host->availableDescriptors, TRUE);
     }
     if(host->random) {
         random_free(host->random);
@@ -305,20 +318,39 @@ void host_shutdown(Host* host) {
     if(host->params.typeHint) g_free(host->params.typeHint);
     if(host->params.pcapDir) g_free(host->params.pcapDir);
 
-    g_mutex_clear(&(host->lock));
-
     if(host->dataDirPath) {
         g_free(host->dataDirPath);
     }
 
-    gdouble totalExecutionTime = g_timer_elapsed(host->executionTimer, NULL);
+    host_stopExecutionTimer(host);
+    gdouble totalExecutionTime = host_getElapsedExecutionTime(host);
 
     message("host '%s' has been shut down, total execution time was %f seconds",
             host->params.hostname, totalExecutionTime);
 
     if(host->defaultAddress) address_unref(host->defaultAddress);
     if(host->params.hostname) g_free(host->params.hostname);
-    g_timer_destroy(host->executionTimer);
+}
+
+/* writes out everything the host buffered without freeing any of its state,
+ * for when the simulator exits without tearing the hosts down */
+void host_flush(Host* host) {
+    MAGIC_ASSERT(host);
+
+    if(host->interfaces) {
+        GHashTableIter iter;
+        gpointer key, value;
+        g_hash_table_iter_init(&iter, host->interfaces);
+        while(g_hash_table_iter_next(&iter, &key, &value)) {
+            NetworkInterface* interface = value;
+            networkinterface_flush(interface);
+        }
+    }
+
+    gdouble totalExecutionTime = host_getElapsedExecutionTime(host);
+
+    message("host '%s' has been flushed, total execution time was %f seconds",
+            host->params.hostname, totalExecutionTime);
 }
 
 void host_ref(Host* host) {
@@ -335,32 +367,70 @@ void host_unref(Host* host) {
     }
 }
 
-void host_lock(Host* host) {
+/* resumes the execution timer for this host */
+void host_continueExecutionTimer(Host* host) {
     MAGIC_ASSERT(host);
-    g_mutex_lock(&(host->lock));
+    host->execution.startCycles = utility_getCycleCount();
 }
 
-void host_unlock(Host* host) {
+/* stops the execution timer for this host */
+void host_stopExecutionTimer(Host* host) {
     MAGIC_ASSERT(host);
-    g_mutex_unlock(&(host->lock));
+    host_addExecutionCycles(host, utility_getCycleCount() - host->execution.startCycles);
 }
 
-/* resumes the execution timer for this host */
-void host_continueExecutionTimer(Host* host) {
+/* charges time that the caller measured with utility_getCycleCount() to this
+ * host, for callers that time a whole run of events instead of each one */
+void host_addExecutionCycles(Host* host, guint64 cycles) {
     MAGIC_ASSERT(host);
-    g_timer_continue(host->executionTimer);
+    host->execution.cycles += cycles;
 }
 
-/* stops the execution timer for this host */
-void host_stopExecutionTimer(Host* host) {
+void host_markActive(Host* host, SimulationTime now) {
     MAGIC_ASSERT(host);
-    g_timer_stop(host->executionTimer);
+    host->lastActiveTime = now;
+    if(host->isSpilled) {
+        /* the kernel pages the memory back in as the processes touch it */
+        host->isSpilled = FALSE;
+        debug("host %s became active again after its memory was paged out", host_getName(host));
+    }
+}
+
+SimulationTime host_getLastActiveTime(Host* host) {
+    MAGIC_ASSERT(host);
+    return host->lastActiveTime;
+}
+
+gboolean host_isSpilled(Host* host) {
+    MAGIC_ASSERT(host);
+    return host->isSpilled;
+}
+
+/* pages out the large memory regions of all processes on this host, and returns
+ * the number of bytes we advised the kernel to page out. must not run while the
+ * host is executing. */
+gsize host_spillMemory(Host* host) {
+    MAGIC_ASSERT(host);
+
+    gsize numBytesSpilled = 0;
+    for(GList* item = g_queue_peek_head_link(host->processes); item != NULL; item = g_list_next(item)) {
+        numBytesSpilled += process_spillMemory(item->data);
+    }
+
+    host->isSpilled = TRUE;
+    return numBytesSpilled;
+}
+
+/* returns the execution cycles charged to this host so far */
+guint64 host_getExecutionCycles(Host* host) {
+    MAGIC_ASSERT(host);
+    return host->execution.cycles;
 }
 
 /* returns the fractional number of seconds that have been spent executing this host */
 gdouble host_getElapsedExecutionTime(Host* host) {
     MAGIC_ASSERT(host);
-    return g_timer_elapsed(host->executionTimer, NULL);
+    return utility_cyclesToSeconds(host->execution.cycles);
 }
 
 GQuark host_getID(Host* host) {
@@ -387,6 +457,7 @@ void host_boot(Host* host) {
 
     /* scheduling the starting and stopping of our virtual processes */
     g_queue_foreach(host->processes, (GFunc)process_schedule, NULL);
+    g_queue_foreach(host->trafficModels, (GFunc)trafficmodel_schedule, NULL);
 }
 
 guint host_getNewProcessID(Host* host) {
@@ -413,6 +484,13 @@ void host_addApplication(Host* host, SimulationTime startTime, SimulationTime st
     g_queue_push_tail(host->processes, proc);
 }
 
+void host_addTrafficModel(Host* host, TrafficModelParameters* params) {
+    MAGIC_ASSERT(host);
+    guint modelID = host_getNewProcessID(host);
+    TrafficModel* model = trafficmodel_new(modelID, params);
+    g_queue_push_tail(host->trafficModels, model);
+}
+
 void host_freeAllApplications(Host* host) {
     MAGIC_ASSERT(host);
     debug("start freeing applications for host '%s'", host->params.hostname);
@@ -421,6 +499,11 @@ void host_freeAllApplications(Host* host) {
         process_stop(proc);
         process_unref(proc);
     }
+    while(!g_queue_is_empty(host->trafficModels)) {
+        TrafficModel* model = g_queue_pop_head(host->trafficModels);
+        trafficmodel_stop(model);
+        trafficmodel_unref(model);
+    }
     debug("done freeing application for host '%s'", host->params.hostname);
 
     debug("start clearing epoll descriptors for host '%s'", host->params.hostname);
@@ -582,16 +665,13 @@ static void _host_unmonitorDescriptor(Host* host, gint handle) {
     }
 }
 
-static gint _host_compareDescriptors(gconstpointer a, gconstpointer b, gpointer userData) {
-  gint aint = GPOINTER_TO_INT(a);
-  gint bint = GPOINTER_TO_INT(b);
-  return aint < bint ? -1 : aint == bint ? 0 : 1;
-}
-
 static gint _host_getNextDescriptorHandle(Host* host) {
     MAGIC_ASSERT(host);
-    if(g_queue_get_length(host->availableDescriptors) > 0) {
-        return GPOINTER_TO_INT(g_queue_pop_head(host->availableDescriptors));
+    GArray* available = host->availableDescriptors;
+    if(available->len > 0) {
+        gint handle = g_array_index(available, gint, available->len - 1);
+        g_array_set_size(available, available->len - 1);
+        return handle;
     }
     return (host->descriptorHandleCounter)++;
 }
@@ -599,7 +679,18 @@ static gint _host_getNextDescriptorHandle(Host* host) {
 static void _host_returnPreviousDescriptorHandle(Host* host, gint handle) {
     MAGIC_ASSERT(host);
     if(handle >= 3) {
-        g_queue_insert_sorted(host->availableDescriptors, GINT_TO_POINTER(handle), _host_compareDescriptors, NULL);
+        /* binary search for the first index holding a smaller handle */
+        GArray* available = host->availableDescriptors;
+        guint low = 0, high = available->len;
+        while(low < high) {
+            guint middle = low + (high - low) / 2;
+            if(g_array_index(available, gint, middle) > handle) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        g_array_insert_val(available, low, handle);
     }
 }
 
@@ -1069,6 +1160,30 @@ static in_port_t _host_getRandomPort(Host* host) {
     return htons(randomHostPort);
 }
 
+/* returns the ports 64*wordIndex to 64*wordIndex+63 in host order that are bound
+ * without a peer on the interface, or on any interface in the case of INADDR_ANY */
+static guint64 _host_getGeneralPortsWord(Host* host, ProtocolType type,
+        in_addr_t interfaceIP, guint wordIndex) {
+    MAGIC_ASSERT(host);
+
+    guint64 boundPorts = 0;
+
+    if(interfaceIP == htonl(INADDR_ANY)) {
+        GHashTableIter iter;
+        gpointer key, value;
+        g_hash_table_iter_init(&iter, host->interfaces);
+
+        while(g_hash_table_iter_next(&iter, &key, &value)) {
+            boundPorts |= networkinterface_getGeneralPortsWord(value, type, wordIndex);
+        }
+    } else {
+        NetworkInterface* interface = host_lookupInterface(host, interfaceIP);
+        boundPorts = networkinterface_getGeneralPortsWord(interface, type, wordIndex);
+    }
+
+    return boundPorts;
+}
+
 static in_port_t _host_getRandomFreePort(Host* host, ProtocolType type,
         in_addr_t interfaceIP, in_addr_t peerIP, in_port_t peerPort) {
     MAGIC_ASSERT(host);
@@ -1091,15 +1206,38 @@ static in_port_t _host_getRandomFreePort(Host* host, ProtocolType type,
 
     /* now if we tried too many times and still don't have a port, fall back
      * to a linear search to make sure we get a free port if we have one.
-     * but start from a random port instead of the min. */
-    in_port_t start = _host_getRandomPort(host);
-    in_port_t next = (start == UINT16_MAX) ? MIN_RANDOM_PORT : start + 1;
-    while(next != start) {
-        /* this will check all interfaces in the case of INADDR_ANY */
-        if(_host_isInterfaceAvailable(host, type, interfaceIP, next, peerIP, peerPort)) {
-            return next;
+     * but start from a random port instead of the min. we search the bitmaps
+     * of ports bound without a peer 64 ports at a time. */
+    guint start = (guint)ntohs(_host_getRandomPort(host));
+    guint next = (start == UINT16_MAX) ? MIN_RANDOM_PORT : start + 1;
+    guint remaining = UINT16_MAX - MIN_RANDOM_PORT;
+
+    while(remaining > 0) {
+        /* don't search past the end of the port range, or past the start once we wrapped */
+        guint segmentEnd = (next > start) ? UINT16_MAX : start - 1;
+        guint span = MIN(MIN(64 - (next % 64), segmentEnd - next + 1), remaining);
+
+        guint64 freePorts = ~_host_getGeneralPortsWord(host, type, interfaceIP, next / 64) >> (next % 64);
+        if(span < 64) {
+            freePorts &= (G_GUINT64_CONSTANT(1) << span) - 1;
+        }
+
+        while(freePorts != 0) {
+            in_port_t port = htons((in_port_t)(next + (guint)__builtin_ctzll(freePorts)));
+
+            /* sockets with a peer can share a port, as long as the peer is different */
+            if((peerIP == 0 && peerPort == 0) ||
+                    _host_isInterfaceAvailable(host, type, interfaceIP, port, peerIP, peerPort)) {
+                return port;
+            }
+            freePorts &= freePorts - 1;
+        }
+
+        remaining -= span;
+        next += span;
+        if(next > UINT16_MAX) {
+            next = MIN_RANDOM_PORT;
         }
-        next = (next == UINT16_MAX) ? MIN_RANDOM_PORT : next + 1;
     }
 
     gchar* peerIPStr = address_ipToNewString(peerIP);
@@ -1655,6 +1793,16 @@ Tracker* host_getTracker(Host* host) {
     return host->tracker;
 }
 
+void host_setSchedulerData(Host* host, gpointer schedulerData) {
+    MAGIC_ASSERT(host);
+    host->schedulerData = schedulerData;
+}
+
+gpointer host_getSchedulerData(Host* host) {
+    MAGIC_ASSERT(host);
+    return host->schedulerData;
+}
+
 LogLevel host_getLogLevel(Host* host) {
     MAGIC_ASSERT(host);
     return host->params.logLevel;
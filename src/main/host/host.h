@@ -21,6 +21,7 @@
 #include "main/host/descriptor/descriptor.h"
 #include "main/host/network_interface.h"
 #include "main/host/tracker.h"
+#include "main/host/traffic_model.h"
 #include "main/routing/address.h"
 #include "main/routing/dns.h"
 #include "main/routing/router.h"
@@ -63,16 +64,21 @@ Host* host_new(HostParameters* params);
 void host_ref(Host* host);
 void host_unref(Host* host);
 
-void host_lock(Host* host);
-void host_unlock(Host* host);
-
 void host_continueExecutionTimer(Host* host);
 void host_stopExecutionTimer(Host* host);
+void host_addExecutionCycles(Host* host, guint64 cycles);
+guint64 host_getExecutionCycles(Host* host);
 gdouble host_getElapsedExecutionTime(Host* host);
 
+void host_markActive(Host* host, SimulationTime now);
+SimulationTime host_getLastActiveTime(Host* host);
+gboolean host_isSpilled(Host* host);
+gsize host_spillMemory(Host* host);
+
 void host_setup(Host* host, DNS* dns, Topology* topology, guint rawCPUFreq, const gchar* hostRootPath);
 void host_boot(Host* host);
 void host_shutdown(Host* host);
+void host_flush(Host* host);
 
 guint host_getNewProcessID(Host* host);
 guint64 host_getNewEventID(Host* host);
@@ -80,6 +86,7 @@ guint64 host_getNewPacketID(Host* host);
 void host_addApplication(Host* host, SimulationTime startTime, SimulationTime stopTime,
         const gchar* pluginName, const gchar* pluginPath, const gchar* pluginSymbol,
         const gchar* preloadName, const gchar* preloadPath, gchar* arguments);
+void host_addTrafficModel(Host* host, TrafficModelParameters* params);
 void host_freeAllApplications(Host* host);
 
 gint host_compare(gconstpointer a, gconstpointer b, gpointer user_data);
@@ -129,6 +136,10 @@ gint host_getPeerName(Host* host, gint handle, const struct sockaddr* address, s
 gint host_getSocketName(Host* host, gint handle, const struct sockaddr* address, socklen_t* len);
 
 Tracker* host_getTracker(Host* host);
+/* the scheduler policy stores per-host state here so it does not need a
+ * table lookup for every event. it is only set while hosts are assigned. */
+void host_setSchedulerData(Host* host, gpointer schedulerData);
+gpointer host_getSchedulerData(Host* host);
 LogLevel host_getLogLevel(Host* host);
 
 const gchar* host_getDataPath(Host* host);
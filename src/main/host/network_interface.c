@@ -7,11 +7,12 @@
 #include <glib.h>
 #include <netinet/in.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
 #include "main/core/support/options.h"
-#include "main/core/work/task.h"
+#include "main/core/support/statistics.h"
+#include "main/core/work/event.h"
 #include "main/core/worker.h"
 #include "main/host/descriptor/descriptor.h"
 #include "main/host/descriptor/socket.h"
@@ -29,6 +30,19 @@
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
 
+/* the number of 64-bit words needed for a bitmap with one bit per port */
+#define NETWORKINTERFACE_PORT_WORDS ((UINT16_MAX + 1) / 64)
+
+/* the key of a socket in the bindings table. listening and unconnected
+ * sockets use a peerAddr and peerPort of 0. */
+typedef struct _NetworkInterfaceAssociation NetworkInterfaceAssociation;
+struct _NetworkInterfaceAssociation {
+    ProtocolType type;
+    in_port_t port;
+    in_addr_t peerAddr;
+    in_port_t peerPort;
+};
+
 typedef struct _NetworkInterfaceTokenBucket NetworkInterfaceTokenBucket;
 struct _NetworkInterfaceTokenBucket {
     /* The maximum number of bytes the bucket can hold */
@@ -39,6 +53,31 @@ struct _NetworkInterfaceTokenBucket {
     guint64 bytesRefill;
 };
 
+/* a packet in a receive batch, linked to the next packet for the same socket */
+typedef struct _NetworkInterfaceBatchedPacket NetworkInterfaceBatchedPacket;
+struct _NetworkInterfaceBatchedPacket {
+    Packet* packet;
+    gint next;
+};
+
+/* the flow of the last packet we looked up a socket for */
+typedef struct _NetworkInterfaceFlow NetworkInterfaceFlow;
+struct _NetworkInterfaceFlow {
+    ProtocolType ptype;
+    in_port_t bindPort;
+    in_addr_t peerIP;
+    in_port_t peerPort;
+    Socket* socket;
+};
+
+/* the packets for one socket in a receive batch, in the order they arrived */
+typedef struct _NetworkInterfaceBatchedSocket NetworkInterfaceBatchedSocket;
+struct _NetworkInterfaceBatchedSocket {
+    Socket* socket;
+    gint first;
+    gint last;
+};
+
 struct _NetworkInterface {
     /* The upstream ISP router connected to this interface.
      * May be NULL for loopback interfaces. */
@@ -51,11 +90,17 @@ struct _NetworkInterface {
     /* The address associated with this interface */
     Address* address;
 
-    /* (protocol,port)-to-socket bindings */
+    /* (protocol,port,peer)-to-socket bindings */
     GHashTable* boundSockets;
-
-    /* Transports wanting to send data out */
-    GQueue* rrQueue;
+    /* for each protocol, a bitmap of the ports in host order that are bound without a peer.
+     * allocated when the first such socket of the protocol is associated. */
+    guint64* generalPorts[PUDP + 1];
+
+    /* Transports wanting to send data out. the round robin queue links the
+     * sockets through their embedded interface links, and a socket is in the
+     * queue when the data of its link is set. */
+    gboolean isLoopback;
+    GQueue rrQueue;
     PriorityQueue* fifoQueue;
 
     /* the outgoing token bucket implements traffic shaping, i.e.,
@@ -76,13 +121,20 @@ struct _NetworkInterface {
     /* To support capturing incoming and outgoing packets */
     PCapWriter* pcap;
 
+    /* reused by every receive batch to group the dequeued packets by socket */
+    struct {
+        GArray* packets;
+        GArray* sockets;
+        /* maps a socket to 1 + its index in sockets */
+        GHashTable* socketIndices;
+        gboolean isDelivering;
+    } receiveBatch;
+
     MAGIC_DECLARE;
 };
 
 /* forward declarations */
 static void _networkinterface_sendPackets(NetworkInterface* interface);
-static void _networkinterface_refillTokenBucketsCB(NetworkInterface* interface,
-                                                   gpointer userData);
 
 static gint _networkinterface_compareSocket(const Socket* sa, const Socket* sb, gpointer userData) {
     Packet* pa = socket_peekNextPacket(sa);
@@ -119,11 +171,8 @@ _networkinterface_consumeTokenBucket(NetworkInterfaceTokenBucket* bucket,
 }
 
 static void _networkinterface_scheduleRefillTask(NetworkInterface* interface,
-                                                 TaskCallbackFunc func,
                                                  SimulationTime delay) {
-    Task* refillTask = task_new(func, interface, NULL, NULL, NULL);
-    worker_scheduleTask(refillTask, delay);
-    task_unref(refillTask);
+    worker_scheduleLocalEvent(event_newInterfaceRefill(interface), delay);
     interface->isRefillPending = TRUE;
 }
 
@@ -139,9 +188,7 @@ static void _networkinterface_scheduleNextRefill(NetworkInterface* interface) {
     SimulationTime relTimeUntilNextRefill = interval - relTimeSincelastRefill;
 
     /* call back when we need the next refill */
-    _networkinterface_scheduleRefillTask(
-        interface, (TaskCallbackFunc)_networkinterface_refillTokenBucketsCB,
-        relTimeUntilNextRefill);
+    _networkinterface_scheduleRefillTask(interface, relTimeUntilNextRefill);
 }
 
 static gboolean _networkinterface_isRefillNeeded(NetworkInterface* interface) {
@@ -160,8 +207,7 @@ _networkinterface_scheduleNextRefillIfNeeded(NetworkInterface* interface) {
     }
 }
 
-static void _networkinterface_refillTokenBucketsCB(NetworkInterface* interface,
-                                                   gpointer userData) {
+void networkinterface_refillTokenBuckets(NetworkInterface* interface) {
     MAGIC_ASSERT(interface);
 
     /* We no longer have an outstanding event in the event queue. */
@@ -186,7 +232,7 @@ void networkinterface_startRefillingTokenBuckets(NetworkInterface* interface) {
     MAGIC_ASSERT(interface);
 
     interface->timeStartedRefillingBuckets = worker_getCurrentTime();
-    _networkinterface_refillTokenBucketsCB(interface, NULL);
+    networkinterface_refillTokenBuckets(interface);
 }
 
 static void _networkinterface_setupTokenBuckets(NetworkInterface* interface,
@@ -252,21 +298,29 @@ guint32 networkinterface_getSpeedDownKiBps(NetworkInterface* interface) {
     return (guint32)kibPerSecond;
 }
 
-static gchar* _networkinterface_getAssociationKey(NetworkInterface* interface,
-        ProtocolType type, in_port_t port, in_addr_t peerAddr, in_port_t peerPort) {
-    MAGIC_ASSERT(interface);
+static guint _networkinterface_hashAssociation(const NetworkInterfaceAssociation* association) {
+    guint hash = (guint)association->peerAddr;
+    hash = (hash * 31) + (guint)association->peerPort;
+    hash = (hash * 31) + (guint)association->port;
+    return (hash * 31) + (guint)association->type;
+}
 
-    GString* strBuffer = g_string_new(NULL);
-    g_string_printf(strBuffer,
-            "%s|%"G_GUINT32_FORMAT":%"G_GUINT16_FORMAT"|%"G_GUINT32_FORMAT":%"G_GUINT16_FORMAT,
-            protocol_toString(type),
-            (guint)address_toNetworkIP(interface->address),
-            port, peerAddr, peerPort);
+static gboolean _networkinterface_isEqualAssociation(const NetworkInterfaceAssociation* a,
+        const NetworkInterfaceAssociation* b) {
+    return a->type == b->type && a->port == b->port &&
+            a->peerAddr == b->peerAddr && a->peerPort == b->peerPort;
+}
 
-    return g_string_free(strBuffer, FALSE);
+static inline void _networkinterface_setAssociation(NetworkInterfaceAssociation* association,
+        ProtocolType type, in_port_t port, in_addr_t peerAddr, in_port_t peerPort) {
+    association->type = type;
+    association->port = port;
+    association->peerAddr = peerAddr;
+    association->peerPort = peerPort;
 }
 
-static gchar* _networkinterface_socketToAssociationKey(NetworkInterface* interface, Socket* socket) {
+static void _networkinterface_socketToAssociation(NetworkInterface* interface, Socket* socket,
+        NetworkInterfaceAssociation* association) {
     MAGIC_ASSERT(interface);
 
     ProtocolType type = socket_getProtocol(socket);
@@ -279,59 +333,116 @@ static gchar* _networkinterface_socketToAssociationKey(NetworkInterface* interfa
     in_port_t boundPort = 0;
     socket_getSocketName(socket, &boundIP, &boundPort);
 
-    gchar* key = _networkinterface_getAssociationKey(interface, type, boundPort, peerIP, peerPort);
-    return key;
+    _networkinterface_setAssociation(association, type, boundPort, peerIP, peerPort);
+}
+
+static inline gboolean _networkinterface_isGeneralPortBound(NetworkInterface* interface,
+        ProtocolType type, in_port_t port) {
+    guint64* bitmap = (type <= PUDP) ? interface->generalPorts[type] : NULL;
+    if(bitmap == NULL) {
+        return FALSE;
+    }
+    guint hostPort = (guint)ntohs(port);
+    return (bitmap[hostPort / 64] & (G_GUINT64_CONSTANT(1) << (hostPort % 64))) ? TRUE : FALSE;
+}
+
+static void _networkinterface_setGeneralPortBound(NetworkInterface* interface,
+        ProtocolType type, in_port_t port, gboolean isBound) {
+    utility_assert(type <= PUDP);
+
+    if(interface->generalPorts[type] == NULL) {
+        if(!isBound) {
+            return;
+        }
+        interface->generalPorts[type] = g_new0(guint64, NETWORKINTERFACE_PORT_WORDS);
+    }
+
+    guint hostPort = (guint)ntohs(port);
+    guint64 bit = G_GUINT64_CONSTANT(1) << (hostPort % 64);
+    if(isBound) {
+        interface->generalPorts[type][hostPort / 64] |= bit;
+    } else {
+        interface->generalPorts[type][hostPort / 64] &= ~bit;
+    }
+}
+
+/* returns the bits for ports 64*wordIndex to 64*wordIndex+63 in host order,
+ * where a set bit means a socket is bound to the port without a peer */
+guint64 networkinterface_getGeneralPortsWord(NetworkInterface* interface, ProtocolType type, guint wordIndex) {
+    MAGIC_ASSERT(interface);
+    utility_assert(wordIndex < NETWORKINTERFACE_PORT_WORDS);
+
+    guint64* bitmap = (type <= PUDP) ? interface->generalPorts[type] : NULL;
+    return (bitmap != NULL) ? bitmap[wordIndex] : 0;
 }
 
 gboolean networkinterface_isAssociated(NetworkInterface* interface, ProtocolType type,
         in_port_t port, in_addr_t peerAddr, in_port_t peerPort) {
     MAGIC_ASSERT(interface);
 
-    gboolean isFound = FALSE;
-
-    /* we need to check the general key too (ie the ones listening sockets use) */
-    gchar* general = _networkinterface_getAssociationKey(interface, type, port, 0, 0);
-    if(g_hash_table_lookup(interface->boundSockets, general)) {
-        isFound = TRUE;
+    /* we need to check the general association too (ie the ones listening sockets use) */
+    if(_networkinterface_isGeneralPortBound(interface, type, port)) {
+        return TRUE;
     }
-    g_free(general);
 
-    if(!isFound) {
-        gchar* specific = _networkinterface_getAssociationKey(interface, type, port, peerAddr, peerPort);
-        if(g_hash_table_lookup(interface->boundSockets, specific)) {
-            isFound = TRUE;
-        }
-        g_free(specific);
+    if(peerAddr == 0 && peerPort == 0) {
+        /* the specific association is the general one */
+        return FALSE;
     }
 
-    return isFound;
+    NetworkInterfaceAssociation specific;
+    _networkinterface_setAssociation(&specific, type, port, peerAddr, peerPort);
+    return g_hash_table_contains(interface->boundSockets, &specific);
+}
+
+/* returns the socket that is associated with exactly this peer, ignoring
+ * listening sockets, or NULL if there is none */
+Socket* networkinterface_lookupConnectedSocket(NetworkInterface* interface, ProtocolType type,
+        in_port_t port, in_addr_t peerAddr, in_port_t peerPort) {
+    MAGIC_ASSERT(interface);
+
+    NetworkInterfaceAssociation specific;
+    _networkinterface_setAssociation(&specific, type, port, peerAddr, peerPort);
+    return g_hash_table_lookup(interface->boundSockets, &specific);
 }
 
 void networkinterface_associate(NetworkInterface* interface, Socket* socket) {
     MAGIC_ASSERT(interface);
 
-    gchar* key = _networkinterface_socketToAssociationKey(interface, socket);
+    NetworkInterfaceAssociation* association = g_new(NetworkInterfaceAssociation, 1);
+    _networkinterface_socketToAssociation(interface, socket, association);
 
     /* make sure there is no collision */
-    utility_assert(!g_hash_table_contains(interface->boundSockets, key));
+    utility_assert(!g_hash_table_contains(interface->boundSockets, association));
+
+    if(association->peerAddr == 0 && association->peerPort == 0) {
+        _networkinterface_setGeneralPortBound(interface, association->type, association->port, TRUE);
+    }
+
+    debug("associated socket key %s|%"G_GUINT16_FORMAT"|%"G_GUINT32_FORMAT":%"G_GUINT16_FORMAT,
+            protocol_toString(association->type), association->port,
+            association->peerAddr, association->peerPort);
 
     /* insert to our storage, key is now owned by table */
-    g_hash_table_replace(interface->boundSockets, key, socket);
+    g_hash_table_replace(interface->boundSockets, association, socket);
     descriptor_ref(socket);
-
-    debug("associated socket key %s", key);
 }
 
 void networkinterface_disassociate(NetworkInterface* interface, Socket* socket) {
     MAGIC_ASSERT(interface);
 
-    gchar* key = _networkinterface_socketToAssociationKey(interface, socket);
+    NetworkInterfaceAssociation association;
+    _networkinterface_socketToAssociation(interface, socket, &association);
 
     /* we will no longer receive packets for this port, this unrefs descriptor */
-    g_hash_table_remove(interface->boundSockets, key);
+    if(g_hash_table_remove(interface->boundSockets, &association) &&
+            association.peerAddr == 0 && association.peerPort == 0) {
+        _networkinterface_setGeneralPortBound(interface, association.type, association.port, FALSE);
+    }
 
-    debug("disassociated socket key %s", key);
-    g_free(key);
+    debug("disassociated socket key %s|%"G_GUINT16_FORMAT"|%"G_GUINT32_FORMAT":%"G_GUINT16_FORMAT,
+            protocol_toString(association.type), association.port,
+            association.peerAddr, association.peerPort);
 }
 
 static void _networkinterface_capturePacket(NetworkInterface* interface, Packet* packet) {
@@ -372,52 +483,168 @@ static void _networkinterface_capturePacket(NetworkInterface* interface, Packet*
     g_free(pcapPacket);
 }
 
-static void _networkinterface_receivePacket(NetworkInterface* interface, Packet* packet) {
+static Socket* _networkinterface_lookupReceiveSocket(NetworkInterface* interface, Packet* packet) {
     MAGIC_ASSERT(interface);
 
-    /* get the next packet */
-    utility_assert(packet);
-
-    /* successfully received */
-    packet_addDeliveryStatus(packet, PDS_RCV_INTERFACE_RECEIVED);
-
-    /* hand it off to the correct socket layer */
     ProtocolType ptype = packet_getProtocol(packet);
     in_port_t bindPort = packet_getDestinationPort(packet);
 
     /* the first check is for servers who don't associate with specific destinations */
-    gchar* key = _networkinterface_getAssociationKey(interface, ptype, bindPort, 0, 0);
-    debug("looking for socket associated with general key %s", key);
-    Socket* socket = g_hash_table_lookup(interface->boundSockets, key);
-    g_free(key);
+    NetworkInterfaceAssociation association;
+    Socket* socket = NULL;
+    if(_networkinterface_isGeneralPortBound(interface, ptype, bindPort)) {
+        _networkinterface_setAssociation(&association, ptype, bindPort, 0, 0);
+        socket = g_hash_table_lookup(interface->boundSockets, &association);
+    }
 
     if(!socket) {
         /* now check the destination-specific key */
         in_addr_t peerIP = packet_getSourceIP(packet);
         in_port_t peerPort = packet_getSourcePort(packet);
 
-        key = _networkinterface_getAssociationKey(interface, ptype, bindPort, peerIP, peerPort);
-        debug("looking for socket associated with specific key %s", key);
-        socket = g_hash_table_lookup(interface->boundSockets, key);
-        g_free(key);
+        _networkinterface_setAssociation(&association, ptype, bindPort, peerIP, peerPort);
+        socket = g_hash_table_lookup(interface->boundSockets, &association);
     }
 
+    return socket;
+}
+
+/* done in the order the packets arrive, even if we hand them to the sockets later */
+static void _networkinterface_recordInputPacket(NetworkInterface* interface, Socket* socket, Packet* packet) {
+    MAGIC_ASSERT(interface);
+    utility_assert(packet);
+
+    /* count our bandwidth usage by interface, and by socket handle if possible */
+    gint socketHandle = socket ? *descriptor_getHandleReference((Descriptor*)socket) : -1;
+    tracker_addInputBytes(host_getTracker(worker_getActiveHost()), packet, socketHandle);
+    if(interface->pcap) {
+        _networkinterface_capturePacket(interface, packet);
+    }
+}
+
+static void _networkinterface_deliverPacket(NetworkInterface* interface, Socket* socket, Packet* packet) {
+    MAGIC_ASSERT(interface);
+    utility_assert(packet);
+
     /* if the socket closed, just drop the packet */
-    gint socketHandle = -1;
     if(socket) {
-        socketHandle = *descriptor_getHandleReference((Descriptor*)socket);
         socket_pushInPacket(socket, packet);
     } else {
         packet_addDeliveryStatus(packet, PDS_RCV_INTERFACE_DROPPED);
     }
 
-    /* count our bandwidth usage by interface, and by socket handle if possible */
-    tracker_addInputBytes(host_getTracker(worker_getActiveHost()), packet, socketHandle);
-    if(interface->pcap) {
-        _networkinterface_capturePacket(interface, packet);
+    _networkinterface_recordInputPacket(interface, socket, packet);
+}
+
+void networkinterface_receiveLocalPacket(NetworkInterface* interface, Packet* packet) {
+    MAGIC_ASSERT(interface);
+    utility_assert(packet);
+
+    /* successfully received */
+    packet_addDeliveryStatus(packet, PDS_RCV_INTERFACE_RECEIVED);
+
+    /* hand it off to the correct socket layer */
+    Socket* socket = _networkinterface_lookupReceiveSocket(interface, packet);
+    _networkinterface_deliverPacket(interface, socket, packet);
+}
+
+/* appends the packet to the batch of the socket it is for. packets of the same
+ * flow usually arrive back to back, so we remember the last flow we looked up. */
+static void _networkinterface_batchPacket(NetworkInterface* interface, Packet* packet,
+        NetworkInterfaceFlow* lastFlow) {
+    MAGIC_ASSERT(interface);
+
+    /* successfully received */
+    packet_addDeliveryStatus(packet, PDS_RCV_INTERFACE_RECEIVED);
+
+    NetworkInterfaceFlow flow = {
+        packet_getProtocol(packet),
+        packet_getDestinationPort(packet),
+        packet_getSourceIP(packet),
+        packet_getSourcePort(packet),
+        NULL,
+    };
+
+    /* associations do not change while we are batching, so the same flow
+     * always maps to the same socket */
+    Socket* socket = NULL;
+    if(lastFlow->socket && flow.ptype == lastFlow->ptype && flow.bindPort == lastFlow->bindPort &&
+            flow.peerIP == lastFlow->peerIP && flow.peerPort == lastFlow->peerPort) {
+        socket = lastFlow->socket;
+    } else {
+        socket = _networkinterface_lookupReceiveSocket(interface, packet);
+        flow.socket = socket;
+        *lastFlow = flow;
+    }
+
+    if(!socket) {
+        /* nobody to batch for, account for the drop right away */
+        _networkinterface_deliverPacket(interface, NULL, packet);
+        packet_unref(packet);
+        return;
+    }
+
+    /* the socket gets it with the rest of its batch */
+    _networkinterface_recordInputPacket(interface, socket, packet);
+
+    gint packetIndex = (gint)interface->receiveBatch.packets->len;
+    NetworkInterfaceBatchedPacket batched = {packet, -1};
+    g_array_append_val(interface->receiveBatch.packets, batched);
+
+    guint socketIndex = GPOINTER_TO_UINT(g_hash_table_lookup(interface->receiveBatch.socketIndices, socket));
+    if(socketIndex == 0) {
+        /* the first packet for this socket in the batch. keep the socket alive until
+         * we delivered to it, even if processing other packets closes it. */
+        descriptor_ref(socket);
+        descriptor_holdStatusNotifications((Descriptor*)socket);
+
+        NetworkInterfaceBatchedSocket batchedSocket = {socket, packetIndex, packetIndex};
+        g_array_append_val(interface->receiveBatch.sockets, batchedSocket);
+        g_hash_table_insert(interface->receiveBatch.socketIndices, socket,
+                GUINT_TO_POINTER(interface->receiveBatch.sockets->len));
+    } else {
+        NetworkInterfaceBatchedSocket* batchedSocket =
+                &g_array_index(interface->receiveBatch.sockets, NetworkInterfaceBatchedSocket, socketIndex - 1);
+        g_array_index(interface->receiveBatch.packets, NetworkInterfaceBatchedPacket, batchedSocket->last).next = packetIndex;
+        batchedSocket->last = packetIndex;
     }
 }
 
+/* hands every socket its packets in one go, so each socket notifies its
+ * listeners of the resulting status change only once per batch */
+static void _networkinterface_deliverBatch(NetworkInterface* interface) {
+    MAGIC_ASSERT(interface);
+
+    interface->receiveBatch.isDelivering = TRUE;
+
+    for(guint i = 0; i < interface->receiveBatch.sockets->len; i++) {
+        NetworkInterfaceBatchedSocket* batchedSocket =
+                &g_array_index(interface->receiveBatch.sockets, NetworkInterfaceBatchedSocket, i);
+
+        gint packetIndex = batchedSocket->first;
+        while(packetIndex >= 0) {
+            NetworkInterfaceBatchedPacket* batched =
+                    &g_array_index(interface->receiveBatch.packets, NetworkInterfaceBatchedPacket, packetIndex);
+
+            /* we already recorded it when it arrived */
+            socket_pushInPacket(batchedSocket->socket, batched->packet);
+
+            /* release reference from router */
+            packet_unref(batched->packet);
+            packetIndex = batched->next;
+        }
+
+        descriptor_releaseStatusNotifications((Descriptor*)batchedSocket->socket);
+        descriptor_unref(batchedSocket->socket);
+    }
+
+    g_array_set_size(interface->receiveBatch.packets, 0);
+    g_array_set_size(interface->receiveBatch.sockets, 0);
+    g_hash_table_remove_all(interface->receiveBatch.socketIndices);
+
+    interface->receiveBatch.isDelivering = FALSE;
+}
+
 void networkinterface_receivePackets(NetworkInterface* interface) {
     MAGIC_ASSERT(interface);
 
@@ -428,27 +655,47 @@ void networkinterface_receivePackets(NetworkInterface* interface) {
         return;
     }
 
+    /* the batch being delivered will pick up anything new when it is done */
+    if(interface->receiveBatch.isDelivering) {
+        return;
+    }
+
     /* get the bootstrapping mode */
     gboolean bootstrapping = worker_isBootstrapActive();
 
-    while(bootstrapping || interface->receiveBucket.bytesRemaining >= CONFIG_MTU) {
-        /* we are now the owner of the packet reference from the router */
-        Packet* packet = router_dequeue(interface->router);
-        if(!packet) {
-            break;
-        }
+    gboolean dequeuedPackets = TRUE;
+    while(dequeuedPackets) {
+        dequeuedPackets = FALSE;
 
-        guint64 length = (guint64)(packet_getPayloadLength(packet) + packet_getHeaderSize(packet));
+        NetworkInterfaceFlow lastFlow = {0};
+        guint64 budget = interface->receiveBucket.bytesRemaining;
+        guint64 bytesReceived = 0;
 
-        _networkinterface_receivePacket(interface, packet);
+        /* dequeue everything the current token budget allows */
+        while(bootstrapping || budget >= CONFIG_MTU) {
+            /* we are now the owner of the packet reference from the router */
+            Packet* packet = router_dequeue(interface->router);
+            if(!packet) {
+                break;
+            }
+            dequeuedPackets = TRUE;
 
-        /* release reference from router */
-        packet_unref(packet);
+            guint64 length = (guint64)(packet_getPayloadLength(packet) + packet_getHeaderSize(packet));
+            budget = (length >= budget) ? 0 : budget - length;
+            bytesReceived += length;
+
+            _networkinterface_batchPacket(interface, packet, &lastFlow);
+        }
+
+        if(!dequeuedPackets) {
+            break;
+        }
+
+        _networkinterface_deliverBatch(interface);
 
         /* update bandwidth accounting when not in infinite bandwidth mode */
         if(!bootstrapping) {
-            _networkinterface_consumeTokenBucket(&interface->receiveBucket,
-                                                 length);
+            _networkinterface_consumeTokenBucket(&interface->receiveBucket, bytesReceived);
             _networkinterface_scheduleNextRefillIfNeeded(interface);
         }
     }
@@ -462,13 +709,29 @@ static void _networkinterface_updatePacketHeader(Descriptor* descriptor, Packet*
     }
 }
 
+static void _networkinterface_pushRoundRobin(NetworkInterface* interface, Socket* socket) {
+    GList* link = socket_getInterfaceLink(socket, interface->isLoopback);
+    link->data = socket;
+    g_queue_push_tail_link(&(interface->rrQueue), link);
+}
+
+static Socket* _networkinterface_popRoundRobin(NetworkInterface* interface) {
+    GList* link = g_queue_pop_head_link(&(interface->rrQueue));
+    if(!link) {
+        return NULL;
+    }
+    Socket* socket = link->data;
+    link->data = NULL;
+    return socket;
+}
+
 /* round robin queuing discipline ($ man tc)*/
 static Packet* _networkinterface_selectRoundRobin(NetworkInterface* interface, gint* socketHandle) {
     Packet* packet = NULL;
 
-    while(!packet && !g_queue_is_empty(interface->rrQueue)) {
+    while(!packet && !g_queue_is_empty(&(interface->rrQueue))) {
         /* do round robin to get the next packet from the next socket */
-        Socket* socket = g_queue_pop_head(interface->rrQueue);
+        Socket* socket = _networkinterface_popRoundRobin(interface);
         packet = socket_pullOutPacket(socket);
         *socketHandle = *descriptor_getHandleReference((Descriptor*)socket);
 
@@ -478,7 +741,7 @@ static Packet* _networkinterface_selectRoundRobin(NetworkInterface* interface, g
 
         if(socket_peekNextPacket(socket)) {
             /* socket has more packets, and is still reffed from before */
-            g_queue_push_tail(interface->rrQueue, socket);
+            _networkinterface_pushRoundRobin(interface, socket);
         } else {
             /* socket has no more packets, unref it from the sendable queue */
             descriptor_unref((Descriptor*) socket);
@@ -549,10 +812,7 @@ static void _networkinterface_sendPackets(NetworkInterface* interface) {
             /* packet will arrive on our own interface, so it doesn't need to
              * go through the upstream router and does not consume bandwidth. */
             packet_ref(packet);
-            Task* packetTask = task_new((TaskCallbackFunc)_networkinterface_receivePacket,
-                    interface, packet, NULL, (TaskArgumentFreeFunc)packet_unref);
-            worker_scheduleTask(packetTask, 1);
-            task_unref(packetTask);
+            worker_scheduleLocalEvent(event_newLocalPacket(interface, packet), 1);
         } else {
             /* let the upstream router send to remote with appropriate delays.
              * if we get here we are not loopback and should have been assigned a router. */
@@ -584,9 +844,10 @@ void networkinterface_wantsSend(NetworkInterface* interface, Socket* socket) {
     /* track the new socket for sending if not already tracking */
     switch(interface->qdisc) {
         case QDISC_MODE_RR: {
-            if(!g_queue_find(interface->rrQueue, socket)) {
+            /* the link data is only set while the socket is queued */
+            if(!socket_getInterfaceLink(socket, interface->isLoopback)->data) {
                 descriptor_ref(socket);
-                g_queue_push_tail(interface->rrQueue, socket);
+                _networkinterface_pushRoundRobin(interface, socket);
             }
             break;
         }
@@ -629,10 +890,17 @@ NetworkInterface* networkinterface_new(Address* address, guint64 bwDownKiBps, gu
     address_ref(interface->address);
 
     /* incoming packets get passed along to sockets */
-    interface->boundSockets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, descriptor_unref);
+    interface->boundSockets = g_hash_table_new_full((GHashFunc)_networkinterface_hashAssociation,
+            (GEqualFunc)_networkinterface_isEqualAssociation, g_free, descriptor_unref);
+
+    /* incoming packets are grouped by socket before we pass them along */
+    interface->receiveBatch.packets = g_array_new(FALSE, FALSE, sizeof(NetworkInterfaceBatchedPacket));
+    interface->receiveBatch.sockets = g_array_new(FALSE, FALSE, sizeof(NetworkInterfaceBatchedSocket));
+    interface->receiveBatch.socketIndices = g_hash_table_new(g_direct_hash, g_direct_equal);
 
     /* sockets tell us when they want to start sending */
-    interface->rrQueue = g_queue_new();
+    interface->isLoopback = address_isLocal(address);
+    g_queue_init(&(interface->rrQueue));
     interface->fifoQueue = priorityqueue_new((GCompareDataFunc)_networkinterface_compareSocket, NULL, descriptor_unref);
 
     /* parse queuing discipline */
@@ -662,15 +930,23 @@ void networkinterface_free(NetworkInterface* interface) {
     MAGIC_ASSERT(interface);
 
     /* unref all sockets wanting to send */
-    while(interface->rrQueue && !g_queue_is_empty(interface->rrQueue)) {
-        Socket* socket = g_queue_pop_head(interface->rrQueue);
+    while(!g_queue_is_empty(&(interface->rrQueue))) {
+        Socket* socket = _networkinterface_popRoundRobin(interface);
         descriptor_unref(socket);
     }
-    g_queue_free(interface->rrQueue);
 
     priorityqueue_free(interface->fifoQueue);
 
     g_hash_table_destroy(interface->boundSockets);
+    for(gint i = 0; i <= PUDP; i++) {
+        if(interface->generalPorts[i]) {
+            g_free(interface->generalPorts[i]);
+        }
+    }
+
+    g_array_free(interface->receiveBatch.packets, TRUE);
+    g_array_free(interface->receiveBatch.sockets, TRUE);
+    g_hash_table_destroy(interface->receiveBatch.socketIndices);
 
     if(interface->router) {
         router_unref(interface->router);
@@ -689,3 +965,10 @@ void networkinterface_free(NetworkInterface* interface) {
     worker_countObject(OBJECT_TYPE_NETIFACE, COUNTER_TYPE_FREE);
 }
 
+void networkinterface_flush(NetworkInterface* interface) {
+    MAGIC_ASSERT(interface);
+    if(interface->pcap) {
+        pcapwriter_flush(interface->pcap);
+    }
+}
+
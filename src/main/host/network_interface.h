@@ -21,6 +21,7 @@ typedef struct _NetworkInterface NetworkInterface;
 NetworkInterface* networkinterface_new(Address* address, guint64 bwDownKiBps, guint64 bwUpKiBps,
         gboolean logPcap, gchar* pcapDir, QDiscMode qdisc, guint64 interfaceReceiveLength);
 void networkinterface_free(NetworkInterface* interface);
+void networkinterface_flush(NetworkInterface* interface);
 
 Address* networkinterface_getAddress(NetworkInterface* interface);
 guint32 networkinterface_getSpeedUpKiBps(NetworkInterface* interface);
@@ -28,6 +29,9 @@ guint32 networkinterface_getSpeedDownKiBps(NetworkInterface* interface);
 
 gboolean networkinterface_isAssociated(NetworkInterface* interface, ProtocolType type,
         in_port_t port, in_addr_t peerAddr, in_port_t peerPort);
+guint64 networkinterface_getGeneralPortsWord(NetworkInterface* interface, ProtocolType type, guint wordIndex);
+Socket* networkinterface_lookupConnectedSocket(NetworkInterface* interface, ProtocolType type,
+        in_port_t port, in_addr_t peerAddr, in_port_t peerPort);
 void networkinterface_associate(NetworkInterface* interface, Socket* transport);
 void networkinterface_disassociate(NetworkInterface* interface, Socket* transport);
 
@@ -35,10 +39,12 @@ void networkinterface_wantsSend(NetworkInterface* interface, Socket* transport);
 void networkinterface_sent(NetworkInterface* interface);
 
 void networkinterface_startRefillingTokenBuckets(NetworkInterface* interface);
+void networkinterface_refillTokenBuckets(NetworkInterface* interface);
 
 void networkinterface_setRouter(NetworkInterface* interface, Router* router);
 Router* networkinterface_getRouter(NetworkInterface* interface);
 
 void networkinterface_receivePackets(NetworkInterface* interface);
+void networkinterface_receiveLocalPacket(NetworkInterface* interface, Packet* packet);
 
 #endif /* SHD_NETWORK_INTERFACE_H_ */
@@ -28,6 +28,7 @@
 #include <signal.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -54,7 +55,8 @@
 #include "external/rpth/rpth.h"
 #include "glib/gprintf.h"
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/options.h"
+#include "main/core/support/statistics.h"
 #include "main/core/work/task.h"
 #include "main/core/worker.h"
 #include "main/host/cpu.h"
@@ -65,6 +67,7 @@
 #include "main/host/descriptor/timer.h"
 #include "main/host/host.h"
 #include "main/host/process.h"
+#include "main/host/syscall_profile.h"
 #include "main/host/tracker.h"
 #include "main/routing/address.h"
 #include "main/routing/dns.h"
@@ -92,6 +95,9 @@
 
 #define PROC_PTH_STACK_SIZE 128*1024
 
+/* plug-in allocations at least this large may be paged out while the host is idle */
+#define PROC_SPILL_MIN_REGION_SIZE 64*1024
+
 /**
  * We call this function to run the plugin executable. This is the default
  * symbol name when one isn't specified in the plugin configuration element.
@@ -157,6 +163,10 @@ enum _SystemCallType {
     SCT_BIND, SCT_CONNECT, SCT_GETSOCKNAME, SCT_GETPEERNAME,
 };
 
+/* set once a process profiles its emulated calls. the preload library checks it
+ * so that it does not call process_beginEmuCall() when profiling is disabled. */
+gboolean process_isProfilingEmuCalls = FALSE;
+
 struct _Process {
     /* the parent virtual host that this process is running on */
     Host* host;
@@ -256,6 +266,13 @@ struct _Process {
     /* to avoid glib recursive log errors */
     GQueue* cachedWarningMessages;
 
+    /* large plug-in memory regions that we may page out while the host is idle,
+     * maps region start to length. NULL unless a memory budget is configured. */
+    GHashTable* spillableRegions;
+
+    /* counts of the emulated calls the process makes, NULL unless profiling */
+    SyscallProfile* syscallProfile;
+
     gint referenceCount;
     MAGIC_DECLARE;
 };
@@ -278,6 +295,9 @@ static ProcessContext _process_changeContext(Process* proc, ProcessContext from,
         prevContext = proc->activeContext;
         proc->activeContext = to;
     }
+    if(proc->syscallProfile) {
+        syscallprofile_countContextSwitch(proc->syscallProfile);
+    }
     return prevContext;
 }
 
@@ -563,6 +583,111 @@ static void _process_loadPlugin(Process* proc) {
     }
 }
 
+static void _process_addSpillableRegion(Process* proc, gpointer start, gsize length) {
+    if(proc->spillableRegions && length >= PROC_SPILL_MIN_REGION_SIZE) {
+        g_hash_table_replace(proc->spillableRegions, start, GSIZE_TO_POINTER(length));
+    }
+}
+
+static void _process_addSpillableThreadStack(Process* proc, pth_t thread) {
+    if(!proc->spillableRegions || !thread) {
+        return;
+    }
+
+    /* pth allocated the stack, but we can still advise the kernel about it */
+    char* stackAddress = NULL;
+    unsigned int stackSize = 0;
+    pth_attr_t attr = pth_attr_of(thread);
+    gboolean found = pth_attr_get(attr, PTH_ATTR_STACK_ADDR, &stackAddress) &&
+            pth_attr_get(attr, PTH_ATTR_STACK_SIZE, &stackSize);
+    pth_attr_destroy(attr);
+
+    if(found && stackAddress) {
+        ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+        _process_addSpillableRegion(proc, stackAddress, (gsize)stackSize);
+        _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    }
+}
+
+static void _process_removeSpillableThreadStack(Process* proc, pth_t thread) {
+    if(!proc->spillableRegions || !thread) {
+        return;
+    }
+
+    /* pth frees the stack once the thread is gone, after which it may be reused */
+    char* stackAddress = NULL;
+    pth_attr_t attr = pth_attr_of(thread);
+    gboolean found = pth_attr_get(attr, PTH_ATTR_STACK_ADDR, &stackAddress);
+    pth_attr_destroy(attr);
+
+    if(found && stackAddress) {
+        ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+        g_hash_table_remove(proc->spillableRegions, stackAddress);
+        _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    }
+}
+
+typedef struct _ProcessSpillRange ProcessSpillRange;
+struct _ProcessSpillRange {
+    uintptr_t start;
+    uintptr_t end;
+};
+
+static gboolean _process_isRegionInRange(gpointer start, gpointer length, ProcessSpillRange* range) {
+    uintptr_t regionStart = (uintptr_t)start;
+    uintptr_t regionEnd = regionStart + GPOINTER_TO_SIZE(length);
+    return regionStart < range->end && range->start < regionEnd;
+}
+
+/* forgets all regions that overlap the range, since it is no longer ours */
+static void _process_removeSpillableRange(Process* proc, gpointer start, gsize length) {
+    if(proc->spillableRegions) {
+        ProcessSpillRange range = {.start = (uintptr_t)start, .end = (uintptr_t)start + length};
+        g_hash_table_foreach_remove(proc->spillableRegions, (GHRFunc)_process_isRegionInRange, &range);
+    }
+}
+
+static void _process_addAllocatedBytes(Process* proc, gpointer ptr, gsize size) {
+    tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+    _process_addSpillableRegion(proc, ptr, size);
+}
+
+static void _process_removeAllocatedBytes(Process* proc, gpointer ptr) {
+    tracker_removeAllocatedBytes(host_getTracker(proc->host), ptr);
+    if(proc->spillableRegions) {
+        g_hash_table_remove(proc->spillableRegions, ptr);
+    }
+}
+
+static void _process_spillRegion(gpointer start, gpointer length, gsize* numBytesSpilled) {
+    /* we may only advise on whole pages inside the region */
+    gsize pageSize = (gsize)sysconf(_SC_PAGESIZE);
+    uintptr_t first = ((uintptr_t)start + pageSize - 1) & ~((uintptr_t)pageSize - 1);
+    uintptr_t last = ((uintptr_t)start + GPOINTER_TO_SIZE(length)) & ~((uintptr_t)pageSize - 1);
+    if(last <= first) {
+        return;
+    }
+
+#ifdef MADV_PAGEOUT
+    /* the advice never discards contents, and pages come back on the next access.
+     * regions are forgotten when they are freed or unmapped, so we only advise on
+     * memory that still belongs to this process. */
+    if(madvise((gpointer)first, (gsize)(last - first), MADV_PAGEOUT) == 0) {
+        *numBytesSpilled += (gsize)(last - first);
+    }
+#endif
+}
+
+gsize process_spillMemory(Process* proc) {
+    MAGIC_ASSERT(proc);
+
+    gsize numBytesSpilled = 0;
+    if(proc->spillableRegions) {
+        g_hash_table_foreach(proc->spillableRegions, (GHFunc)_process_spillRegion, &numBytesSpilled);
+    }
+    return numBytesSpilled;
+}
+
 Process* process_new(gpointer host, guint processID,
         SimulationTime startTime, SimulationTime stopTime, const gchar* pluginName,
         const gchar* pluginPath, const gchar* pluginSymbol, const gchar* preloadName,
@@ -605,6 +730,17 @@ Process* process_new(gpointer host, guint processID,
 
     proc->programAuxThreads = g_hash_table_new(g_direct_hash, g_direct_equal);
 
+#ifdef MADV_PAGEOUT
+    /* without MADV_PAGEOUT there is no way to spill, and the slave ignores the budget */
+    if(options_getMemoryBudget(worker_getOptions()) > 0) {
+        proc->spillableRegions = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+#endif
+    if(options_doProfileSyscalls(worker_getOptions())) {
+        proc->syscallProfile = syscallprofile_new();
+        process_isProfilingEmuCalls = TRUE;
+    }
+
     worker_countObject(OBJECT_TYPE_PROCESS, COUNTER_TYPE_NEW);
 
     return proc;
@@ -620,6 +756,25 @@ static void _process_logCachedWarnings(Process* proc) {
     }
 }
 
+static void _process_writeSyscallProfile(Process* proc) {
+    const gchar* hostDataPath = host_getDataPath(proc->host);
+    gchar* fileName = g_strdup_printf("syscalls-%s.csv", _process_getName(proc));
+    gchar* pathStr = g_build_filename(hostDataPath, fileName, NULL);
+
+    FILE* f = g_fopen(pathStr, "w");
+    if(f) {
+        syscallprofile_write(proc->syscallProfile, f);
+        fclose(f);
+        info("wrote the syscall profile of process '%s' to '%s'", _process_getName(proc), pathStr);
+    } else {
+        warning("process '%s': unable to open file '%s', error was: %s",
+                _process_getName(proc), pathStr, g_strerror(errno));
+    }
+
+    g_free(pathStr);
+    g_free(fileName);
+}
+
 static void _process_free(Process* proc) {
     MAGIC_ASSERT(proc);
 
@@ -649,6 +804,13 @@ static void _process_free(Process* proc) {
         _process_logCachedWarnings(proc);
         g_queue_free(proc->cachedWarningMessages);
     }
+    if(proc->spillableRegions) {
+        g_hash_table_destroy(proc->spillableRegions);
+    }
+    if(proc->syscallProfile) {
+        _process_writeSyscallProfile(proc);
+        syscallprofile_free(proc->syscallProfile);
+    }
     if(proc->plugin.path) {
         g_string_free(proc->plugin.path, TRUE);
     }
@@ -854,6 +1016,7 @@ static void* _process_executeChild(ProcessChildData* data) {
 
     /* when we return, pth will call the exit functions queued for the main thread */
     _process_changeContext(proc, PCTX_SHADOW, PCTX_PTH);
+    _process_removeSpillableThreadStack(proc, pth_self());
 
     /* unref for the data object */
     process_unref(proc);
@@ -886,6 +1049,7 @@ static void _process_executeCleanup(Process* proc) {
     while(g_hash_table_iter_next(&iter, &key, &value)) {
         pth_t auxThread = key;
         if(auxThread) {
+            _process_removeSpillableThreadStack(proc, auxThread);
             _process_changeContext(proc, PCTX_SHADOW, PCTX_PTH);
             gint success = pth_abort(auxThread);
             _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
@@ -938,6 +1102,7 @@ static void _process_executeCleanup(Process* proc) {
     }
 
     /* the main thread is done and will be joined by pth */
+    _process_removeSpillableThreadStack(proc, proc->programMainThread);
     proc->programMainThread = NULL;
 
     /* unref for the main func */
@@ -1109,6 +1274,7 @@ static void _process_start(Process* proc) {
     pth_attr_set(programMainThreadAttr, PTH_ATTR_STACK_SIZE, PROC_PTH_STACK_SIZE);
     proc->programMainThread = pth_spawn(programMainThreadAttr, (PthSpawnFunc)_process_executeMain, proc);
     pth_attr_destroy(programMainThreadAttr);
+    _process_addSpillableThreadStack(proc, proc->programMainThread);
 
     /* now that our pth state is set up, load the plugin */
     _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
@@ -1130,6 +1296,9 @@ static void _process_start(Process* proc) {
 
     /* now give the main program thread a chance to run */
     pth_yield(proc->programMainThread);
+    if(proc->syscallProfile) {
+        syscallprofile_countYield(proc->syscallProfile);
+    }
 
     _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
     utility_assert(proc->plugin.isExecuting);
@@ -1153,6 +1322,10 @@ static void _process_start(Process* proc) {
     proc->plugin.isExecuting = FALSE;
     worker_setActiveProcess(NULL);
 
+    if(proc->syscallProfile) {
+        syscallprofile_suspend(proc->syscallProfile);
+    }
+
     message("process '%s' initialized the pth threading system in %f seconds, "
             "initialized the plugin namespace in %f seconds, "
             "and ran the pth main thread until it blocked in %f seconds",
@@ -1204,6 +1377,10 @@ void process_continue(Process* proc) {
 
     info("switching to rpth to continue the threads of process '%s'", _process_getName(proc));
 
+    if(proc->syscallProfile) {
+        syscallprofile_resume(proc->syscallProfile);
+    }
+
     /* there is some i/o or event available, let pth handle it
      * we will execute in the pth/plugin context, so we need to load the state */
     worker_setActiveProcess(proc);
@@ -1226,6 +1403,9 @@ void process_continue(Process* proc) {
     /* make sure pth scheduler updates, and process all program threads until they block */
     do {
         pth_yield(NULL);
+        if(proc->syscallProfile) {
+            syscallprofile_countYield(proc->syscallProfile);
+        }
     } while(pth_ctrl(PTH_CTRL_GETTHREADS_READY | PTH_CTRL_GETTHREADS_NEW));
 
     _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
@@ -1256,6 +1436,10 @@ void process_continue(Process* proc) {
     proc->plugin.isExecuting = FALSE;
     worker_setActiveProcess(NULL);
 
+    if(proc->syscallProfile) {
+        syscallprofile_suspend(proc->syscallProfile);
+    }
+
     if(proc->cachedWarningMessages) {
         _process_logCachedWarnings(proc);
     }
@@ -1311,6 +1495,11 @@ void process_stop(Process* proc) {
     pth_gctx_free(proc->tstate);
     proc->tstate = NULL;
 
+    /* the thread stacks are gone, and nothing of a stopped process is worth spilling */
+    if(proc->spillableRegions) {
+        g_hash_table_remove_all(proc->spillableRegions);
+    }
+
     /* revert pth global context */
     pth_gctx_set(prevPthGlobalContext);
 
@@ -1378,6 +1567,33 @@ gboolean process_shouldEmulate(Process* proc) {
     return ((!proc) || (proc->activeContext == PCTX_SHADOW)) ? FALSE : TRUE;
 }
 
+/* called by the preload library before it calls the emulated function, while
+ * still in the plug-in or pth context of the caller */
+ProcessEmuCall process_beginEmuCall(Process* proc, const gchar* functionName) {
+    ProcessEmuCall call;
+    memset(&call, 0, sizeof(ProcessEmuCall));
+
+    if(proc->syscallProfile) {
+        call.proc = proc;
+        call.profileCall = syscallprofile_beginCall(proc->syscallProfile, functionName,
+                proc->activeContext == PCTX_PTH);
+    }
+    return call;
+}
+
+void process_endEmuCall(ProcessEmuCall* call) {
+    Process* proc = call->proc;
+    if(proc) {
+        /* the first call of a function allocates its entry, which must not be
+         * mistaken for a plug-in allocation. we switch without going through
+         * _process_changeContext so that we don't count a context switch. */
+        ProcessContext prevContext = proc->activeContext;
+        proc->activeContext = PCTX_SHADOW;
+        syscallprofile_endCall(&call->profileCall);
+        proc->activeContext = prevContext;
+    }
+}
+
 void process_migrate(Process* proc, gpointer threads) {
     MAGIC_ASSERT(proc);
     struct ProcessMigrateArgs* ts = threads;
@@ -1493,6 +1709,9 @@ static gssize _process_emu_sendHelper(Process* proc, gint fd, gconstpointer buf,
         _process_setErrno(proc, result);
         return -1;
     }
+    if(proc->syscallProfile) {
+        syscallprofile_addBytes(proc->syscallProfile, bytes);
+    }
     return (gssize) bytes;
 }
 
@@ -1518,6 +1737,9 @@ static gssize _process_emu_recvHelper(Process* proc, gint fd, gpointer buf, size
         _process_setErrno(proc, result);
         return -1;
     }
+    if(proc->syscallProfile) {
+        syscallprofile_addBytes(proc->syscallProfile, bytes);
+    }
 
     /* check if they wanted to know where we got the data from */
     if(addr != NULL && len != NULL && *len >= sizeof(struct sockaddr_in)) {
@@ -1835,7 +2057,7 @@ void* process_emu_malloc(Process* proc, size_t size) {
 
     void* ptr = malloc(size);
     if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+        _process_addAllocatedBytes(proc, ptr, size);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1850,7 +2072,7 @@ void* process_emu_calloc(Process* proc, size_t nmemb, size_t size) {
 
     void* ptr = calloc(nmemb, size);
     if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+        _process_addAllocatedBytes(proc, ptr, size);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1868,16 +2090,16 @@ void* process_emu_realloc(Process* proc, void *ptr, size_t size) {
         if(ptr == NULL) {
             /* equivalent to malloc */
             if(size) {
-                tracker_addAllocatedBytes(host_getTracker(proc->host), newptr, size);
+                _process_addAllocatedBytes(proc, newptr, size);
             }
         } else if (size == 0) {
             /* equivalent to free */
-            tracker_removeAllocatedBytes(host_getTracker(proc->host), ptr);
+            _process_removeAllocatedBytes(proc, ptr);
         } else {
             /* true realloc */
-            tracker_removeAllocatedBytes(host_getTracker(proc->host), ptr);
+            _process_removeAllocatedBytes(proc, ptr);
             if(size) {
-                tracker_addAllocatedBytes(host_getTracker(proc->host), newptr, size);
+                _process_addAllocatedBytes(proc, newptr, size);
             }
         }
     }
@@ -1894,7 +2116,7 @@ void process_emu_free(Process* proc, void *ptr) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     free(ptr);
     if(ptr != NULL) {
-        tracker_removeAllocatedBytes(host_getTracker(proc->host), ptr);
+        _process_removeAllocatedBytes(proc, ptr);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
 }
@@ -1903,7 +2125,7 @@ int process_emu_posix_memalign(Process* proc, void** memptr, size_t alignment, s
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     gint ret = posix_memalign(memptr, alignment, size);
     if(ret == 0 && size) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), *memptr, size);
+        _process_addAllocatedBytes(proc, *memptr, size);
     }
     _process_changeContext(proc, PCTX_SHADOW, prevCTX);
     return ret;
@@ -1913,7 +2135,7 @@ void* process_emu_memalign(Process* proc, size_t blocksize, size_t bytes) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     gpointer ptr = memalign(blocksize, bytes);
     if(bytes && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, bytes);
+        _process_addAllocatedBytes(proc, ptr, bytes);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1927,7 +2149,7 @@ void* process_emu_aligned_alloc(Process* proc, size_t alignment, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     gpointer ptr = aligned_alloc(alignment, size);
     if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+        _process_addAllocatedBytes(proc, ptr, size);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1940,7 +2162,7 @@ void* process_emu_valloc(Process* proc, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     gpointer ptr = valloc(size);
     if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+        _process_addAllocatedBytes(proc, ptr, size);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1953,7 +2175,7 @@ void* process_emu_pvalloc(Process* proc, size_t size) {
     ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
     gpointer ptr = pvalloc(size);
     if(size && ptr != NULL) {
-        tracker_addAllocatedBytes(host_getTracker(proc->host), ptr, size);
+        _process_addAllocatedBytes(proc, ptr, size);
     }
     if(ptr == NULL) {
         _process_setErrno(proc, errno);
@@ -1972,6 +2194,8 @@ void* process_emu_mmap(Process* proc, void *addr, size_t length, int prot, int f
         gpointer ret = mmap(addr, length, prot, flags, -1, offset);
         if(ret == MAP_FAILED) {
             _process_setErrno(proc, errno);
+        } else {
+            _process_addSpillableRegion(proc, ret, length);
         }
         _process_changeContext(proc, PCTX_SHADOW, prevCTX);
         return ret;
@@ -1999,6 +2223,18 @@ void* process_emu_mmap(Process* proc, void *addr, size_t length, int prot, int f
     return MAP_FAILED;
 }
 
+int process_emu_munmap(Process* proc, void *addr, size_t length) {
+    ProcessContext prevCTX = _process_changeContext(proc, proc->activeContext, PCTX_SHADOW);
+    gint result = munmap(addr, length);
+    if(result == 0) {
+        _process_removeSpillableRange(proc, addr, length);
+    } else {
+        _process_setErrno(proc, errno);
+    }
+    _process_changeContext(proc, PCTX_SHADOW, prevCTX);
+    return result;
+}
+
 
 /* event family */
 
@@ -4845,6 +5081,7 @@ static void _process_exitHelper(Process* proc, void *value_ptr) {
         warning("thread '%s' in process '%s' will be terminated by pth", pthThreadName, _process_getName(proc));
         _process_changeContext(proc, PCTX_SHADOW, PCTX_PTH);
 
+        _process_removeSpillableThreadStack(proc, pth_self());
         pth_exit(value_ptr);
 
         _process_changeContext(proc, PCTX_PTH, PCTX_SHADOW);
@@ -5946,6 +6183,7 @@ int process_emu_pthread_create(Process* proc, pthread_t *thread, const pthread_a
                 pth_attr_set(defaultAttr, PTH_ATTR_JOINABLE, TRUE);
 
                 auxThread = pth_spawn(defaultAttr, (PthSpawnFunc) _process_executeChild, data);
+                _process_addSpillableThreadStack(proc, auxThread);
 
                 /* cleanup */
                 pth_attr_destroy(defaultAttr);
@@ -67,6 +67,7 @@ typedef off_t off64_t;
 #include <wchar.h>
 
 #include "main/core/support/definitions.h"
+#include "main/host/syscall_profile.h"
 
 Process* process_new(gpointer host, guint processID,
         SimulationTime startTime, SimulationTime stopTime, const gchar* pluginName,
@@ -78,6 +79,7 @@ void process_unref(Process* proc);
 void process_schedule(Process* proc, gpointer nothing);
 void process_continue(Process* proc);
 void process_stop(Process* proc);
+gsize process_spillMemory(Process* proc);
 
 struct ProcessMigrateArgs {
     pthread_t* t1;
@@ -89,6 +91,16 @@ gboolean process_wantsNotify(Process* proc, gint epollfd);
 gboolean process_isRunning(Process* proc);
 gboolean process_shouldEmulate(Process* proc);
 
+/* profiles a single emulated call when syscall profiling is enabled */
+extern gboolean process_isProfilingEmuCalls;
+typedef struct _ProcessEmuCall ProcessEmuCall;
+struct _ProcessEmuCall {
+    Process* proc;
+    SyscallProfileCall profileCall;
+};
+ProcessEmuCall process_beginEmuCall(Process* proc, const gchar* functionName);
+void process_endEmuCall(ProcessEmuCall* call);
+
 gboolean process_addAtExitCallback(Process* proc, gpointer userCallback, gpointer userArgument,
         gboolean shouldPassArgument);
 
@@ -110,6 +122,7 @@ void* process_emu_aligned_alloc(Process* proc, size_t alignment, size_t size);
 void* process_emu_valloc(Process* proc, size_t size);
 void* process_emu_pvalloc(Process* proc, size_t size);
 void* process_emu_mmap(Process* proc, void *addr, size_t length, int prot, int flags, int fd, off_t offset);
+int process_emu_munmap(Process* proc, void *addr, size_t length);
 
 /* event family */
 
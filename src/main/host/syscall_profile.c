@@ -0,0 +1,200 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#include <glib.h>
+#include <stdio.h>
+
+#include "main/host/syscall_profile.h"
+#include "main/utility/utility.h"
+
+typedef struct _SyscallProfileEntry SyscallProfileEntry;
+struct _SyscallProfileEntry {
+    guint64 nCalls;
+    guint64 cycles;
+    guint64 bytes;
+};
+
+/* what a call that has not ended yet was charged so far */
+typedef struct _SyscallProfileOpenCall SyscallProfileOpenCall;
+struct _SyscallProfileOpenCall {
+    guint64 id;
+    guint64 cycles;
+    guint64 bytes;
+};
+
+struct _SyscallProfile {
+    /* function name to entry, for calls from the plug-in and from pth */
+    GHashTable* pluginCalls;
+    GHashTable* pthCalls;
+
+    /* the calls that began but did not end yet, in the order they began. the last
+     * one is the innermost and gets charged. pth may switch threads while a call
+     * blocks, so the calls do not always end in the reverse order. */
+    GArray* openCalls;
+    guint64 nextCallID;
+    /* when we last charged the innermost call */
+    guint64 chargedUntilCycles;
+    gboolean isSuspended;
+
+    guint64 nContextSwitches;
+    guint64 nYields;
+
+    MAGIC_DECLARE;
+};
+
+SyscallProfile* syscallprofile_new() {
+    SyscallProfile* profile = g_new0(SyscallProfile, 1);
+    MAGIC_INIT(profile);
+
+    profile->pluginCalls = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    profile->pthCalls = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    profile->openCalls = g_array_new(FALSE, FALSE, sizeof(SyscallProfileOpenCall));
+
+    return profile;
+}
+
+void syscallprofile_free(SyscallProfile* profile) {
+    MAGIC_ASSERT(profile);
+
+    g_hash_table_destroy(profile->pluginCalls);
+    g_hash_table_destroy(profile->pthCalls);
+    g_array_free(profile->openCalls, TRUE);
+
+    MAGIC_CLEAR(profile);
+    g_free(profile);
+}
+
+static SyscallProfileOpenCall* _syscallprofile_getInnermostCall(SyscallProfile* profile) {
+    MAGIC_ASSERT(profile);
+    if(profile->openCalls->len == 0) {
+        return NULL;
+    }
+    return &g_array_index(profile->openCalls, SyscallProfileOpenCall, profile->openCalls->len - 1);
+}
+
+/* charges the time since we last charged to the innermost call */
+static void _syscallprofile_charge(SyscallProfile* profile) {
+    MAGIC_ASSERT(profile);
+
+    guint64 nowCycles = utility_getCycleCount();
+    SyscallProfileOpenCall* innermost = _syscallprofile_getInnermostCall(profile);
+    if(innermost && !profile->isSuspended) {
+        innermost->cycles += nowCycles - profile->chargedUntilCycles;
+    }
+    profile->chargedUntilCycles = nowCycles;
+}
+
+SyscallProfileCall syscallprofile_beginCall(SyscallProfile* profile, const gchar* functionName, gboolean isFromPth) {
+    MAGIC_ASSERT(profile);
+
+    /* the enclosing call, if any, stops being charged until we end */
+    _syscallprofile_charge(profile);
+
+    SyscallProfileOpenCall openCall = {++(profile->nextCallID), 0, 0};
+    g_array_append_val(profile->openCalls, openCall);
+
+    SyscallProfileCall call;
+    call.profile = profile;
+    call.functionName = functionName;
+    call.isFromPth = isFromPth;
+    call.id = openCall.id;
+    return call;
+}
+
+void syscallprofile_endCall(SyscallProfileCall* call) {
+    utility_assert(call);
+
+    SyscallProfile* profile = call->profile;
+    MAGIC_ASSERT(profile);
+
+    _syscallprofile_charge(profile);
+
+    /* it is usually the innermost call, so search from the end */
+    guint index = profile->openCalls->len;
+    SyscallProfileOpenCall openCall = {0};
+    while(index > 0) {
+        index--;
+        openCall = g_array_index(profile->openCalls, SyscallProfileOpenCall, index);
+        if(openCall.id == call->id) {
+            break;
+        }
+    }
+    utility_assert(openCall.id == call->id);
+    g_array_remove_index(profile->openCalls, index);
+
+    GHashTable* calls = call->isFromPth ? profile->pthCalls : profile->pluginCalls;
+    SyscallProfileEntry* entry = g_hash_table_lookup(calls, call->functionName);
+    if(!entry) {
+        entry = g_new0(SyscallProfileEntry, 1);
+        g_hash_table_replace(calls, g_strdup(call->functionName), entry);
+    }
+
+    entry->nCalls++;
+    entry->cycles += openCall.cycles;
+    entry->bytes += openCall.bytes;
+}
+
+void syscallprofile_addBytes(SyscallProfile* profile, gsize bytes) {
+    MAGIC_ASSERT(profile);
+    SyscallProfileOpenCall* innermost = _syscallprofile_getInnermostCall(profile);
+    if(innermost) {
+        innermost->bytes += bytes;
+    }
+}
+
+void syscallprofile_countContextSwitch(SyscallProfile* profile) {
+    MAGIC_ASSERT(profile);
+    profile->nContextSwitches++;
+}
+
+void syscallprofile_countYield(SyscallProfile* profile) {
+    MAGIC_ASSERT(profile);
+    profile->nYields++;
+}
+
+void syscallprofile_suspend(SyscallProfile* profile) {
+    MAGIC_ASSERT(profile);
+    if(!profile->isSuspended) {
+        _syscallprofile_charge(profile);
+        profile->isSuspended = TRUE;
+    }
+}
+
+void syscallprofile_resume(SyscallProfile* profile) {
+    MAGIC_ASSERT(profile);
+    if(profile->isSuspended) {
+        /* skips the time we were suspended */
+        _syscallprofile_charge(profile);
+        profile->isSuspended = FALSE;
+    }
+}
+
+static void _syscallprofile_writeCalls(GHashTable* calls, const gchar* caller, FILE* outFile) {
+    /* sort by name so that profiles of different runs are easy to diff */
+    GList* names = g_list_sort(g_hash_table_get_keys(calls), (GCompareFunc)g_strcmp0);
+
+    for(GList* item = names; item != NULL; item = g_list_next(item)) {
+        const gchar* name = item->data;
+        SyscallProfileEntry* entry = g_hash_table_lookup(calls, name);
+        fprintf(outFile, "%s,%s,%"G_GUINT64_FORMAT",%f,%"G_GUINT64_FORMAT"\n",
+                name, caller, entry->nCalls, utility_cyclesToSeconds(entry->cycles), entry->bytes);
+    }
+
+    g_list_free(names);
+}
+
+void syscallprofile_write(SyscallProfile* profile, FILE* outFile) {
+    MAGIC_ASSERT(profile);
+    utility_assert(outFile);
+
+    fprintf(outFile, "function,caller,calls,seconds,bytes\n");
+    _syscallprofile_writeCalls(profile->pluginCalls, "plugin", outFile);
+    _syscallprofile_writeCalls(profile->pthCalls, "pth", outFile);
+
+    /* the context switches and pth scheduler iterations are not calls,
+     * so they only have a count */
+    fprintf(outFile, "context_switch,shadow,%"G_GUINT64_FORMAT",,\n", profile->nContextSwitches);
+    fprintf(outFile, "pth_yield,shadow,%"G_GUINT64_FORMAT",,\n", profile->nYields);
+}
@@ -0,0 +1,56 @@
+/*
+ * The Shadow Simulator
+ * See LICENSE for licensing information
+ */
+
+#ifndef SHD_SYSCALL_PROFILE_H_
+#define SHD_SYSCALL_PROFILE_H_
+
+#include <glib.h>
+#include <stdio.h>
+
+/**
+ * Counts, for a single process, how often each emulated function was called,
+ * how long the simulator spent in it, and how many bytes it moved through
+ * shadow descriptors. Calls are keyed by function name and by whether the
+ * plug-in itself or the pth library made the call, since pth turns blocking
+ * calls from the plug-in into non-blocking calls of the same function.
+ *
+ * Calls that are open at the same time, such as a blocking call of the plug-in
+ * and the calls that pth makes while it waits, are not charged twice. Time and
+ * bytes always go to the innermost call, the one that began most recently.
+ */
+
+typedef struct _SyscallProfile SyscallProfile;
+
+/* the state of one profiled call, kept on the caller's stack between
+ * syscallprofile_beginCall() and syscallprofile_endCall() */
+typedef struct _SyscallProfileCall SyscallProfileCall;
+struct _SyscallProfileCall {
+    SyscallProfile* profile;
+    const gchar* functionName;
+    gboolean isFromPth;
+    /* finds our open call in the profile */
+    guint64 id;
+};
+
+SyscallProfile* syscallprofile_new();
+void syscallprofile_free(SyscallProfile* profile);
+
+SyscallProfileCall syscallprofile_beginCall(SyscallProfile* profile, const gchar* functionName, gboolean isFromPth);
+void syscallprofile_endCall(SyscallProfileCall* call);
+
+/* bytes that a call sent or received through a shadow descriptor */
+void syscallprofile_addBytes(SyscallProfile* profile, gsize bytes);
+void syscallprofile_countContextSwitch(SyscallProfile* profile);
+void syscallprofile_countYield(SyscallProfile* profile);
+
+/* the process stopped and resumed executing. the time in between is not
+ * charged to any call. */
+void syscallprofile_suspend(SyscallProfile* profile);
+void syscallprofile_resume(SyscallProfile* profile);
+
+/* writes the profile as CSV, one row per function and caller */
+void syscallprofile_write(SyscallProfile* profile, FILE* outFile);
+
+#endif /* SHD_SYSCALL_PROFILE_H_ */
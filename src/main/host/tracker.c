@@ -12,7 +12,7 @@
 
 #include "main/core/support/definitions.h"
 #include "main/core/support/options.h"
-#include "main/core/work/task.h"
+#include "main/core/work/event.h"
 #include "main/core/worker.h"
 #include "main/host/protocol.h"
 #include "main/host/tracker.h"
@@ -69,6 +69,10 @@ struct _Tracker {
     IFaceCounters local;
     IFaceCounters remote;
 
+    /* header and payload bytes over the whole simulation, always counted */
+    gsize inputBytesTotal;
+    gsize outputBytesTotal;
+
     GHashTable* allocatedLocations;
     gsize allocatedBytesTotal;
     gsize allocatedBytesLastInterval;
@@ -138,7 +142,7 @@ Tracker* tracker_new(SimulationTime interval, LogLevel loglevel, LogInfoFlags lo
     tracker->socketStats = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, (GDestroyNotify)_socketstats_free);
 
     /* send an alive message, and start periodic heartbeats */
-    tracker_heartbeat(tracker, NULL);
+    tracker_heartbeat(tracker);
 
     return tracker;
 }
@@ -216,13 +220,15 @@ static void _tracker_updateCounters(Counters* c, gsize header, gsize payload,
 void tracker_addInputBytes(Tracker* tracker, Packet* packet, gint handle) {
     MAGIC_ASSERT(tracker);
 
+    gsize header = (gsize)packet_getHeaderSize(packet);
+    gsize payload = (gsize)packet_getPayloadLength(packet);
+    tracker->inputBytesTotal += header + payload;
+
     if(!(tracker->loginfo & LOG_INFO_FLAGS_NODE) && !(tracker->loginfo & LOG_INFO_FLAGS_SOCKET)) {
         return;
     }
 
     gboolean isLocal = packet_getDestinationIP(packet) == htonl(INADDR_LOOPBACK);
-    gsize header = (gsize)packet_getHeaderSize(packet);
-    gsize payload = (gsize)packet_getPayloadLength(packet);
     PacketDeliveryStatusFlags status = packet_getDeliveryStatus(packet);
 
     if(tracker->loginfo & LOG_INFO_FLAGS_NODE) {
@@ -248,13 +254,15 @@ void tracker_addInputBytes(Tracker* tracker, Packet* packet, gint handle) {
 void tracker_addOutputBytes(Tracker* tracker, Packet* packet, gint handle) {
     MAGIC_ASSERT(tracker);
 
+    gsize header = (gsize)packet_getHeaderSize(packet);
+    gsize payload = (gsize)packet_getPayloadLength(packet);
+    tracker->outputBytesTotal += header + payload;
+
     if(!(tracker->loginfo & LOG_INFO_FLAGS_NODE) && !(tracker->loginfo & LOG_INFO_FLAGS_SOCKET)) {
         return;
     }
 
     gboolean isLocal = packet_getSourceIP(packet) == htonl(INADDR_LOOPBACK);
-    gsize header = (gsize)packet_getHeaderSize(packet);
-    gsize payload = (gsize)packet_getPayloadLength(packet);
     PacketDeliveryStatusFlags status = packet_getDeliveryStatus(packet);
 
     if(tracker->loginfo & LOG_INFO_FLAGS_NODE) {
@@ -277,6 +285,21 @@ void tracker_addOutputBytes(Tracker* tracker, Packet* packet, gint handle) {
     }
 }
 
+gsize tracker_getInputBytesTotal(Tracker* tracker) {
+    MAGIC_ASSERT(tracker);
+    return tracker->inputBytesTotal;
+}
+
+gsize tracker_getOutputBytesTotal(Tracker* tracker) {
+    MAGIC_ASSERT(tracker);
+    return tracker->outputBytesTotal;
+}
+
+gsize tracker_getAllocatedBytesTotal(Tracker* tracker) {
+    MAGIC_ASSERT(tracker);
+    return tracker->allocatedBytesTotal;
+}
+
 void tracker_addAllocatedBytes(Tracker* tracker, gpointer location, gsize allocatedBytes) {
     MAGIC_ASSERT(tracker);
 
@@ -563,7 +586,7 @@ static void _tracker_logRAM(Tracker* tracker, LogLevel level, SimulationTime int
         tracker->allocatedBytesTotal, numptrs, tracker->numFailedFrees);
 }
 
-void tracker_heartbeat(Tracker* tracker, gpointer userData) {
+void tracker_heartbeat(Tracker* tracker) {
     MAGIC_ASSERT(tracker);
 
     /* check to see if node info is being logged */
@@ -604,8 +627,5 @@ void tracker_heartbeat(Tracker* tracker, gpointer userData) {
 
     /* schedule the next heartbeat */
     tracker->lastHeartbeat = worker_getCurrentTime();
-    Task* heartbeatTask = task_new((TaskCallbackFunc)tracker_heartbeat,
-            tracker, NULL, NULL, NULL);
-    worker_scheduleTask(heartbeatTask, tracker->interval);
-    task_unref(heartbeatTask);
+    worker_scheduleLocalEvent(event_newHeartbeat(tracker), tracker->interval);
 }
@@ -25,6 +25,9 @@ void tracker_addProcessingTime(Tracker* tracker, SimulationTime processingTime);
 void tracker_addVirtualProcessingDelay(Tracker* tracker, SimulationTime delay);
 void tracker_addInputBytes(Tracker* tracker, Packet* packet, gint handle);
 void tracker_addOutputBytes(Tracker* tracker, Packet* packet, gint handle);
+gsize tracker_getInputBytesTotal(Tracker* tracker);
+gsize tracker_getOutputBytesTotal(Tracker* tracker);
+gsize tracker_getAllocatedBytesTotal(Tracker* tracker);
 void tracker_addAllocatedBytes(Tracker* tracker, gpointer location, gsize allocatedBytes);
 void tracker_removeAllocatedBytes(Tracker* tracker, gpointer location);
 void tracker_addSocket(Tracker* tracker, gint handle, ProtocolType type, gsize inputBufferSize, gsize outputBufferSize);
@@ -32,6 +35,6 @@ void tracker_updateSocketPeer(Tracker* tracker, gint handle, in_addr_t peerIP, i
 void tracker_updateSocketInputBuffer(Tracker* tracker, gint handle, gsize inputBufferLength, gsize inputBufferSize);
 void tracker_updateSocketOutputBuffer(Tracker* tracker, gint handle, gsize outputBufferLength, gsize outputBufferSize);
 void tracker_removeSocket(Tracker* tracker, gint handle);
-void tracker_heartbeat(Tracker* tracker, gpointer userData);
+void tracker_heartbeat(Tracker* tracker);
 
 #endif /* SHD_TRACKER_H_ */
@@ -0,0 +1,819 @@
+/*
+ * The Shadow Simulator
+ * Copyright (c) 2010-2011, Rob Jansen
+ * See LICENSE for licensing information
+ */
+
+#include "main/host/traffic_model.h"
+
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "main/core/work/task.h"
+#include "main/core/worker.h"
+#include "main/host/descriptor/descriptor.h"
+#include "main/host/host.h"
+#include "main/routing/address.h"
+#include "main/utility/random.h"
+#include "main/utility/utility.h"
+#include "support/logger/logger.h"
+
+/* the largest chunk we hand to the socket layer at once */
+#define TRAFFIC_MODEL_CHUNK_SIZE CONFIG_DATAGRAM_MAX_SIZE
+
+/* datagrams are never resent, so a udp client gives up on a response after this
+ * long without receiving any of it and sends the next request */
+#define TRAFFIC_MODEL_RESPONSE_TIMEOUT SIMTIME_ONE_SECOND
+
+/* the payload contents are never inspected, so all writers share these zeros */
+static const gchar _trafficModelZeros[TRAFFIC_MODEL_CHUNK_SIZE];
+
+typedef struct _TrafficConnection TrafficConnection;
+struct _TrafficConnection {
+    gint handle;
+    /* where to send replies on an unconnected (udp server) socket */
+    in_addr_t replyIP;
+    in_port_t replyPort;
+    /* bytes we still need to write */
+    gsize sendPending;
+    /* bytes received towards the next complete request (server) */
+    gsize requestReceived;
+    /* bytes we still expect before the current response is complete (client) */
+    gsize responsePending;
+    gboolean isWaitingForResponse;
+    /* when a udp client stops waiting for the current response (client) */
+    SimulationTime responseDeadline;
+    gboolean isTimeoutScheduled;
+    /* the udp exchange we are on. every datagram starts with it and the server copies
+     * it from the request into the response, so a client can drop the late response
+     * to a request it already gave up on. */
+    guint32 sequence;
+};
+
+struct _TrafficModel {
+    guint id;
+    TrafficModelParameters params;
+    GString* name;
+
+    /* the host we run on, assigned when we start. we are owned by the host. */
+    Host* host;
+    in_addr_t peerIP;
+
+    /* the server socket, or -1 */
+    gint listenHandle;
+    /* handle to TrafficConnection, for all of our open sockets */
+    GHashTable* connections;
+    /* the set of handles whose status changed since we last checked */
+    GHashTable* pendingHandles;
+
+    gboolean isRunning;
+    gboolean isNotifyScheduled;
+    gboolean isProcessing;
+
+    /* state for the on/off model */
+    gboolean isOn;
+    SimulationTime phaseEndTime;
+
+    /* what we did, logged when we stop */
+    guint64 bytesSent;
+    guint64 bytesReceived;
+    guint64 exchangesCompleted;
+    guint64 exchangesTimedOut;
+
+    gint referenceCount;
+    MAGIC_DECLARE;
+};
+
+TrafficModelType trafficmodel_typeFromString(const gchar* typeStr) {
+    if(typeStr == NULL) {
+        return TM_NONE;
+    } else if(!g_ascii_strcasecmp(typeStr, "fixedrate")) {
+        return TM_FIXEDRATE;
+    } else if(!g_ascii_strcasecmp(typeStr, "onoff")) {
+        return TM_ONOFF;
+    } else if(!g_ascii_strcasecmp(typeStr, "requestresponse")) {
+        return TM_REQUESTRESPONSE;
+    } else if(!g_ascii_strcasecmp(typeStr, "server")) {
+        return TM_SERVER;
+    } else {
+        return TM_NONE;
+    }
+}
+
+const gchar* trafficmodel_typeToString(TrafficModelType type) {
+    switch(type) {
+        case TM_FIXEDRATE:
+            return "fixedrate";
+        case TM_ONOFF:
+            return "onoff";
+        case TM_REQUESTRESPONSE:
+            return "requestresponse";
+        case TM_SERVER:
+            return "server";
+        case TM_NONE:
+        default:
+            return "none";
+    }
+}
+
+TrafficModel* trafficmodel_new(guint id, TrafficModelParameters* params) {
+    utility_assert(params);
+    utility_assert(params->type != TM_NONE);
+
+    TrafficModel* model = g_new0(TrafficModel, 1);
+    MAGIC_INIT(model);
+
+    model->id = id;
+    model->params = *params;
+    model->params.peerHostname = g_strdup(params->peerHostname);
+
+    if(model->params.protocol != PTCP && model->params.protocol != PUDP) {
+        model->params.protocol = PTCP;
+    }
+    if(model->params.interval == 0) {
+        model->params.interval = SIMTIME_ONE_SECOND;
+    }
+    if(model->params.meanOnTime == 0) {
+        model->params.meanOnTime = SIMTIME_ONE_SECOND;
+    }
+    if(model->params.meanOffTime == 0) {
+        model->params.meanOffTime = SIMTIME_ONE_SECOND;
+    }
+
+    model->listenHandle = -1;
+    model->connections = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, g_free);
+    model->pendingHandles = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    model->referenceCount = 1;
+
+    return model;
+}
+
+static void _trafficmodel_free(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    utility_assert(g_hash_table_size(model->connections) == 0);
+    g_hash_table_destroy(model->connections);
+    g_hash_table_destroy(model->pendingHandles);
+
+    if(model->name) {
+        g_string_free(model->name, TRUE);
+    }
+    if(model->params.peerHostname) {
+        g_free(model->params.peerHostname);
+    }
+
+    MAGIC_CLEAR(model);
+    g_free(model);
+}
+
+void trafficmodel_ref(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+    (model->referenceCount)++;
+}
+
+void trafficmodel_unref(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+    (model->referenceCount)--;
+    utility_assert(model->referenceCount >= 0);
+    if(model->referenceCount == 0) {
+        _trafficmodel_free(model);
+    }
+}
+
+gboolean trafficmodel_isRunning(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+    return model->isRunning;
+}
+
+static const gchar* _trafficmodel_getName(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+    return model->name ? model->name->str : trafficmodel_typeToString(model->params.type);
+}
+
+static void _trafficmodel_runNotifyTask(TrafficModel* model, gpointer nothing);
+
+static void _trafficmodel_scheduleNotification(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    if(!model->isRunning || model->isNotifyScheduled || model->isProcessing) {
+        return;
+    }
+
+    trafficmodel_ref(model);
+    Task* notifyTask = task_new((TaskCallbackFunc)_trafficmodel_runNotifyTask,
+            model, NULL, (TaskObjectFreeFunc)trafficmodel_unref, NULL);
+    if(worker_scheduleTask(notifyTask, 1)) {
+        model->isNotifyScheduled = TRUE;
+    }
+    task_unref(notifyTask);
+}
+
+/* TRUE if the descriptor has something for us to do, so that the status changes
+ * caused by our own reads and writes until the socket would block are ignored */
+static gboolean _trafficmodel_isReady(TrafficModel* model, Descriptor* descriptor) {
+    MAGIC_ASSERT(model);
+
+    DescriptorStatus status = descriptor_getStatus(descriptor);
+    if(status & (DS_READABLE | DS_CLOSED)) {
+        return TRUE;
+    }
+    if(status & DS_WRITABLE) {
+        TrafficConnection* conn = g_hash_table_lookup(model->connections, &(descriptor->handle));
+        return (conn && conn->sendPending > 0) ? TRUE : FALSE;
+    }
+    return FALSE;
+}
+
+static void _trafficmodel_descriptorStatusChanged(Descriptor* descriptor, TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    if(!model->isRunning || !_trafficmodel_isReady(model, descriptor)) {
+        return;
+    }
+
+    /* the socket layer may also signal readiness while we are processing, e.g., when
+     * our cpu is blocked, so we always record it and check again when we are done */
+    g_hash_table_add(model->pendingHandles, GINT_TO_POINTER(descriptor->handle));
+    _trafficmodel_scheduleNotification(model);
+}
+
+static void _trafficmodel_finishProcessing(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    model->isProcessing = FALSE;
+
+    /* handle what became ready while we were busy in a new task, which runs after
+     * our cpu delay was absorbed if that is why a socket would not take the data */
+    if(g_hash_table_size(model->pendingHandles) > 0) {
+        _trafficmodel_scheduleNotification(model);
+    }
+}
+
+static void _trafficmodel_watchDescriptor(TrafficModel* model, gint handle, gboolean doWatch) {
+    MAGIC_ASSERT(model);
+
+    Descriptor* descriptor = host_lookupDescriptor(model->host, handle);
+    if(descriptor) {
+        if(doWatch) {
+            descriptor_setStatusCallback(descriptor,
+                    (DescriptorStatusCallbackFunc)_trafficmodel_descriptorStatusChanged, model);
+        } else {
+            descriptor_setStatusCallback(descriptor, NULL, NULL);
+        }
+    }
+}
+
+static void _trafficmodel_runTickTask(TrafficModel* model, gpointer nothing);
+
+static void _trafficmodel_scheduleTick(TrafficModel* model, SimulationTime delay) {
+    MAGIC_ASSERT(model);
+
+    trafficmodel_ref(model);
+    Task* tickTask = task_new((TaskCallbackFunc)_trafficmodel_runTickTask,
+            model, NULL, (TaskObjectFreeFunc)trafficmodel_unref, NULL);
+    worker_scheduleTask(tickTask, MAX(delay, 1));
+    task_unref(tickTask);
+}
+
+static void _trafficmodel_runResponseTimeoutTask(TrafficModel* model, gpointer nothing);
+
+static void _trafficmodel_scheduleResponseTimeout(TrafficModel* model, TrafficConnection* conn) {
+    MAGIC_ASSERT(model);
+    utility_assert(conn);
+
+    /* a single timeout task per connection, it follows the deadline as it moves */
+    if(conn->isTimeoutScheduled) {
+        return;
+    }
+
+    SimulationTime now = worker_getCurrentTime();
+    SimulationTime delay = conn->responseDeadline > now ? conn->responseDeadline - now : 1;
+
+    trafficmodel_ref(model);
+    Task* timeoutTask = task_new((TaskCallbackFunc)_trafficmodel_runResponseTimeoutTask,
+            model, NULL, (TaskObjectFreeFunc)trafficmodel_unref, NULL);
+    if(worker_scheduleTask(timeoutTask, delay)) {
+        conn->isTimeoutScheduled = TRUE;
+    }
+    task_unref(timeoutTask);
+}
+
+static TrafficConnection* _trafficmodel_addConnection(TrafficModel* model, gint handle) {
+    MAGIC_ASSERT(model);
+
+    TrafficConnection* conn = g_new0(TrafficConnection, 1);
+    conn->handle = handle;
+    g_hash_table_replace(model->connections, &(conn->handle), conn);
+
+    _trafficmodel_watchDescriptor(model, handle, TRUE);
+
+    return conn;
+}
+
+static void _trafficmodel_closeConnection(TrafficModel* model, TrafficConnection* conn) {
+    MAGIC_ASSERT(model);
+    utility_assert(conn);
+
+    gint handle = conn->handle;
+    gboolean wasWaitingForResponse = conn->isWaitingForResponse;
+
+    _trafficmodel_watchDescriptor(model, handle, FALSE);
+    if(host_lookupDescriptor(model->host, handle)) {
+        host_closeUser(model->host, handle);
+    }
+
+    g_hash_table_remove(model->pendingHandles, GINT_TO_POINTER(handle));
+    /* frees conn */
+    g_hash_table_remove(model->connections, &handle);
+
+    if(model->isRunning && wasWaitingForResponse) {
+        /* we lost the connection mid-exchange, try again after thinking */
+        _trafficmodel_scheduleTick(model, model->params.interval);
+    }
+}
+
+static TrafficConnection* _trafficmodel_getClientConnection(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+    utility_assert(model->params.type != TM_SERVER);
+
+    /* clients only ever have a single connection to the peer */
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, model->connections);
+    if(g_hash_table_iter_next(&iter, &key, &value)) {
+        return value;
+    }
+    return NULL;
+}
+
+static TrafficConnection* _trafficmodel_openClientConnection(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    DescriptorType dtype = model->params.protocol == PUDP ? DT_UDPSOCKET : DT_TCPSOCKET;
+    gint handle = host_createDescriptor(model->host, dtype);
+
+    struct sockaddr_in peer;
+    memset(&peer, 0, sizeof(struct sockaddr_in));
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = model->peerIP;
+    peer.sin_port = model->params.peerPort;
+
+    gint result = host_connectToPeer(model->host, handle, (struct sockaddr*)&peer);
+    if(result != 0 && result != EINPROGRESS) {
+        warning("traffic model '%s' unable to connect to peer '%s': error %i",
+                _trafficmodel_getName(model), model->params.peerHostname, result);
+        host_closeUser(model->host, handle);
+        return NULL;
+    }
+
+    debug("traffic model '%s' opened socket %i to peer '%s'",
+            _trafficmodel_getName(model), handle, model->params.peerHostname);
+
+    return _trafficmodel_addConnection(model, handle);
+}
+
+/* returns FALSE if the connection was closed */
+static gboolean _trafficmodel_flush(TrafficModel* model, TrafficConnection* conn) {
+    MAGIC_ASSERT(model);
+    utility_assert(conn);
+
+    const gchar* data = _trafficModelZeros;
+    gchar datagram[TRAFFIC_MODEL_CHUNK_SIZE];
+    if(model->params.protocol == PUDP && conn->sendPending > 0) {
+        /* datagrams too short to hold the sequence go out untagged */
+        memset(datagram, 0, MIN(conn->sendPending, TRAFFIC_MODEL_CHUNK_SIZE));
+        memcpy(datagram, &(conn->sequence), sizeof(guint32));
+        data = datagram;
+    }
+
+    while(conn->sendPending > 0) {
+        gsize length = MIN(conn->sendPending, TRAFFIC_MODEL_CHUNK_SIZE);
+        gsize bytesCopied = 0;
+
+        gint result = host_sendUserData(model->host, conn->handle, data,
+                length, conn->replyIP, conn->replyPort, &bytesCopied);
+
+        if(result == EWOULDBLOCK || result == EAGAIN) {
+            /* we will be notified when the socket becomes writable */
+            return TRUE;
+        } else if(result != 0) {
+            debug("traffic model '%s' socket %i send error %i",
+                    _trafficmodel_getName(model), conn->handle, result);
+            _trafficmodel_closeConnection(model, conn);
+            return FALSE;
+        }
+
+        conn->sendPending -= MIN(bytesCopied, conn->sendPending);
+        model->bytesSent += bytesCopied;
+
+        /* datagrams that were not fully accepted are dropped */
+        if(model->params.protocol == PUDP && bytesCopied < length) {
+            conn->sendPending -= MIN(length - bytesCopied, conn->sendPending);
+        }
+    }
+
+    return TRUE;
+}
+
+static void _trafficmodel_handleReceived(TrafficModel* model, TrafficConnection* conn, gsize nBytes) {
+    MAGIC_ASSERT(model);
+    utility_assert(conn);
+
+    model->bytesReceived += nBytes;
+
+    if(model->params.type == TM_SERVER) {
+        if(model->params.size == 0) {
+            /* discard only */
+            return;
+        }
+
+        conn->requestReceived += nBytes;
+        while(conn->requestReceived >= model->params.size) {
+            conn->requestReceived -= model->params.size;
+            conn->sendPending += model->params.responseSize;
+            model->exchangesCompleted++;
+        }
+    } else if(conn->isWaitingForResponse) {
+        conn->responsePending -= MIN(nBytes, conn->responsePending);
+        if(model->params.protocol == PUDP) {
+            /* the response is still arriving, keep waiting for the rest of it */
+            conn->responseDeadline = worker_getCurrentTime() + TRAFFIC_MODEL_RESPONSE_TIMEOUT;
+        }
+        if(conn->responsePending == 0) {
+            conn->isWaitingForResponse = FALSE;
+            model->exchangesCompleted++;
+            /* think, then send the next request */
+            _trafficmodel_scheduleTick(model, model->params.interval);
+        }
+    }
+}
+
+/* returns FALSE if the connection was closed */
+static gboolean _trafficmodel_drain(TrafficModel* model, TrafficConnection* conn) {
+    MAGIC_ASSERT(model);
+    utility_assert(conn);
+
+    gchar buffer[TRAFFIC_MODEL_CHUNK_SIZE];
+
+    while(TRUE) {
+        in_addr_t ip = 0;
+        in_port_t port = 0;
+        gsize bytesCopied = 0;
+
+        gint result = host_receiveUserData(model->host, conn->handle, buffer,
+                sizeof(buffer), &ip, &port, &bytesCopied);
+
+        if(result == EWOULDBLOCK || result == EAGAIN) {
+            return TRUE;
+        } else if(result != 0 || (bytesCopied == 0 && model->params.protocol == PTCP)) {
+            /* error, or the peer closed the stream */
+            debug("traffic model '%s' socket %i closed (%i)",
+                    _trafficmodel_getName(model), conn->handle, result);
+            _trafficmodel_closeConnection(model, conn);
+            return FALSE;
+        } else if(bytesCopied == 0) {
+            return TRUE;
+        }
+
+        guint32 sequence = 0;
+        gboolean isTagged = FALSE;
+        if(model->params.protocol == PUDP && bytesCopied >= sizeof(guint32)) {
+            memcpy(&sequence, buffer, sizeof(guint32));
+            isTagged = TRUE;
+        }
+
+        if(model->params.type == TM_SERVER && model->params.protocol == PUDP) {
+            /* answer the sender of this datagram right away, for the same exchange */
+            conn->replyIP = ip;
+            conn->replyPort = port;
+            conn->sequence = sequence;
+            _trafficmodel_handleReceived(model, conn, bytesCopied);
+            if(!_trafficmodel_flush(model, conn)) {
+                return FALSE;
+            }
+            /* drop whatever the socket would not take */
+            conn->sendPending = 0;
+        } else if(isTagged && sequence != conn->sequence) {
+            /* a late response to an exchange that already timed out */
+            model->bytesReceived += bytesCopied;
+            debug("traffic model '%s' dropped %"G_GSIZE_FORMAT" stale response bytes for exchange %u "
+                    "on socket %i, now on exchange %u", _trafficmodel_getName(model), bytesCopied,
+                    sequence, conn->handle, conn->sequence);
+        } else {
+            _trafficmodel_handleReceived(model, conn, bytesCopied);
+        }
+    }
+}
+
+static void _trafficmodel_acceptPeers(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    while(TRUE) {
+        in_addr_t ip = 0;
+        in_port_t port = 0;
+        gint childHandle = 0;
+
+        gint result = host_acceptNewPeer(model->host, model->listenHandle, &ip, &port, &childHandle);
+        if(result != 0) {
+            return;
+        }
+
+        TrafficConnection* conn = _trafficmodel_addConnection(model, childHandle);
+        if(_trafficmodel_drain(model, conn)) {
+            _trafficmodel_flush(model, conn);
+        }
+    }
+}
+
+static void _trafficmodel_runNotifyTask(TrafficModel* model, gpointer nothing) {
+    MAGIC_ASSERT(model);
+
+    model->isNotifyScheduled = FALSE;
+    if(!model->isRunning) {
+        return;
+    }
+
+    model->isProcessing = TRUE;
+
+    GList* handles = g_hash_table_get_keys(model->pendingHandles);
+    g_hash_table_remove_all(model->pendingHandles);
+
+    for(GList* item = handles; item != NULL; item = g_list_next(item)) {
+        gint handle = GPOINTER_TO_INT(item->data);
+
+        if(handle == model->listenHandle && model->params.protocol == PTCP) {
+            _trafficmodel_acceptPeers(model);
+            continue;
+        }
+
+        TrafficConnection* conn = g_hash_table_lookup(model->connections, &handle);
+        if(conn && _trafficmodel_drain(model, conn)) {
+            _trafficmodel_flush(model, conn);
+        }
+    }
+
+    g_list_free(handles);
+
+    _trafficmodel_finishProcessing(model);
+}
+
+static void _trafficmodel_runTickTask(TrafficModel* model, gpointer nothing) {
+    MAGIC_ASSERT(model);
+
+    if(!model->isRunning) {
+        return;
+    }
+
+    TrafficConnection* conn = _trafficmodel_getClientConnection(model);
+    if(!conn) {
+        /* (re)connect if the last connection failed or was closed by the peer */
+        conn = _trafficmodel_openClientConnection(model);
+    }
+
+    SimulationTime now = worker_getCurrentTime();
+    SimulationTime nextTick = model->params.interval;
+
+    switch(model->params.type) {
+        case TM_FIXEDRATE: {
+            if(conn) {
+                conn->sendPending += model->params.size;
+            }
+            break;
+        }
+
+        case TM_ONOFF: {
+            if(now >= model->phaseEndTime) {
+                /* flip the phase and draw its length from an exponential distribution */
+                model->isOn = !model->isOn;
+                SimulationTime mean = model->isOn ? model->params.meanOnTime : model->params.meanOffTime;
+                gdouble u = random_nextDouble(host_getRandom(model->host));
+                gdouble length = -((gdouble)mean) * log(1.0f - MIN(u, 0.999999f));
+                model->phaseEndTime = now + MAX((SimulationTime)length, 1);
+            }
+
+            if(model->isOn && conn) {
+                conn->sendPending += model->params.size;
+            }
+
+            SimulationTime remaining = model->phaseEndTime - now;
+            nextTick = model->isOn ? MIN(nextTick, remaining) : remaining;
+            break;
+        }
+
+        case TM_REQUESTRESPONSE: {
+            if(conn && conn->isWaitingForResponse) {
+                /* a response is still outstanding, it will schedule the next request */
+                return;
+            }
+
+            if(conn) {
+                conn->sequence++;
+                conn->sendPending += model->params.size;
+                conn->responsePending = model->params.responseSize;
+                conn->isWaitingForResponse = model->params.responseSize > 0 ? TRUE : FALSE;
+            }
+
+            if(conn && conn->isWaitingForResponse) {
+                nextTick = 0;
+                if(model->params.protocol == PUDP) {
+                    conn->responseDeadline = now + TRAFFIC_MODEL_RESPONSE_TIMEOUT;
+                    _trafficmodel_scheduleResponseTimeout(model, conn);
+                }
+            }
+            break;
+        }
+
+        case TM_SERVER:
+        case TM_NONE:
+        default: {
+            utility_assert(FALSE);
+            return;
+        }
+    }
+
+    if(conn) {
+        /* batch the status changes caused by our own writes */
+        model->isProcessing = TRUE;
+        _trafficmodel_flush(model, conn);
+        _trafficmodel_finishProcessing(model);
+    }
+
+    if(nextTick > 0) {
+        _trafficmodel_scheduleTick(model, nextTick);
+    }
+}
+
+static void _trafficmodel_runResponseTimeoutTask(TrafficModel* model, gpointer nothing) {
+    MAGIC_ASSERT(model);
+
+    if(!model->isRunning) {
+        return;
+    }
+
+    TrafficConnection* conn = _trafficmodel_getClientConnection(model);
+    if(!conn) {
+        return;
+    }
+    conn->isTimeoutScheduled = FALSE;
+
+    if(!conn->isWaitingForResponse) {
+        return;
+    }
+    if(worker_getCurrentTime() < conn->responseDeadline) {
+        /* some of the response arrived since we were scheduled */
+        _trafficmodel_scheduleResponseTimeout(model, conn);
+        return;
+    }
+
+    debug("traffic model '%s' timed out waiting for %"G_GSIZE_FORMAT" response bytes on socket %i",
+            _trafficmodel_getName(model), conn->responsePending, conn->handle);
+
+    /* the request or part of the response was lost, move on to the next request */
+    conn->isWaitingForResponse = FALSE;
+    conn->responsePending = 0;
+    model->exchangesTimedOut++;
+    _trafficmodel_scheduleTick(model, model->params.interval);
+}
+
+static gboolean _trafficmodel_startServer(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    DescriptorType dtype = model->params.protocol == PUDP ? DT_UDPSOCKET : DT_TCPSOCKET;
+    gint handle = host_createDescriptor(model->host, dtype);
+
+    struct sockaddr_in bindAddress;
+    memset(&bindAddress, 0, sizeof(struct sockaddr_in));
+    bindAddress.sin_family = AF_INET;
+    bindAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    bindAddress.sin_port = model->params.peerPort;
+
+    gint result = host_bindToInterface(model->host, handle, (struct sockaddr*)&bindAddress);
+    if(result == 0 && model->params.protocol == PTCP) {
+        result = host_listenForPeer(model->host, handle, SOMAXCONN);
+    }
+
+    if(result != 0) {
+        warning("traffic model '%s' unable to listen on port %u: error %i",
+                _trafficmodel_getName(model), ntohs(model->params.peerPort), result);
+        host_closeUser(model->host, handle);
+        return FALSE;
+    }
+
+    model->listenHandle = handle;
+
+    if(model->params.protocol == PUDP) {
+        /* the bound socket receives all of the requests itself */
+        _trafficmodel_addConnection(model, handle);
+    } else {
+        _trafficmodel_watchDescriptor(model, handle, TRUE);
+    }
+
+    return TRUE;
+}
+
+static void _trafficmodel_start(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    if(model->isRunning) {
+        return;
+    }
+
+    model->host = worker_getActiveHost();
+    utility_assert(model->host);
+
+    if(!model->name) {
+        model->name = g_string_new(NULL);
+        g_string_printf(model->name, "%s.%s.%u", host_getName(model->host),
+                trafficmodel_typeToString(model->params.type), model->id);
+    }
+
+    message("starting traffic model '%s'", _trafficmodel_getName(model));
+
+    if(model->params.type == TM_SERVER) {
+        if(!_trafficmodel_startServer(model)) {
+            return;
+        }
+        model->isRunning = TRUE;
+    } else {
+        Address* peerAddress = worker_resolveNameToAddress(model->params.peerHostname);
+        if(!peerAddress) {
+            warning("traffic model '%s' unable to resolve peer '%s'",
+                    _trafficmodel_getName(model), model->params.peerHostname);
+            return;
+        }
+        model->peerIP = (in_addr_t)address_toNetworkIP(peerAddress);
+        model->isRunning = TRUE;
+        _trafficmodel_scheduleTick(model, 1);
+    }
+}
+
+void trafficmodel_stop(TrafficModel* model) {
+    MAGIC_ASSERT(model);
+
+    if(!model->isRunning) {
+        return;
+    }
+
+    model->isRunning = FALSE;
+
+    message("stopping traffic model '%s': sent %"G_GUINT64_FORMAT" bytes, received %"G_GUINT64_FORMAT
+            " bytes, completed %"G_GUINT64_FORMAT" exchanges, %"G_GUINT64_FORMAT" timed out",
+            _trafficmodel_getName(model), model->bytesSent, model->bytesReceived,
+            model->exchangesCompleted, model->exchangesTimedOut);
+
+    GList* conns = g_hash_table_get_values(model->connections);
+    for(GList* item = conns; item != NULL; item = g_list_next(item)) {
+        _trafficmodel_closeConnection(model, item->data);
+    }
+    g_list_free(conns);
+
+    if(model->listenHandle >= 0) {
+        /* the udp server socket was closed with the connections */
+        if(model->params.protocol == PTCP) {
+            _trafficmodel_watchDescriptor(model, model->listenHandle, FALSE);
+            host_closeUser(model->host, model->listenHandle);
+        }
+        model->listenHandle = -1;
+    }
+
+    g_hash_table_remove_all(model->pendingHandles);
+}
+
+static void _trafficmodel_runStartTask(TrafficModel* model, gpointer nothing) {
+    _trafficmodel_start(model);
+}
+
+static void _trafficmodel_runStopTask(TrafficModel* model, gpointer nothing) {
+    trafficmodel_stop(model);
+}
+
+void trafficmodel_schedule(TrafficModel* model, gpointer nothing) {
+    MAGIC_ASSERT(model);
+
+    SimulationTime now = worker_getCurrentTime();
+    SimulationTime startTime = model->params.startTime;
+    SimulationTime stopTime = model->params.stopTime;
+
+    if(stopTime == 0 || startTime < stopTime) {
+        SimulationTime startDelay = startTime <= now ? 1 : startTime - now;
+        trafficmodel_ref(model);
+        Task* startTask = task_new((TaskCallbackFunc)_trafficmodel_runStartTask,
+                model, NULL, (TaskObjectFreeFunc)trafficmodel_unref, NULL);
+        worker_scheduleTask(startTask, startDelay);
+        task_unref(startTask);
+    }
+
+    if(stopTime > 0 && stopTime > startTime) {
+        SimulationTime stopDelay = stopTime <= now ? 1 : stopTime - now;
+        trafficmodel_ref(model);
+        Task* stopTask = task_new((TaskCallbackFunc)_trafficmodel_runStopTask,
+                model, NULL, (TaskObjectFreeFunc)trafficmodel_unref, NULL);
+        worker_scheduleTask(stopTask, stopDelay);
+        task_unref(stopTask);
+    }
+}
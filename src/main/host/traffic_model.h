@@ -0,0 +1,65 @@
+/*
+ * The Shadow Simulator
+ * Copyright (c) 2010-2011, Rob Jansen
+ * See LICENSE for licensing information
+ */
+
+#ifndef SHD_TRAFFIC_MODEL_H_
+#define SHD_TRAFFIC_MODEL_H_
+
+#include <glib.h>
+#include <netinet/in.h>
+
+#include "main/core/support/definitions.h"
+#include "main/host/protocol.h"
+
+/*
+ * A traffic model is a built-in background load generator that drives
+ * Shadow's socket layer directly from scheduler tasks, so it runs without
+ * loading a plug-in, creating pth threads, or emulating system calls.
+ */
+
+typedef enum _TrafficModelType TrafficModelType;
+enum _TrafficModelType {
+    TM_NONE,
+    /* send 'size' bytes to the peer every 'interval' */
+    TM_FIXEDRATE,
+    /* like fixedrate, but alternate exponentially distributed on/off periods */
+    TM_ONOFF,
+    /* send a 'size' byte request and wait for a 'responsesize' byte response,
+     * then think for 'interval' and repeat */
+    TM_REQUESTRESPONSE,
+    /* listen on 'port', answer every 'size' request bytes with 'responsesize'
+     * response bytes, and discard everything else */
+    TM_SERVER,
+};
+
+typedef struct _TrafficModelParameters TrafficModelParameters;
+struct _TrafficModelParameters {
+    TrafficModelType type;
+    ProtocolType protocol;
+    gchar* peerHostname;
+    in_port_t peerPort;
+    SimulationTime startTime;
+    SimulationTime stopTime;
+    gsize size;
+    gsize responseSize;
+    SimulationTime interval;
+    SimulationTime meanOnTime;
+    SimulationTime meanOffTime;
+};
+
+typedef struct _TrafficModel TrafficModel;
+
+TrafficModelType trafficmodel_typeFromString(const gchar* typeStr);
+const gchar* trafficmodel_typeToString(TrafficModelType type);
+
+TrafficModel* trafficmodel_new(guint id, TrafficModelParameters* params);
+void trafficmodel_ref(TrafficModel* model);
+void trafficmodel_unref(TrafficModel* model);
+
+void trafficmodel_schedule(TrafficModel* model, gpointer nothing);
+void trafficmodel_stop(TrafficModel* model);
+gboolean trafficmodel_isRunning(TrafficModel* model);
+
+#endif /* SHD_TRAFFIC_MODEL_H_ */
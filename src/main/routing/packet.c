@@ -7,7 +7,7 @@
 #include <netinet/in.h>
 #include <stddef.h>
 
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/host/host.h"
 #include "main/routing/address.h"
@@ -56,8 +56,15 @@ struct _Packet {
      */
     gdouble priority;
 
+    /* the union of all statuses this packet went through. the order of
+     * statuses is recorded in the packet trace, if enabled. */
     PacketDeliveryStatusFlags allStatus;
-    GQueue* orderedStatus;
+
+    /* links for the socket buffers that hold this packet, so queuing it does
+     * not allocate. a loopback packet can sit in the receiving socket's input
+     * buffer while the sender queues it again for retransmission. */
+    GList socketInputLink;
+    GList socketOutputLink;
 
     MAGIC_DECLARE;
 };
@@ -88,8 +95,6 @@ Packet* packet_new(gconstpointer payload, gsize payloadLength, guint hostID, gui
         packet->priority = host_getNextPacketPriority(worker_getActiveHost());
     }
 
-    packet->orderedStatus = g_queue_new();
-
     worker_countObject(OBJECT_TYPE_PACKET, COUNTER_TYPE_NEW);
     return packet;
 }
@@ -116,11 +121,6 @@ Packet* packet_copy(Packet* packet) {
 
     copy->allStatus = packet->allStatus;
 
-    if(packet->orderedStatus) {
-        /* this is ok because we store ints in the pointers, not objects */
-        copy->orderedStatus = g_queue_copy(packet->orderedStatus);
-    }
-
     copy->protocol = packet->protocol;
     if(packet->header) {
         switch (packet->protocol) {
@@ -176,9 +176,6 @@ static void _packet_free(Packet* packet) {
     if(packet->payload) {
         payload_unref(packet->payload);
     }
-    if(packet->orderedStatus) {
-        g_queue_free(packet->orderedStatus);
-    }
 
     MAGIC_CLEAR(packet);
     g_free(packet);
@@ -200,6 +197,18 @@ void packet_unref(Packet* packet) {
     }
 }
 
+GList* packet_getSocketInputLink(Packet* packet) {
+    MAGIC_ASSERT(packet);
+    packet->socketInputLink.data = packet;
+    return &(packet->socketInputLink);
+}
+
+GList* packet_getSocketOutputLink(Packet* packet) {
+    MAGIC_ASSERT(packet);
+    packet->socketOutputLink.data = packet;
+    return &(packet->socketOutputLink);
+}
+
 void packet_setPriority(Packet *packet, double value) {
    packet->priority = value;
 }
@@ -620,21 +629,17 @@ gchar* packet_toString(Packet* packet) {
         }
     }
     
-    guint statusLength = g_queue_get_length(packet->orderedStatus);
-    if(statusLength > 0) {
+    if(packet->allStatus != PDS_NONE) {
         g_string_append_printf(packetString, " status=");
-    }
-    for(int i = 0; i < statusLength; i++) {
-        gpointer statusPtr = g_queue_pop_head(packet->orderedStatus);
-        PacketDeliveryStatusFlags status = (PacketDeliveryStatusFlags) GPOINTER_TO_UINT(statusPtr);
-
-        if(i < statusLength - 1) {
-            g_string_append_printf(packetString, "%s,", _packet_deliveryStatusToAscii(status));
-        } else {
-            g_string_append_printf(packetString, "%s", _packet_deliveryStatusToAscii(status));
+        gboolean isFirst = TRUE;
+        for(guint bit = 0; bit < 32; bit++) {
+            PacketDeliveryStatusFlags status = (PacketDeliveryStatusFlags)(1u << bit);
+            if(packet->allStatus & status) {
+                g_string_append_printf(packetString, isFirst ? "%s" : ",%s",
+                        _packet_deliveryStatusToAscii(status));
+                isFirst = FALSE;
+            }
         }
-
-        g_queue_push_tail(packet->orderedStatus, statusPtr);
     }
 
     return g_string_free(packetString, FALSE);
@@ -649,9 +654,37 @@ void packet_addDeliveryStatus(Packet* packet, PacketDeliveryStatusFlags status)
 
     packet->allStatus |= status;
 
+    switch(status) {
+        case PDS_INET_SENT: {
+            worker_incrementStatistic(STAT_PACKET_SENT);
+            break;
+        }
+        case PDS_INET_DROPPED: {
+            worker_incrementStatistic(STAT_PACKET_DROPPED_INET);
+            break;
+        }
+        case PDS_ROUTER_DROPPED: {
+            worker_incrementStatistic(STAT_PACKET_DROPPED_ROUTER);
+            break;
+        }
+        case PDS_RCV_INTERFACE_DROPPED: {
+            worker_incrementStatistic(STAT_PACKET_DROPPED_INTERFACE);
+            break;
+        }
+        case PDS_RCV_SOCKET_DROPPED: {
+            worker_incrementStatistic(STAT_PACKET_DROPPED_SOCKET);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    /* a fixed-size record, this does not allocate */
+    worker_tracePacketStatus(packet->hostID, packet->packetID, (guint)status);
+
     gboolean skipDebug = worker_isFiltered(LOGLEVEL_DEBUG);
     if(!skipDebug) {
-        g_queue_push_tail(packet->orderedStatus, GUINT_TO_POINTER(status));
         gchar* packetStr = packet_toString(packet);
         message("[%s] %s", _packet_deliveryStatusToAscii(status), packetStr);
         g_free(packetStr);
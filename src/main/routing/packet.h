@@ -63,6 +63,10 @@ Packet* packet_copy(Packet* packet);
 void packet_ref(Packet* packet);
 void packet_unref(Packet* packet);
 
+/* the links that socket buffers use to queue this packet without allocating */
+GList* packet_getSocketInputLink(Packet* packet);
+GList* packet_getSocketOutputLink(Packet* packet);
+
 void packet_setPriority(Packet *packet, double value);
 
 void packet_setLocal(Packet* packet, enum ProtocolLocalFlags flags,
@@ -16,7 +16,6 @@ struct _Path {
     gint64 dstVertexIndex;
     gdouble latency;
     gdouble reliability;
-    guint64 packetCount;
     MAGIC_DECLARE;
 };
 
@@ -54,9 +53,9 @@ gdouble path_getReliability(Path* path) {
     return path->reliability;
 }
 
-void path_incrementPacketCount(Path* path) {
+gboolean path_isDirect(Path* path) {
     MAGIC_ASSERT(path);
-    path->packetCount++;
+    return path->isDirect;
 }
 
 gchar* path_toString(Path* path) {
@@ -66,9 +65,9 @@ gchar* path_toString(Path* path) {
 
     g_string_printf(pathStringBuffer,
             "SourceIndex=%"G_GINT64_FORMAT" DestinationIndex=%"G_GINT64_FORMAT" "
-            "Latency=%f Reliability=%f PacketCount=%"G_GUINT64_FORMAT" isDirect=%s",
+            "Latency=%f Reliability=%f isDirect=%s",
             path->srcVertexIndex, path->dstVertexIndex,
-            path->latency, path->reliability, path->packetCount,
+            path->latency, path->reliability,
             path->isDirect ? "True" : "False");
 
     return g_string_free(pathStringBuffer, FALSE);
@@ -16,8 +16,7 @@ void path_free(Path* path);
 
 gdouble path_getLatency(Path* path);
 gdouble path_getReliability(Path* path);
-
-void path_incrementPacketCount(Path* path);
+gboolean path_isDirect(Path* path);
 
 gchar* path_toString(Path* path);
 
@@ -9,7 +9,7 @@
 #include <string.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/utility/utility.h"
 
@@ -12,7 +12,7 @@
 #include <glib.h>
 
 #include "main/core/support/definitions.h"
-#include "main/core/support/object_counter.h"
+#include "main/core/support/statistics.h"
 #include "main/core/worker.h"
 #include "main/host/network_interface.h"
 #include "main/routing/packet.h"
@@ -10,6 +10,7 @@
 #include <math.h>
 #include <netinet/in.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "main/core/support/definitions.h"
@@ -21,16 +22,74 @@
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
 
+/* A copy of the parts of the graph that we need at runtime. It is compiled once
+ * from the igraph graph after the graph is validated. Scheduled topology changes
+ * only rewrite the latency and reliability of existing adjacencies, and the master
+ * applies them at round barriers while no worker reads the graph, so workers may
+ * query it concurrently without any locks during a round. */
+typedef struct _CompiledGraph CompiledGraph;
+struct _CompiledGraph {
+    gint vertexCount;
+
+    /* the vertex id strings, interned in idChunk */
+    GStringChunk* idChunk;
+    const gchar** vertexIDs;
+    /* the vertex packet loss, or 0 if the vertex does not have one */
+    gdouble* vertexPacketLoss;
+
+    /* the outgoing adjacencies in compressed sparse row form. the adjacencies of
+     * vertex v are at positions [rowOffsets[v], rowOffsets[v+1]) and are sorted
+     * by target vertex. undirected edges are stored once in each direction. */
+    gint* rowOffsets;
+    gint* adjTargets;
+    gdouble* adjLatency;
+    gdouble* adjReliability;
+    gint adjacencyCount;
+
+    /* the change slot of the edge behind each adjacency, or -1 if no changes are
+     * scheduled for it. both directions of an undirected edge share a slot. */
+    gint* adjChangeSlots;
+    gint changeSlotCount;
+
+    /* structurally equivalent vertices are collapsed into classes for path computation.
+     * each vertex maps to the lowest vertex index of its class. */
+    gint* vertexClasses;
+    gint classCount;
+};
+
+/* a scheduled change to the attributes of the edges between two vertices */
+typedef struct _TopologyChange TopologyChange;
+struct _TopologyChange {
+    SimulationTime time;
+    gint srcVertexIndex;
+    gint dstVertexIndex;
+    /* the new values, or negative if the attribute does not change */
+    gdouble latency;
+    gdouble packetLoss;
+};
+
+/* cached paths are identified by their source and destination vertex in a single pointer */
+G_STATIC_ASSERT(sizeof(gpointer) >= sizeof(guint64));
+#define TOPOLOGY_PATH_KEY(src, dst) ((gpointer)((((guint64)(guint32)(src)) << 32) | ((guint64)(guint32)(dst))))
+#define TOPOLOGY_PATH_KEY_SRC(key) ((gint)(((guint64)(key)) >> 32))
+#define TOPOLOGY_PATH_KEY_DST(key) ((gint)(((guint64)(key)) & G_MAXUINT32))
+
 struct _Topology {
     /* the imported igraph graph data - operations on it after initializations
-     * MUST be locked in cases where igraph is not thread-safe! */
+     * MUST be locked in cases where igraph is not thread-safe! we only use it while
+     * loading the graph and attaching hosts, all path lookups use the compiled graph */
     igraph_t graph;
     GMutex graphLock;
 
-    /* the edge weights currently used when computing shortest paths.
-     * this is protected by its own lock */
-    igraph_vector_t* edgeWeights;
-    GRWLock edgeWeightsLock;
+    /* the lock-free runtime representation of the graph */
+    CompiledGraph* compiled;
+
+    /* link changes scheduled during the run, sorted by time. they are only applied
+     * between rounds, when no worker is looking up paths. */
+    GQueue* changes;
+    /* the keys of the cached paths that traverse the edges of each change slot,
+     * protected by the pathCacheLock. slot->GHashTable of path keys */
+    GPtrArray* changeSlotPaths;
 
     /* each connected virtual host is assigned to a PoI vertex. we store the mapping to the
      * vertex index so we can correctly lookup the assigned edge when computing latency.
@@ -1209,58 +1268,569 @@ static gboolean _topology_checkGraph(Topology* top) {
     return isSuccess;
 }
 
-static gboolean _topology_extractEdgeWeights(Topology* top) {
+typedef struct _CompiledAdjacency CompiledAdjacency;
+struct _CompiledAdjacency {
+    gint fromVertexIndex;
+    gint toVertexIndex;
+    gint edgeIndex;
+    gdouble latency;
+    gdouble reliability;
+};
+
+static gint _topology_compareAdjacencies(const CompiledAdjacency* a, const CompiledAdjacency* b) {
+    /* sort by source, then target, then edge, so that a lookup of a vertex pair finds
+     * the lowest edge index first just like igraph_get_eid does */
+    if(a->fromVertexIndex != b->fromVertexIndex) {
+        return a->fromVertexIndex < b->fromVertexIndex ? -1 : 1;
+    } else if(a->toVertexIndex != b->toVertexIndex) {
+        return a->toVertexIndex < b->toVertexIndex ? -1 : 1;
+    } else if(a->edgeIndex != b->edgeIndex) {
+        return a->edgeIndex < b->edgeIndex ? -1 : 1;
+    } else {
+        return 0;
+    }
+}
+
+static void _topology_freeCompiledGraph(CompiledGraph* cg) {
+    if(cg->idChunk) {
+        g_string_chunk_free(cg->idChunk);
+    }
+    g_free(cg->vertexIDs);
+    g_free(cg->vertexPacketLoss);
+    g_free(cg->rowOffsets);
+    g_free(cg->adjTargets);
+    g_free(cg->adjLatency);
+    g_free(cg->adjReliability);
+    g_free(cg->adjChangeSlots);
+    g_free(cg->vertexClasses);
+    g_free(cg);
+}
+
+static const gchar* _topology_getVertexID(Topology* top, igraph_integer_t vertexIndex) {
+    utility_assert(vertexIndex >= 0 && vertexIndex < top->compiled->vertexCount);
+    return top->compiled->vertexIDs[vertexIndex];
+}
+
+/* returns the position of the first adjacency from fromVertexIndex to toVertexIndex
+ * in the compiled graph, or -1 if there is no such edge */
+static gint _topology_findAdjacency(Topology* top, igraph_integer_t fromVertexIndex,
+        igraph_integer_t toVertexIndex) {
+    const CompiledGraph* cg = top->compiled;
+    utility_assert(fromVertexIndex >= 0 && fromVertexIndex < cg->vertexCount);
+
+    gint low = cg->rowOffsets[fromVertexIndex];
+    gint high = cg->rowOffsets[fromVertexIndex + 1];
+    gint end = high;
+
+    while(low < high) {
+        gint middle = low + ((high - low) / 2);
+        if(cg->adjTargets[middle] < toVertexIndex) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return (low < end && cg->adjTargets[low] == toVertexIndex) ? low : -1;
+}
+
+static guint _topology_hashCompiledVertex(const CompiledGraph* cg, gint vertexIndex) {
+    guint hash = g_double_hash(&cg->vertexPacketLoss[vertexIndex]);
+    for(gint position = cg->rowOffsets[vertexIndex]; position < cg->rowOffsets[vertexIndex + 1]; position++) {
+        hash = (hash * 31) + (guint)cg->adjTargets[position];
+        hash = (hash * 31) + g_double_hash(&cg->adjLatency[position]);
+        hash = (hash * 31) + g_double_hash(&cg->adjReliability[position]);
+    }
+    return hash;
+}
+
+static gboolean _topology_compiledVerticesAreEquivalent(const CompiledGraph* cg,
+        gint vertexIndexA, gint vertexIndexB) {
+    gint offsetA = cg->rowOffsets[vertexIndexA];
+    gint offsetB = cg->rowOffsets[vertexIndexB];
+    gint degree = cg->rowOffsets[vertexIndexA + 1] - offsetA;
+
+    if(degree != cg->rowOffsets[vertexIndexB + 1] - offsetB ||
+            cg->vertexPacketLoss[vertexIndexA] != cg->vertexPacketLoss[vertexIndexB]) {
+        return FALSE;
+    }
+
+    for(gint i = 0; i < degree; i++) {
+        if(cg->adjTargets[offsetA + i] != cg->adjTargets[offsetB + i] ||
+                cg->adjLatency[offsetA + i] != cg->adjLatency[offsetB + i] ||
+                cg->adjReliability[offsetA + i] != cg->adjReliability[offsetB + i]) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void _topology_compileVertexClasses(Topology* top, CompiledGraph* cg) {
+    cg->vertexClasses = g_new(gint, cg->vertexCount);
+    for(gint vertexIndex = 0; vertexIndex < cg->vertexCount; vertexIndex++) {
+        cg->vertexClasses[vertexIndex] = vertexIndex;
+    }
+    cg->classCount = cg->vertexCount;
+
+    /* for directed graphs the incoming edges would also have to match, which
+     * we don't store, so we don't collapse anything */
+    if(top->isDirected) {
+        return;
+    }
+
+    /* two vertices with the same packet loss and the same neighbors over edges with
+     * the same attributes can not be adjacent (unless they have self-loops, which we
+     * exclude), so every path from one of them is also a path from the other with the
+     * same latency and reliability. hash->GList of class representatives */
+    GHashTable* representatives = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+            NULL, (GDestroyNotify)g_list_free);
+
+    for(gint vertexIndex = 0; vertexIndex < cg->vertexCount; vertexIndex++) {
+        gint degree = cg->rowOffsets[vertexIndex + 1] - cg->rowOffsets[vertexIndex];
+        if(degree == 0 || _topology_findAdjacency(top, vertexIndex, vertexIndex) >= 0) {
+            continue;
+        }
+
+        /* vertices with scheduled edge changes would not stay equivalent */
+        gboolean hasChanges = FALSE;
+        for(gint position = cg->rowOffsets[vertexIndex]; position < cg->rowOffsets[vertexIndex + 1]; position++) {
+            if(cg->adjChangeSlots[position] >= 0) {
+                hasChanges = TRUE;
+                break;
+            }
+        }
+        if(hasChanges) {
+            continue;
+        }
+
+        gpointer hashKey = GUINT_TO_POINTER(_topology_hashCompiledVertex(cg, vertexIndex));
+        GList* candidates = g_hash_table_lookup(representatives, hashKey);
+
+        gboolean foundClass = FALSE;
+        for(GList* item = candidates; item != NULL; item = g_list_next(item)) {
+            gint representative = GPOINTER_TO_INT(item->data);
+            if(_topology_compiledVerticesAreEquivalent(cg, representative, vertexIndex)) {
+                cg->vertexClasses[vertexIndex] = representative;
+                cg->classCount--;
+                foundClass = TRUE;
+                break;
+            }
+        }
+
+        if(!foundClass) {
+            /* the list head may change, so steal and replace it */
+            g_hash_table_steal(representatives, hashKey);
+            candidates = g_list_prepend(candidates, GINT_TO_POINTER(vertexIndex));
+            g_hash_table_replace(representatives, hashKey, candidates);
+        }
+    }
+
+    g_hash_table_destroy(representatives);
+
+    message("collapsed %i topology vertices into %i equivalence classes for path computation",
+            cg->vertexCount, cg->classCount);
+}
+
+/* structurally equivalent vertices have the same paths to every other vertex, so we
+ * compute and cache paths once per pair of vertex classes and every host attached to
+ * a class member uses them. a path between two different members of the same class
+ * is the only one that depends on the actual vertices, so those keep their own entry. */
+static void _topology_getPathKey(Topology* top, igraph_integer_t* srcVertexIndex,
+        igraph_integer_t* dstVertexIndex) {
+    const gint* vertexClasses = top->compiled->vertexClasses;
+    gint srcClass = vertexClasses[*srcVertexIndex];
+    gint dstClass = vertexClasses[*dstVertexIndex];
+
+    if(srcClass != dstClass || *srcVertexIndex == *dstVertexIndex) {
+        *srcVertexIndex = (igraph_integer_t)srcClass;
+        *dstVertexIndex = (igraph_integer_t)dstClass;
+    }
+}
+
+static gboolean _topology_compileGraph(Topology* top) {
     MAGIC_ASSERT(top);
 
+    CompiledGraph* cg = g_new0(CompiledGraph, 1);
+
     _topology_lockGraph(top);
-    g_rw_lock_writer_lock(&(top->edgeWeightsLock));
 
-    /* create new or clear existing edge weights */
-    if(!top->edgeWeights) {
-        top->edgeWeights = g_new0(igraph_vector_t, 1);
-    } else {
-        igraph_vector_destroy(top->edgeWeights);
-        memset(top->edgeWeights, 0, sizeof(igraph_vector_t));
+    cg->vertexCount = (gint) igraph_vcount(&top->graph);
+    gint edgeCount = (gint) igraph_ecount(&top->graph);
+
+    /* copy the vertex attributes that we need when computing paths */
+    cg->idChunk = g_string_chunk_new(4096);
+    cg->vertexIDs = g_new0(const gchar*, cg->vertexCount);
+    cg->vertexPacketLoss = g_new0(gdouble, cg->vertexCount);
+
+    for(gint vertexIndex = 0; vertexIndex < cg->vertexCount; vertexIndex++) {
+        const gchar* idStr = NULL;
+        if(!_topology_findVertexAttributeString(top, vertexIndex, VERTEX_ATTR_ID, &idStr)) {
+            _topology_unlockGraph(top);
+            critical("unable to compile topology: vertex %i has no id", vertexIndex);
+            _topology_freeCompiledGraph(cg);
+            return FALSE;
+        }
+        cg->vertexIDs[vertexIndex] = g_string_chunk_insert_const(cg->idChunk, idStr);
+
+        gdouble packetLoss;
+        if(_topology_findVertexAttributeDouble(top, vertexIndex, VERTEX_ATTR_PACKETLOSS, &packetLoss)) {
+            cg->vertexPacketLoss[vertexIndex] = packetLoss;
+        }
     }
 
-    /* now we have fresh memory */
-    gint result = igraph_vector_init(top->edgeWeights, (glong) top->edgeCount);
-    if(result != IGRAPH_SUCCESS) {
-        g_rw_lock_writer_unlock(&(top->edgeWeightsLock));
-        _topology_unlockGraph(top);
-        critical("igraph_vector_init return non-success code %i", result);
-        return FALSE;
+    /* collect the adjacencies, undirected edges may be traversed both ways */
+    CompiledAdjacency* adjacencies = g_new0(CompiledAdjacency, MAX(1, 2 * edgeCount));
+    gint adjacencyCount = 0;
+
+    for(gint edgeIndex = 0; edgeIndex < edgeCount; edgeIndex++) {
+        igraph_integer_t fromVertexIndex, toVertexIndex;
+        gint result = igraph_edge(&top->graph, edgeIndex, &fromVertexIndex, &toVertexIndex);
+        if(result != IGRAPH_SUCCESS) {
+            _topology_unlockGraph(top);
+            critical("igraph_edge return non-success code %i", result);
+            g_free(adjacencies);
+            _topology_freeCompiledGraph(cg);
+            return FALSE;
+        }
+
+        /* latency and packet loss are required attributes on edges */
+        gdouble latency, packetLoss;
+        gboolean found = _topology_findEdgeAttributeDouble(top, edgeIndex, EDGE_ATTR_LATENCY, &latency);
+        utility_assert(found);
+        found = _topology_findEdgeAttributeDouble(top, edgeIndex, EDGE_ATTR_PACKETLOSS, &packetLoss);
+        utility_assert(found);
+
+        CompiledAdjacency* adjacency = &adjacencies[adjacencyCount++];
+        adjacency->fromVertexIndex = (gint)fromVertexIndex;
+        adjacency->toVertexIndex = (gint)toVertexIndex;
+        adjacency->edgeIndex = edgeIndex;
+        adjacency->latency = latency;
+        adjacency->reliability = 1.0f - packetLoss;
+
+        if(!top->isDirected && fromVertexIndex != toVertexIndex) {
+            CompiledAdjacency* reverse = &adjacencies[adjacencyCount++];
+            *reverse = *adjacency;
+            reverse->fromVertexIndex = (gint)toVertexIndex;
+            reverse->toVertexIndex = (gint)fromVertexIndex;
+        }
     }
 
-    /* use the 'latency' edge attribute as the edge weight */
-    const gchar* latencyKey = _topology_edgeAttributeToString(EDGE_ATTR_LATENCY);
-    result = EANV(&top->graph, latencyKey, top->edgeWeights);
-    g_rw_lock_writer_unlock(&(top->edgeWeightsLock));
     _topology_unlockGraph(top);
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_cattribute_EANV return non-success code %i", result);
+
+    qsort(adjacencies, (size_t)adjacencyCount, sizeof(CompiledAdjacency),
+            (int (*)(const void*, const void*))_topology_compareAdjacencies);
+
+    /* now flatten into the row arrays */
+    cg->adjacencyCount = adjacencyCount;
+    cg->rowOffsets = g_new0(gint, cg->vertexCount + 1);
+    cg->adjTargets = g_new0(gint, MAX(1, adjacencyCount));
+    cg->adjLatency = g_new0(gdouble, MAX(1, adjacencyCount));
+    cg->adjReliability = g_new0(gdouble, MAX(1, adjacencyCount));
+    cg->adjChangeSlots = g_new(gint, MAX(1, adjacencyCount));
+
+    for(gint position = 0; position < adjacencyCount; position++) {
+        CompiledAdjacency* adjacency = &adjacencies[position];
+        cg->rowOffsets[adjacency->fromVertexIndex + 1]++;
+        cg->adjTargets[position] = adjacency->toVertexIndex;
+        cg->adjLatency[position] = adjacency->latency;
+        cg->adjReliability[position] = adjacency->reliability;
+        cg->adjChangeSlots[position] = -1;
+    }
+    for(gint vertexIndex = 0; vertexIndex < cg->vertexCount; vertexIndex++) {
+        cg->rowOffsets[vertexIndex + 1] += cg->rowOffsets[vertexIndex];
+    }
+    utility_assert(cg->rowOffsets[cg->vertexCount] == adjacencyCount);
+
+    g_free(adjacencies);
+
+    top->compiled = cg;
+
+    message("compiled topology graph with %i vertices and %i adjacencies for path lookups",
+            cg->vertexCount, cg->adjacencyCount);
+
+    return TRUE;
+}
+
+static gboolean _topology_parseChange(Topology* top, GHashTable* vertexIDs, gchar** tokens,
+        TopologyChange* change) {
+    /* time(seconds) source-id destination-id attribute=value... */
+    if(g_strv_length(tokens) < 4) {
+        critical("expected a time, two vertex ids, and at least one attribute");
         return FALSE;
     }
 
+    gchar* end = NULL;
+    gdouble seconds = g_ascii_strtod(tokens[0], &end);
+    if(end == tokens[0] || *end != '\0' || seconds < 0) {
+        critical("invalid time '%s'", tokens[0]);
+        return FALSE;
+    }
+    change->time = (SimulationTime)(seconds * SIMTIME_ONE_SECOND);
+
+    gpointer srcValue = NULL, dstValue = NULL;
+    if(!g_hash_table_lookup_extended(vertexIDs, tokens[1], NULL, &srcValue) ||
+            !g_hash_table_lookup_extended(vertexIDs, tokens[2], NULL, &dstValue)) {
+        critical("unknown vertex id '%s' or '%s'", tokens[1], tokens[2]);
+        return FALSE;
+    }
+    change->srcVertexIndex = GPOINTER_TO_INT(srcValue);
+    change->dstVertexIndex = GPOINTER_TO_INT(dstValue);
+
+    if(_topology_findAdjacency(top, change->srcVertexIndex, change->dstVertexIndex) < 0) {
+        critical("there is no edge between vertex '%s' and vertex '%s'", tokens[1], tokens[2]);
+        return FALSE;
+    }
+
+    change->latency = -1;
+    change->packetLoss = -1;
+
+    for(gint i = 3; tokens[i] != NULL; i++) {
+        gchar** pair = g_strsplit(tokens[i], "=", 2);
+        gdouble value = -1;
+        if(pair[0] && pair[1]) {
+            value = g_ascii_strtod(pair[1], &end);
+            if(end == pair[1] || *end != '\0') {
+                value = -1;
+            }
+        }
+
+        gboolean isValid = TRUE;
+        if(pair[0] && !g_ascii_strcasecmp(pair[0], _topology_edgeAttributeToString(EDGE_ATTR_LATENCY))) {
+            /* dijkstra needs positive weights */
+            isValid = value > 0;
+            change->latency = value;
+        } else if(pair[0] && !g_ascii_strcasecmp(pair[0], _topology_edgeAttributeToString(EDGE_ATTR_PACKETLOSS))) {
+            isValid = value >= 0 && value <= 1;
+            change->packetLoss = value;
+        } else {
+            isValid = FALSE;
+        }
+
+        if(!isValid) {
+            critical("invalid attribute '%s', expected %s=MILLISECONDS or %s=FRACTION", tokens[i],
+                    _topology_edgeAttributeToString(EDGE_ATTR_LATENCY),
+                    _topology_edgeAttributeToString(EDGE_ATTR_PACKETLOSS));
+            g_strfreev(pair);
+            return FALSE;
+        }
+
+        g_strfreev(pair);
+    }
+
     return TRUE;
 }
 
+static gint _topology_compareChanges(const TopologyChange* a, const TopologyChange* b, gpointer userData) {
+    return a->time < b->time ? -1 : (a->time > b->time ? 1 : 0);
+}
+
+/* gives the edges between the vertices of the change a change slot, so that cached
+ * paths over them can be found when the change is applied */
+static void _topology_assignChangeSlot(Topology* top, TopologyChange* change) {
+    CompiledGraph* cg = top->compiled;
+
+    gint position = _topology_findAdjacency(top, change->srcVertexIndex, change->dstVertexIndex);
+    utility_assert(position >= 0);
+
+    gint slot = cg->adjChangeSlots[position];
+    if(slot < 0) {
+        slot = cg->changeSlotCount++;
+        g_ptr_array_add(top->changeSlotPaths, g_hash_table_new(g_direct_hash, g_direct_equal));
+    }
+
+    for(gint pass = 0; pass < (top->isDirected ? 1 : 2); pass++) {
+        gint fromVertexIndex = pass == 0 ? change->srcVertexIndex : change->dstVertexIndex;
+        gint toVertexIndex = pass == 0 ? change->dstVertexIndex : change->srcVertexIndex;
+
+        for(position = _topology_findAdjacency(top, fromVertexIndex, toVertexIndex);
+                position >= 0 && position < cg->rowOffsets[fromVertexIndex + 1] &&
+                cg->adjTargets[position] == toVertexIndex; position++) {
+            cg->adjChangeSlots[position] = slot;
+        }
+    }
+}
+
+static gboolean _topology_loadChanges(Topology* top, const gchar* changesPath) {
+    MAGIC_ASSERT(top);
+
+    gchar* contents = NULL;
+    GError* error = NULL;
+    if(!g_file_get_contents(changesPath, &contents, NULL, &error)) {
+        critical("unable to read topology changes file '%s': %s", changesPath, error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+
+    /* id->vertex index (stored as pointer) */
+    GHashTable* vertexIDs = g_hash_table_new(g_str_hash, g_str_equal);
+    for(gint vertexIndex = 0; vertexIndex < top->compiled->vertexCount; vertexIndex++) {
+        g_hash_table_replace(vertexIDs, (gpointer)top->compiled->vertexIDs[vertexIndex],
+                GINT_TO_POINTER(vertexIndex));
+    }
+
+    top->changes = g_queue_new();
+    top->changeSlotPaths = g_ptr_array_new_with_free_func((GDestroyNotify)g_hash_table_destroy);
+
+    gboolean isSuccess = TRUE;
+    gchar** lines = g_strsplit(contents, "\n", -1);
+
+    for(gint lineIndex = 0; isSuccess && lines[lineIndex] != NULL; lineIndex++) {
+        gchar* line = g_strstrip(lines[lineIndex]);
+        if(line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+
+        /* split on any amount of whitespace */
+        gchar** parts = g_strsplit_set(line, " \t", -1);
+        GPtrArray* tokens = g_ptr_array_new();
+        for(gint i = 0; parts[i] != NULL; i++) {
+            if(parts[i][0] != '\0') {
+                g_ptr_array_add(tokens, parts[i]);
+            }
+        }
+        g_ptr_array_add(tokens, NULL);
+
+        TopologyChange* change = g_new0(TopologyChange, 1);
+        if(_topology_parseChange(top, vertexIDs, (gchar**)tokens->pdata, change)) {
+            _topology_assignChangeSlot(top, change);
+            g_queue_push_tail(top->changes, change);
+        } else {
+            critical("error on line %i of topology changes file '%s'", lineIndex + 1, changesPath);
+            g_free(change);
+            isSuccess = FALSE;
+        }
+
+        g_ptr_array_free(tokens, TRUE);
+        g_strfreev(parts);
+    }
+
+    g_strfreev(lines);
+    g_hash_table_destroy(vertexIDs);
+    g_free(contents);
+
+    if(isSuccess) {
+        /* the sort is stable, so changes at the same time apply in file order */
+        g_queue_sort(top->changes, (GCompareDataFunc)_topology_compareChanges, NULL);
+        message("loaded %u topology changes affecting %i links from '%s'",
+                g_queue_get_length(top->changes), top->compiled->changeSlotCount, changesPath);
+    }
+
+    return isSuccess;
+}
+
 static gboolean _topology_verticesAreAdjacent(Topology* top, igraph_integer_t srcVertexIndex, igraph_integer_t dstVertexIndex) {
     MAGIC_ASSERT(top);
+    return _topology_findAdjacency(top, srcVertexIndex, dstVertexIndex) >= 0;
+}
 
-    igraph_integer_t edge_id = -1;
-    gint result;
+typedef struct _PathHeapEntry PathHeapEntry;
+struct _PathHeapEntry {
+    gdouble distance;
+    gint vertexIndex;
+};
 
-    _topology_lockGraph(top);
-    result = _topology_getEdgeHelper(top, srcVertexIndex, dstVertexIndex, &edge_id, NULL, NULL);
-    _topology_unlockGraph(top);
+static void _topology_pathHeapPush(GArray* heap, gdouble distance, gint vertexIndex) {
+    PathHeapEntry entry = {.distance = distance, .vertexIndex = vertexIndex};
+    g_array_append_val(heap, entry);
+
+    /* sift up */
+    PathHeapEntry* entries = (PathHeapEntry*)heap->data;
+    guint position = heap->len - 1;
+    while(position > 0) {
+        guint parent = (position - 1) / 2;
+        if(entries[parent].distance <= entry.distance) {
+            break;
+        }
+        entries[position] = entries[parent];
+        position = parent;
+    }
+    entries[position] = entry;
+}
 
-    if (result != IGRAPH_SUCCESS) {
-        warning("Unable to determine whether or not an edge exists between vertexes %d and %d",
-                srcVertexIndex, dstVertexIndex);
-        return FALSE;
+static PathHeapEntry _topology_pathHeapPop(GArray* heap) {
+    utility_assert(heap->len > 0);
+    PathHeapEntry* entries = (PathHeapEntry*)heap->data;
+    PathHeapEntry first = entries[0];
+    PathHeapEntry last = entries[heap->len - 1];
+    g_array_set_size(heap, heap->len - 1);
+
+    /* sift down */
+    guint length = heap->len;
+    guint position = 0;
+    while(length > 0) {
+        guint child = (2 * position) + 1;
+        if(child >= length) {
+            break;
+        }
+        if(child + 1 < length && entries[child + 1].distance < entries[child].distance) {
+            child++;
+        }
+        if(last.distance <= entries[child].distance) {
+            break;
+        }
+        entries[position] = entries[child];
+        position = child;
+    }
+    if(length > 0) {
+        entries[position] = last;
     }
-    return edge_id >= 0;
+
+    return first;
+}
+
+/* runs dijkstra on the compiled graph from srcVertexIndex, using edge latency as the weight,
+ * and stops once all vertices marked in isTarget are settled. for each reached vertex,
+ * hopsOut holds the position of the adjacency used to reach it and predecessorsOut holds
+ * the vertex it was reached from; both are -1 for the source and unreached vertices.
+ * this only reads the compiled graph, so any number of threads may run it at once. */
+static void _topology_runDijkstra(Topology* top, igraph_integer_t srcVertexIndex,
+        const gboolean* isTarget, guint numTargets, gdouble* distancesOut,
+        gint* hopsOut, gint* predecessorsOut) {
+    const CompiledGraph* cg = top->compiled;
+
+    gboolean* isSettled = g_new0(gboolean, cg->vertexCount);
+    for(gint vertexIndex = 0; vertexIndex < cg->vertexCount; vertexIndex++) {
+        distancesOut[vertexIndex] = INFINITY;
+        hopsOut[vertexIndex] = -1;
+        predecessorsOut[vertexIndex] = -1;
+    }
+
+    GArray* heap = g_array_new(FALSE, FALSE, sizeof(PathHeapEntry));
+    distancesOut[srcVertexIndex] = 0;
+    _topology_pathHeapPush(heap, 0, (gint)srcVertexIndex);
+
+    guint numTargetsRemaining = numTargets;
+
+    while(heap->len > 0 && numTargetsRemaining > 0) {
+        PathHeapEntry entry = _topology_pathHeapPop(heap);
+        gint fromVertexIndex = entry.vertexIndex;
+
+        /* skip stale heap entries */
+        if(isSettled[fromVertexIndex]) {
+            continue;
+        }
+        isSettled[fromVertexIndex] = TRUE;
+        if(isTarget[fromVertexIndex]) {
+            numTargetsRemaining--;
+        }
+
+        for(gint position = cg->rowOffsets[fromVertexIndex];
+                position < cg->rowOffsets[fromVertexIndex + 1]; position++) {
+            gint toVertexIndex = cg->adjTargets[position];
+            gdouble distance = entry.distance + cg->adjLatency[position];
+
+            if(!isSettled[toVertexIndex] && distance < distancesOut[toVertexIndex]) {
+                distancesOut[toVertexIndex] = distance;
+                hopsOut[toVertexIndex] = position;
+                predecessorsOut[toVertexIndex] = fromVertexIndex;
+                _topology_pathHeapPush(heap, distance, toVertexIndex);
+            }
+        }
+    }
+
+    g_array_free(heap, TRUE);
+    g_free(isSettled);
 }
 
 static void _topology_clearCache(Topology* top) {
@@ -1335,9 +1905,12 @@ static gboolean _topology_shouldStorePath(Topology* top, gboolean isDirectPath,
     return TRUE;
 }
 
+/* pathHops holds the positions of the compiled graph adjacencies the path traverses,
+ * which we need to know in order to invalidate the path when one of them changes */
 static void _topology_storePathInCache(Topology* top, gboolean isDirectPath,
         igraph_integer_t srcVertexIndex, igraph_integer_t dstVertexIndex,
-        igraph_real_t totalLatency, igraph_real_t totalReliability) {
+        igraph_real_t totalLatency, igraph_real_t totalReliability,
+        const gint* pathHops, gint numHops) {
     MAGIC_ASSERT(top);
 
     /* make sure we don't store a non-direct path if we want a direct one and it exists */
@@ -1371,6 +1944,17 @@ static void _topology_storePathInCache(Topology* top, gboolean isDirectPath,
      * because we can check both directions for this cached path later. */
     g_hash_table_replace(srcCache, GINT_TO_POINTER(dstVertexIndex), path);
 
+    /* remember which of the edges with scheduled changes this path depends on */
+    if(top->changeSlotPaths) {
+        for(gint i = 0; i < numHops; i++) {
+            gint slot = top->compiled->adjChangeSlots[pathHops[i]];
+            if(slot >= 0) {
+                g_hash_table_add(g_ptr_array_index(top->changeSlotPaths, slot),
+                        TOPOLOGY_PATH_KEY(srcVertexIndex, dstVertexIndex));
+            }
+        }
+    }
+
     /* track the minimum network latency in the entire graph */
     if(top->minimumPathLatency == 0 || latencyMS < top->minimumPathLatency) {
         top->minimumPathLatency = latencyMS;
@@ -1405,16 +1989,16 @@ static igraph_integer_t _topology_getConnectedVertexIndex(Topology* top, Address
 }
 
 static gboolean _topology_computePathProperties(Topology* top, igraph_integer_t srcVertexIndex,
-        igraph_vector_t* resultPathVertices, GString* pathStringBuffer,
+        const gint* pathHops, gint numHops, GString* pathStringBuffer,
         igraph_real_t* pathLatencyOut, igraph_real_t* pathReliabilityOut, igraph_integer_t* pathTargetIndexOut) {
     MAGIC_ASSERT(top);
 
-    /* WARNING This function should only be called when there are more than 0 result paths, ie,
+    /* WARNING This function should only be called when there is at least one hop, ie,
      * when the src and dst are not attached to the same vertex.
      *
-     * each position represents a single destination.
-     * this resultPathVertices vector holds the links that form the shortest path to this destination.
-     * the destination vertex is the last vertex in the vector.
+     * pathHops holds the positions of the compiled graph adjacencies that form the
+     * shortest path to this destination, in order from the source.
+     * the destination vertex is the target of the last hop.
      *
      * there are multiple chances to drop a packet here:
      * psrc : loss rate from source vertex
@@ -1425,74 +2009,28 @@ static gboolean _topology_computePathProperties(Topology* top, igraph_integer_t
      * that its not dropped in each case:
      * P = ((1-psrc)(1-plink)...(1-pdst))
      */
-    gint result = 0;
+    const CompiledGraph* cg = top->compiled;
+    utility_assert(numHops > 0);
+
     igraph_real_t totalLatency = 0.0;
     igraph_real_t totalReliability = (igraph_real_t) 1;
 
-    igraph_integer_t targetVertexIndex = (igraph_integer_t) -1;
-    const gchar* dstIDStr = NULL;
-    const gchar* srcIDStr = NULL;
-
-    glong nVertices = igraph_vector_size(resultPathVertices);
-    utility_assert(nVertices > 0);
-
-    _topology_lockGraph(top);
-
     /* get source properties */
-    gdouble sourcePacketLoss;
-    if(_topology_findVertexAttributeDouble(top, srcVertexIndex, VERTEX_ATTR_PACKETLOSS, &sourcePacketLoss)) {
-        totalReliability *= (1.0f - sourcePacketLoss);
-    }
-
-    gboolean found = _topology_findVertexAttributeString(top, srcVertexIndex, VERTEX_ATTR_ID, &srcIDStr);
-    utility_assert(found);
-    g_string_printf(pathStringBuffer, "%s", srcIDStr);
+    totalReliability *= (1.0f - cg->vertexPacketLoss[srcVertexIndex]);
+    g_string_printf(pathStringBuffer, "%s", _topology_getVertexID(top, srcVertexIndex));
 
     /* get destination properties */
-    targetVertexIndex = (igraph_integer_t) igraph_vector_tail(resultPathVertices);
-    found = _topology_findVertexAttributeString(top, targetVertexIndex, VERTEX_ATTR_ID, &dstIDStr);
-    utility_assert(found);
-
-    /* only include dst loss if there is no path between src and dst vertices */
-    if((srcVertexIndex != targetVertexIndex) || (srcVertexIndex == targetVertexIndex && nVertices > 2)) {
-        gdouble destPacketLoss;
-        if(_topology_findVertexAttributeDouble(top, targetVertexIndex, VERTEX_ATTR_PACKETLOSS, &destPacketLoss)) {
-            totalReliability *= (1.0f - destPacketLoss);
-        }
-    }
-
-    /* the source is in the first position only if we have more than one vertex */
-    if(nVertices > 1) {
-        utility_assert(srcVertexIndex == igraph_vector_e(resultPathVertices, 0));
-    }
-
-    /* if we have only one vertex, its the destination at position 0; otherwise, the source is
-     * at position 0 and the part of the path after the source starts at position 1 */
-    gint startingPosition = nVertices == 1 ? 0 : 1;
-
-    igraph_integer_t fromVertexIndex = srcVertexIndex, toVertexIndex = 0,  edgeIndex = 0;
-    const gchar* fromIDStr = srcIDStr;
+    igraph_integer_t targetVertexIndex = (igraph_integer_t) cg->adjTargets[pathHops[numHops - 1]];
+    utility_assert(srcVertexIndex != targetVertexIndex);
+    totalReliability *= (1.0f - cg->vertexPacketLoss[targetVertexIndex]);
 
     /* now iterate to get latency and reliability from each edge in the path */
-    for (gint i = startingPosition; i < nVertices; i++) {
-        /* get the edge */
-        toVertexIndex = igraph_vector_e(resultPathVertices, i);
-
-        const gchar* toIDStr;
-        gboolean found = _topology_findVertexAttributeString(top, toVertexIndex, VERTEX_ATTR_ID, &toIDStr);
-        utility_assert(found);
-
-        igraph_real_t edgeLatency = 0, edgeReliability = 0;
-        igraph_integer_t edgeIndex = 0;
+    for (gint i = 0; i < numHops; i++) {
+        gint position = pathHops[i];
+        utility_assert(position >= 0 && position < cg->adjacencyCount);
 
-        result = _topology_getEdgeHelper(top, fromVertexIndex, toVertexIndex, &edgeIndex, &edgeLatency, &edgeReliability);
-
-        if(result != IGRAPH_SUCCESS || edgeIndex < 0) {
-            _topology_unlockGraph(top);
-            critical("igraph_get_eid return non-success code %i for edge between "
-                     "%s (%i) and %s (%i)", result, fromIDStr, (gint) fromVertexIndex, toIDStr, (gint) toVertexIndex);
-            return FALSE;
-        }
+        igraph_real_t edgeLatency = cg->adjLatency[position];
+        igraph_real_t edgeReliability = cg->adjReliability[position];
 
         /* accumulate path attributes */
         totalLatency += edgeLatency;
@@ -1500,15 +2038,10 @@ static gboolean _topology_computePathProperties(Topology* top, igraph_integer_t
 
         /* accumulate path information */
         g_string_append_printf(pathStringBuffer, "%s[%f,%f]-->%s",
-                top->isDirected ? "--" : "<--", edgeLatency, 1.0f-edgeReliability, toIDStr);
-
-        /* update for next edge */
-        fromVertexIndex = toVertexIndex;
-        fromIDStr = toIDStr;
+                top->isDirected ? "--" : "<--", edgeLatency, 1.0f-edgeReliability,
+                _topology_getVertexID(top, cg->adjTargets[position]));
     }
 
-    _topology_unlockGraph(top);
-
     if(pathLatencyOut) {
         *pathLatencyOut = totalLatency;
     }
@@ -1545,96 +2078,42 @@ static GQueue* _topology_getUniqueVertexTargets(Topology* top) {
 static gboolean _topology_computeShortestPathToSelf(Topology* top, igraph_integer_t vertexIndex, const gchar* idStr) {
     MAGIC_ASSERT(top);
 
+    const CompiledGraph* cg = top->compiled;
     igraph_real_t minLatency = 0.0f;
     igraph_real_t reliabilityOfMinLatencyEdge = 0.0f;
-    igraph_integer_t indexOfMinLatencyEdge = 0;
-    gint result = 0;
-    gboolean found = FALSE;
-
-    /* iterate over all outgoing edges from vertex, get the shortest, and use it twice */
-    _topology_lockGraph(top);
-
-    /* first we 'select' the incident edges, that is, those to which vertexIndex is connected */
-    igraph_es_t edgeSelector;
-    result = igraph_es_incident(&edgeSelector, vertexIndex, IGRAPH_OUT);
-
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_es_incident return non-success code %i", result);
-        _topology_unlockGraph(top);
-        return FALSE;
-    }
-
-    /* now we set up an iterator on these edges */
-    igraph_eit_t edgeIterator;
-    result = igraph_eit_create(&top->graph, edgeSelector, &edgeIterator);
-
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_eit_create return non-success code %i", result);
-        igraph_es_destroy(&edgeSelector);
-        _topology_unlockGraph(top);
-        return FALSE;
-    }
+    gint positionOfMinLatencyEdge = -1;
 
     /* time the shortest path loop */
     GTimer* pathTimer = g_timer_new();
 
-    /* keep the min latency and packetloss while iterating */
-    while (!IGRAPH_EIT_END(edgeIterator)) {
-        igraph_integer_t edgeIndex = IGRAPH_EIT_GET(edgeIterator);
-
-        igraph_real_t edgeLatency = 0.0f;
-        igraph_real_t edgePacketLoss = 0.0f;
-
-        /* latency and packet loss are required attributes on edges */
-        found = _topology_findEdgeAttributeDouble(top, edgeIndex, EDGE_ATTR_LATENCY, &edgeLatency);
-        utility_assert(found);
+    /* iterate over all outgoing edges from vertex, get the shortest, and use it twice */
+    for(gint position = cg->rowOffsets[vertexIndex]; position < cg->rowOffsets[vertexIndex + 1]; position++) {
+        igraph_real_t edgeLatency = cg->adjLatency[position];
 
-        if(minLatency == 0 || edgeLatency < minLatency) {
+        if(positionOfMinLatencyEdge < 0 || minLatency == 0 || edgeLatency < minLatency) {
             minLatency = edgeLatency;
-
-            found = _topology_findEdgeAttributeDouble(top, edgeIndex, EDGE_ATTR_PACKETLOSS, &edgePacketLoss);
-            utility_assert(found);
-            reliabilityOfMinLatencyEdge = 1.0f - edgePacketLoss;
-
-            indexOfMinLatencyEdge = edgeIndex;
+            reliabilityOfMinLatencyEdge = cg->adjReliability[position];
+            positionOfMinLatencyEdge = position;
         }
-
-        IGRAPH_EIT_NEXT(edgeIterator);
     }
 
-    _topology_unlockGraph(top);
-
     /* track the time spent running the algorithm */
     gdouble elapsedSeconds = g_timer_elapsed(pathTimer, NULL);
     g_timer_destroy(pathTimer);
 
-    igraph_eit_destroy(&edgeIterator);
-    igraph_es_destroy(&edgeSelector);
-
     g_mutex_lock(&top->topologyLock);
     top->selfPathTotalTime += elapsedSeconds;
     top->selfPathCount++;
     g_mutex_unlock(&top->topologyLock);
 
-    _topology_lockGraph(top);
-
-    /* get the other vertex that we chose */
-    igraph_integer_t fromVertexIndex, toVertexIndex;
-    result = igraph_edge(&top->graph, indexOfMinLatencyEdge, &fromVertexIndex, &toVertexIndex);
-
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_edge return non-success code %i", result);
-        _topology_unlockGraph(top);
+    if(positionOfMinLatencyEdge < 0) {
+        critical("vertex %li (%s) has no outgoing edges, unable to compute a path back to self",
+                (glong)vertexIndex, idStr);
         return FALSE;
     }
 
-    /* figure out which index is the other side of the edge */
-    igraph_integer_t targetIndex = (fromVertexIndex == vertexIndex) ? toVertexIndex : fromVertexIndex;
-    const gchar* targetIDStr;
-    found = _topology_findVertexAttributeString(top, targetIndex, VERTEX_ATTR_ID, &targetIDStr);
-    utility_assert(found);
-
-    _topology_unlockGraph(top);
+    /* the other side of the edge that we chose */
+    const gchar* targetIDStr = _topology_getVertexID(top, cg->adjTargets[positionOfMinLatencyEdge]);
 
     /* this edge will be used "twice" to get back to source */
     igraph_real_t latency = 2.0f * minLatency;
@@ -1647,7 +2126,8 @@ static gboolean _topology_computeShortestPathToSelf(Topology* top, igraph_intege
             targetIDStr, top->isDirected ? "" : "<", minLatency, 1.0f-reliabilityOfMinLatencyEdge, idStr);
 
     /* cache the latency and reliability we just computed */
-    _topology_storePathInCache(top, FALSE, vertexIndex, vertexIndex, latency, reliability);
+    _topology_storePathInCache(top, FALSE, vertexIndex, vertexIndex, latency, reliability,
+            &positionOfMinLatencyEdge, 1);
 
     return TRUE;
 }
@@ -1658,15 +2138,9 @@ static gboolean _topology_computeSourcePaths(Topology* top, igraph_integer_t src
     utility_assert(srcVertexIndex >= 0);
     utility_assert(dstVertexIndex >= 0);
 
-    gboolean found;
-    _topology_lockGraph(top);
-    const gchar* srcIDStr;
-    found = _topology_findVertexAttributeString(top, srcVertexIndex, VERTEX_ATTR_ID, &srcIDStr);
-    utility_assert(found);
-    const gchar* dstIDStr;
-    found = _topology_findVertexAttributeString(top, dstVertexIndex, VERTEX_ATTR_ID, &dstIDStr);
-    utility_assert(found);
-    _topology_unlockGraph(top);
+    const CompiledGraph* cg = top->compiled;
+    const gchar* srcIDStr = _topology_getVertexID(top, srcVertexIndex);
+    const gchar* dstIDStr = _topology_getVertexID(top, dstVertexIndex);
 
     info("requested path between source vertex %li (%s) and destination vertex %li (%s)",
             (glong)srcVertexIndex, srcIDStr, (glong)dstVertexIndex, dstIDStr);
@@ -1684,102 +2158,56 @@ static gboolean _topology_computeSourcePaths(Topology* top, igraph_integer_t src
      * hash table stores vertex indices in pointers, this should be OK. */
     guint numTargets = g_queue_get_length(attachedTargets);
 
-    /* initialize vector to hold intended destinations */
-    igraph_vector_t dstVertexIndexSet;
-
-    gint result = igraph_vector_init(&dstVertexIndexSet, (long int) numTargets);
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_vector_init return non-success code %i", result);
-        return FALSE;
-    }
-
-    /* initialize our result vector where the resulting paths will be stored */
-    igraph_vector_ptr_t resultPaths;
-    result = igraph_vector_ptr_init(&resultPaths, (long int) numTargets);
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_vector_ptr_init return non-success code %i", result);
-        return FALSE;
-    }
+    gint* targets = g_new0(gint, MAX(1, numTargets));
+    gboolean* isTarget = g_new0(gboolean, cg->vertexCount);
 
     gboolean foundDstVertexIndex = FALSE;
-    gint dstVertexIndexPosition = -1;
-    for(gint position = 0; position < numTargets; position++) {
+    guint numAttachedTargets = numTargets;
+    numTargets = 0;
+    for(guint i = 0; i < numAttachedTargets; i++) {
         gpointer vertexIndexPointer = g_queue_pop_head(attachedTargets);
-        utility_assert(vertexIndexPointer != NULL);
 
-        /* set each vertex index as a destination for dijkstra */
+        /* we only need one destination for each class of equivalent vertices */
+        igraph_integer_t keySrcVertexIndex = srcVertexIndex;
         igraph_integer_t vertexIndex = (igraph_integer_t) GPOINTER_TO_INT(vertexIndexPointer);
-        igraph_vector_set(&dstVertexIndexSet, position, (igraph_real_t) vertexIndex);
-        utility_assert(vertexIndex == igraph_vector_e(&dstVertexIndexSet, position));
+        _topology_getPathKey(top, &keySrcVertexIndex, &vertexIndex);
+        utility_assert(vertexIndex >= 0 && vertexIndex < cg->vertexCount);
 
-        if(vertexIndex == dstVertexIndex) {
-            foundDstVertexIndex = TRUE;
-            dstVertexIndexPosition = position;
+        /* paths back to self are handled in _topology_computeShortestPathToSelf */
+        if(keySrcVertexIndex == vertexIndex) {
+            continue;
         }
 
-        /* initialize a vector to hold the result path vertices for this target */
-        igraph_vector_t* resultPathVertices = g_new0(igraph_vector_t, 1);
-
-        /* initialize with 0 entries, since we dont know how long the paths with be */
-        result = igraph_vector_init(resultPathVertices, 0);
-        if(result != IGRAPH_SUCCESS) {
-            critical("igraph_vector_init return non-success code %i", result);
-            return FALSE;
+        /* set each vertex index as a destination for dijkstra */
+        if(!isTarget[vertexIndex]) {
+            targets[numTargets++] = (gint)vertexIndex;
+            isTarget[vertexIndex] = TRUE;
         }
 
-        /* assign our element to the result vector */
-        igraph_vector_ptr_set(&resultPaths, position, resultPathVertices);
-        utility_assert(resultPathVertices == igraph_vector_ptr_e(&resultPaths, position));
-    }
-
-    if(attachedTargets) {
-        g_queue_free(attachedTargets);
-        attachedTargets = NULL;
+        if(vertexIndex == dstVertexIndex) {
+            foundDstVertexIndex = TRUE;
+        }
     }
 
-    utility_assert(numTargets == igraph_vector_size(&dstVertexIndexSet));
-    utility_assert(numTargets == igraph_vector_ptr_size(&resultPaths));
+    g_queue_free(attachedTargets);
     utility_assert(foundDstVertexIndex == TRUE);
 
-    info("computing shortest paths from source vertex %li (%s) to all %u vertices with connected hosts",
+    info("computing shortest paths from source vertex %li (%s) to all %u vertex classes with connected hosts",
             (glong)srcVertexIndex, srcIDStr, numTargets);
 
-    _topology_lockGraph(top);
-    g_rw_lock_reader_lock(&(top->edgeWeightsLock));
+    gdouble* distances = g_new(gdouble, cg->vertexCount);
+    gint* hops = g_new(gint, cg->vertexCount);
+    gint* predecessors = g_new(gint, cg->vertexCount);
 
     /* time the dijkstra algorithm */
     GTimer* pathTimer = g_timer_new();
 
-    /* run dijkstra's shortest path algorithm */
-#if defined (IGRAPH_VERSION_MAJOR) && defined (IGRAPH_VERSION_MINOR) && defined (IGRAPH_VERSION_PATCH)
-#if ((IGRAPH_VERSION_MAJOR == 0 && IGRAPH_VERSION_MINOR >= 7) || IGRAPH_VERSION_MAJOR > 0)
-    result = igraph_get_shortest_paths_dijkstra(&top->graph, &resultPaths, NULL,
-            srcVertexIndex, igraph_vss_vector(&dstVertexIndexSet), top->edgeWeights, IGRAPH_OUT, NULL, NULL);
-#else
-    result = igraph_get_shortest_paths_dijkstra(&top->graph, &resultPaths, NULL,
-                srcVertexIndex, igraph_vss_vector(&dstVertexIndexSet), top->edgeWeights, IGRAPH_OUT);
-#endif
-#else
-#if defined (IGRAPH_VERSION)
-#if defined (IGRAPH_VERSION_MAJOR_GUESS) && defined (IGRAPH_VERSION_MINOR_GUESS) && ((IGRAPH_VERSION_MAJOR_GUESS == 0 && IGRAPH_VERSION_MINOR_GUESS >= 7) || IGRAPH_VERSION_MAJOR_GUESS > 0)
-    result = igraph_get_shortest_paths_dijkstra(&top->graph, &resultPaths, NULL,
-                srcVertexIndex, igraph_vss_vector(&dstVertexIndexSet), top->edgeWeights, IGRAPH_OUT, NULL, NULL);
-#else
-    result = igraph_get_shortest_paths_dijkstra(&top->graph, &resultPaths, NULL,
-                srcVertexIndex, igraph_vss_vector(&dstVertexIndexSet), top->edgeWeights, IGRAPH_OUT);
-#endif
-#else
-    result = igraph_get_shortest_paths_dijkstra(&top->graph, &resultPaths,
-            srcVertexIndex, igraph_vss_vector(&dstVertexIndexSet), top->edgeWeights, IGRAPH_OUT);
-#endif
-#endif
+    /* run dijkstra's shortest path algorithm. the compiled graph is immutable, so
+     * workers that miss the cache at the same time do not wait for each other here. */
+    _topology_runDijkstra(top, srcVertexIndex, isTarget, numTargets, distances, hops, predecessors);
 
     /* track the time spent running the algorithm */
     gdouble elapsedSeconds = g_timer_elapsed(pathTimer, NULL);
-
-    g_rw_lock_reader_unlock(&(top->edgeWeightsLock));
-    _topology_unlockGraph(top);
-
     g_timer_destroy(pathTimer);
 
     g_mutex_lock(&top->topologyLock);
@@ -1787,87 +2215,98 @@ static gboolean _topology_computeSourcePaths(Topology* top, igraph_integer_t src
     top->shortestPathCount++;
     g_mutex_unlock(&top->topologyLock);
 
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_get_shortest_paths_dijkstra return non-success code %i", result);
-        return FALSE;
-    }
-
-    /* sanity checks */
-    utility_assert(numTargets == igraph_vector_size(&dstVertexIndexSet));
-    utility_assert(numTargets == igraph_vector_ptr_size(&resultPaths));
-
     /* process the results */
     gboolean isAllSuccess = TRUE;
     gboolean foundDstPosition = FALSE;
     GString* pathStringBuffer = g_string_new(NULL);
+    gint* pathHops = g_new(gint, cg->vertexCount);
 
     /* go through the result paths for all targets */
-    for(gint position = 0; position < numTargets; position++) {
-        /* handle the path to the destination at this position */
-        igraph_vector_t* resultPathVertices = igraph_vector_ptr_e(&resultPaths, position);
-
-        /* check the number of vertices in the result path */
-        glong nVertices = igraph_vector_size(resultPathVertices);
-
-        /* if there are no vertices, then the source and destination hosts are attached to
-         * the same igraph vertex. igraph doesn't give us a shortest path in this case.
-         * so, we handle the other cases here where it does provide paths. */
-        if(nVertices > 0) {
-            igraph_integer_t pathTargetIndex = 0;
-            igraph_real_t pathLatency = 0.0f, pathReliability = 0.0f;
-
-            gboolean isSuccess = _topology_computePathProperties(top, srcVertexIndex, resultPathVertices,
-                    pathStringBuffer, &pathLatency, &pathReliability, &pathTargetIndex);
-
-            if(isSuccess) {
-                const gchar* targetIDStr;
-                _topology_lockGraph(top);
-                found = _topology_findVertexAttributeString(top, pathTargetIndex, VERTEX_ATTR_ID, &targetIDStr);
-                utility_assert(found);
-                _topology_unlockGraph(top);
-
-                GString* logMessage = g_string_new(NULL);
-
-                g_string_printf(logMessage, "shortest path %s%s%s (%i%s%i) is %f ms with %f loss, path: %s",
-                                    srcIDStr, top->isDirected ? "-->" : "<-->", targetIDStr,
-                                    (gint) srcVertexIndex, top->isDirected ? "-->" : "<-->", (gint) pathTargetIndex,
-                                    pathLatency, 1-pathReliability, pathStringBuffer->str);
-
-                /* make sure at least one of the targets is the destination.
-                 * the case where src and dest are the same are handled in _topology_computePathToSelf */
-                if(dstVertexIndexPosition == position) {
-                    utility_assert(dstVertexIndex == pathTargetIndex);
-                    foundDstPosition = TRUE;
-                    info("%s", logMessage->str);
-                } else {
-                    debug("%s", logMessage->str);
-                }
-
-                g_string_free(logMessage, TRUE);
-
-                if(pathLatency == 0) {
-                    warning("found shortest path latency of 0 ms between source %s (%i) and destination %s (%i), using 1 ms instead",
-                            srcIDStr, srcVertexIndex, targetIDStr, pathTargetIndex);
-                    pathLatency = 1;
-                }
-
-                /* cache the latency and reliability we just computed */
-                _topology_storePathInCache(top, FALSE, srcVertexIndex, pathTargetIndex, pathLatency, pathReliability);
+    for(guint position = 0; position < numTargets; position++) {
+        gint targetVertexIndex = targets[position];
+
+        /* if the source and destination hosts are attached to the same vertex, then
+         * there is no path to walk here. that case is handled in
+         * _topology_computeShortestPathToSelf. */
+        if(targetVertexIndex == srcVertexIndex) {
+            continue;
+        }
+
+        if(hops[targetVertexIndex] < 0) {
+            warning("vertex %i (%s) is unreachable from source vertex %i (%s)",
+                    targetVertexIndex, _topology_getVertexID(top, targetVertexIndex),
+                    (gint)srcVertexIndex, srcIDStr);
+            continue;
+        }
+
+        /* walk the predecessors back to the source, then put the hops in path order */
+        gint numHops = 0;
+        for(gint vertexIndex = targetVertexIndex; vertexIndex != srcVertexIndex;
+                vertexIndex = predecessors[vertexIndex]) {
+            utility_assert(numHops < cg->vertexCount);
+            pathHops[numHops++] = hops[vertexIndex];
+        }
+        for(gint i = 0; i < numHops / 2; i++) {
+            gint tmp = pathHops[i];
+            pathHops[i] = pathHops[numHops - 1 - i];
+            pathHops[numHops - 1 - i] = tmp;
+        }
+
+        igraph_integer_t pathTargetIndex = 0;
+        igraph_real_t pathLatency = 0.0f, pathReliability = 0.0f;
+
+        gboolean isSuccess = _topology_computePathProperties(top, srcVertexIndex, pathHops, numHops,
+                pathStringBuffer, &pathLatency, &pathReliability, &pathTargetIndex);
+
+        if(isSuccess) {
+            const gchar* targetIDStr = _topology_getVertexID(top, pathTargetIndex);
+
+            GString* logMessage = g_string_new(NULL);
+
+            g_string_printf(logMessage, "shortest path %s%s%s (%i%s%i) is %f ms with %f loss, path: %s",
+                                srcIDStr, top->isDirected ? "-->" : "<-->", targetIDStr,
+                                (gint) srcVertexIndex, top->isDirected ? "-->" : "<-->", (gint) pathTargetIndex,
+                                pathLatency, 1-pathReliability, pathStringBuffer->str);
+
+            /* make sure at least one of the targets is the destination.
+             * the case where src and dest are the same are handled in _topology_computePathToSelf */
+            if(targetVertexIndex == dstVertexIndex) {
+                utility_assert(dstVertexIndex == pathTargetIndex);
+                foundDstPosition = TRUE;
+                info("%s", logMessage->str);
             } else {
-                isAllSuccess = FALSE;
+                debug("%s", logMessage->str);
+            }
+
+            g_string_free(logMessage, TRUE);
+
+            if(pathLatency == 0) {
+                warning("found shortest path latency of 0 ms between source %s (%i) and destination %s (%i), using 1 ms instead",
+                        srcIDStr, srcVertexIndex, targetIDStr, pathTargetIndex);
+                pathLatency = 1;
             }
-        }
 
-        /* we are now done with the resultPathVertices vector, clean up */
-        igraph_vector_destroy(resultPathVertices);
-        g_free(resultPathVertices);
+            /* cache the latency and reliability we just computed, under the key of the
+             * vertex classes if this path is shared by equivalent vertices */
+            igraph_integer_t keySrcVertexIndex = srcVertexIndex;
+            igraph_integer_t keyDstVertexIndex = pathTargetIndex;
+            _topology_getPathKey(top, &keySrcVertexIndex, &keyDstVertexIndex);
+            _topology_storePathInCache(top, FALSE, keySrcVertexIndex, keyDstVertexIndex,
+                    pathLatency, pathReliability, pathHops, numHops);
+        } else {
+            isAllSuccess = FALSE;
+        }
     }
 
     utility_assert(foundDstPosition == TRUE);
 
     /* clean up */
-    igraph_vector_ptr_destroy(&resultPaths);
-    igraph_vector_destroy(&dstVertexIndexSet);
+    g_free(pathHops);
+    g_free(predecessors);
+    g_free(hops);
+    g_free(distances);
+    g_free(isTarget);
+    g_free(targets);
     g_string_free(pathStringBuffer, TRUE);
 
     /* success */
@@ -1884,44 +2323,27 @@ static gboolean _topology_lookupDirectPath(Topology* top, igraph_integer_t srcVe
      * see the comment in _topology_computeSourcePathsHelper
      */
 
+    const CompiledGraph* cg = top->compiled;
     igraph_real_t totalLatency = 0.0, totalReliability = 1.0;
-    igraph_real_t edgeLatency = 0.0, edgeReliability = 1.0;
-    gboolean found;
-    const gchar* srcIDStr;
-    const gchar* dstIDStr;
-
-    _topology_lockGraph(top);
-
-    found = _topology_findVertexAttributeString(top, srcVertexIndex, VERTEX_ATTR_ID, &srcIDStr);
-    utility_assert(found);
-    found = _topology_findVertexAttributeString(top, dstVertexIndex, VERTEX_ATTR_ID, &dstIDStr);
-    utility_assert(found);
 
-    gdouble sourcePacketLoss;
-    if(_topology_findVertexAttributeDouble(top, srcVertexIndex, VERTEX_ATTR_PACKETLOSS, &sourcePacketLoss)) {
-        totalReliability *= (1.0f - sourcePacketLoss);
-    }
-    gdouble destPacketLoss;
-    if(_topology_findVertexAttributeDouble(top, dstVertexIndex, VERTEX_ATTR_PACKETLOSS, &destPacketLoss)) {
-        totalReliability *= (1.0f - destPacketLoss);
-    }
+    totalReliability *= (1.0f - cg->vertexPacketLoss[srcVertexIndex]);
+    totalReliability *= (1.0f - cg->vertexPacketLoss[dstVertexIndex]);
 
-    gint result = _topology_getEdgeHelper(top, srcVertexIndex, dstVertexIndex, NULL, &edgeLatency, &edgeReliability);
+    gint position = _topology_findAdjacency(top, srcVertexIndex, dstVertexIndex);
 
-    if(result != IGRAPH_SUCCESS) {
-        critical("igraph_get_eid return non-success code %i for edge between "
-                 "%s (%i) and %s (%i)", result, srcIDStr, (gint) srcVertexIndex, dstIDStr, (gint) dstVertexIndex);
-        _topology_unlockGraph(top);
+    if(position < 0) {
+        critical("no edge exists between %s (%i) and %s (%i)",
+                _topology_getVertexID(top, srcVertexIndex), (gint) srcVertexIndex,
+                _topology_getVertexID(top, dstVertexIndex), (gint) dstVertexIndex);
         return FALSE;
     }
 
-    _topology_unlockGraph(top);
-
-    totalLatency += edgeLatency;
-    totalReliability *= edgeReliability;
+    totalLatency += cg->adjLatency[position];
+    totalReliability *= cg->adjReliability[position];
 
     /* cache the latency and reliability we just computed */
-    _topology_storePathInCache(top, TRUE, srcVertexIndex, dstVertexIndex, totalLatency, totalReliability);
+    _topology_storePathInCache(top, TRUE, srcVertexIndex, dstVertexIndex, totalLatency, totalReliability,
+            &position, 1);
 
     return TRUE;
 }
@@ -1934,20 +2356,10 @@ static void _topology_logAllCachedPathsHelper2(gpointer dstIndexKey, Path* path,
         igraph_integer_t srcVertexIndex = (igraph_integer_t)path_getSrcVertexIndex(path);
         igraph_integer_t dstVertexIndex = (igraph_integer_t)path_getDstVertexIndex(path);
 
-        gboolean found;
-        const gchar* srcIDStr;
-        const gchar* dstIDStr;
-
-        _topology_lockGraph(top);
-        found = _topology_findVertexAttributeString(top, srcVertexIndex, VERTEX_ATTR_ID, &srcIDStr);
-        utility_assert(found);
-        found = _topology_findVertexAttributeString(top, dstVertexIndex, VERTEX_ATTR_ID, &dstIDStr);
-        utility_assert(found);
-        _topology_unlockGraph(top);
-
         /* log this at info level so we don't spam the message level logs */
         info("Found path %s%s%s in cache: %s",
-                srcIDStr, top->isDirected ? "->" : "<->", dstIDStr, pathStr);
+                _topology_getVertexID(top, srcVertexIndex), top->isDirected ? "->" : "<->",
+                _topology_getVertexID(top, dstVertexIndex), pathStr);
 
         g_free(pathStr);
     }
@@ -1966,7 +2378,10 @@ static void _topology_logAllCachedPaths(Topology* top) {
     }
 }
 
-static Path* _topology_getPathEntry(Topology* top, Address* srcAddress, Address* dstAddress) {
+/* if vertexPairOut is not NULL, it is set to the key of the ordered pair of vertices the
+ * addresses are attached to, before they are mapped to the path of their vertex classes */
+static Path* _topology_getPathEntry(Topology* top, Address* srcAddress, Address* dstAddress,
+        gpointer* vertexPairOut) {
     MAGIC_ASSERT(top);
 
     /* get connected points */
@@ -1983,6 +2398,13 @@ static Path* _topology_getPathEntry(Topology* top, Address* srcAddress, Address*
         return FALSE;
     }
 
+    if(vertexPairOut) {
+        *vertexPairOut = TOPOLOGY_PATH_KEY(srcVertexIndex, dstVertexIndex);
+    }
+
+    /* hosts on equivalent vertices share the path of the vertex class */
+    _topology_getPathKey(top, &srcVertexIndex, &dstVertexIndex);
+
     /* check for a cache hit */
     Path* path = _topology_getPathFromCache(top, srcVertexIndex, dstVertexIndex);
     if(!path && !top->isDirected) {
@@ -1993,17 +2415,8 @@ static Path* _topology_getPathEntry(Topology* top, Address* srcAddress, Address*
         /* cache miss, lets find the path */
         gboolean success = FALSE;
 
-        gboolean found;
-        const gchar* srcIDStr;
-        const gchar* dstIDStr;
-
-
-        _topology_lockGraph(top);
-        found = _topology_findVertexAttributeString(top, srcVertexIndex, VERTEX_ATTR_ID, &srcIDStr);
-        utility_assert(found);
-        found = _topology_findVertexAttributeString(top, dstVertexIndex, VERTEX_ATTR_ID, &dstIDStr);
-        utility_assert(found);
-        _topology_unlockGraph(top);
+        const gchar* srcIDStr = _topology_getVertexID(top, srcVertexIndex);
+        const gchar* dstIDStr = _topology_getVertexID(top, dstVertexIndex);
 
         gboolean verticesAreAdjacent = _topology_verticesAreAdjacent(top, srcVertexIndex, dstVertexIndex);
 
@@ -2050,22 +2463,28 @@ static Path* _topology_getPathEntry(Topology* top, Address* srcAddress, Address*
     return path;
 }
 
-void topology_incrementPathPacketCounter(Topology* top, Address* srcAddress, Address* dstAddress) {
+gboolean topology_lookupPath(Topology* top, Address* srcAddress, Address* dstAddress,
+        gdouble* latencyOut, gdouble* reliabilityOut, gpointer* vertexPairOut) {
     MAGIC_ASSERT(top);
 
-    Path* path = _topology_getPathEntry(top, srcAddress, dstAddress);
-    if(path != NULL) {
-        path_incrementPacketCount(path);
-    } else {
-        error("unable to find path between node %s and node %s",
-                address_toString(srcAddress), address_toString(dstAddress));
+    Path* path = _topology_getPathEntry(top, srcAddress, dstAddress, vertexPairOut);
+    if(path == NULL) {
+        return FALSE;
+    }
+
+    if(latencyOut) {
+        *latencyOut = path_getLatency(path);
+    }
+    if(reliabilityOut) {
+        *reliabilityOut = path_getReliability(path);
     }
+    return TRUE;
 }
 
 gdouble topology_getLatency(Topology* top, Address* srcAddress, Address* dstAddress) {
     MAGIC_ASSERT(top);
 
-    Path* path = _topology_getPathEntry(top, srcAddress, dstAddress);
+    Path* path = _topology_getPathEntry(top, srcAddress, dstAddress, NULL);
 
     if(path != NULL) {
         return path_getLatency(path);
@@ -2077,7 +2496,7 @@ gdouble topology_getLatency(Topology* top, Address* srcAddress, Address* dstAddr
 gdouble topology_getReliability(Topology* top, Address* srcAddress, Address* dstAddress) {
     MAGIC_ASSERT(top);
 
-    Path* path = _topology_getPathEntry(top, srcAddress, dstAddress);
+    Path* path = _topology_getPathEntry(top, srcAddress, dstAddress, NULL);
 
     if(path != NULL) {
         return path_getReliability(path);
@@ -2091,6 +2510,193 @@ gboolean topology_isRoutable(Topology* top, Address* srcAddress, Address* dstAdd
     return (topology_getLatency(top, srcAddress, dstAddress) > -1) ? TRUE : FALSE;
 }
 
+static gint _topology_comparePathKeys(gconstpointer a, gconstpointer b) {
+    guint64 keyA = (guint64)*((const gpointer*)a);
+    guint64 keyB = (guint64)*((const gpointer*)b);
+    return keyA < keyB ? -1 : (keyA > keyB ? 1 : 0);
+}
+
+gboolean topology_writeTrafficMatrix(Topology* top, GHashTable* vertexPairPacketCounts,
+        const gchar* filePath) {
+    MAGIC_ASSERT(top);
+    utility_assert(vertexPairPacketCounts);
+
+    /* sort so that the file is the same for the same counts */
+    GList* pathKeys = g_hash_table_get_keys(vertexPairPacketCounts);
+    guint numPairs = g_list_length(pathKeys);
+    gpointer* sortedKeys = g_new(gpointer, MAX(1, numPairs));
+    guint i = 0;
+    for(GList* item = pathKeys; item != NULL; item = g_list_next(item)) {
+        sortedKeys[i++] = item->data;
+    }
+    g_list_free(pathKeys);
+    qsort(sortedKeys, (size_t)numPairs, sizeof(gpointer), _topology_comparePathKeys);
+
+    GString* buffer = g_string_new("# source-vertex destination-vertex packets\n");
+    for(i = 0; i < numPairs; i++) {
+        gpointer pathKey = sortedKeys[i];
+        g_string_append_printf(buffer, "%s %s %"G_GUINT64_FORMAT"\n",
+                _topology_getVertexID(top, TOPOLOGY_PATH_KEY_SRC(pathKey)),
+                _topology_getVertexID(top, TOPOLOGY_PATH_KEY_DST(pathKey)),
+                (guint64)g_hash_table_lookup(vertexPairPacketCounts, pathKey));
+    }
+
+    g_free(sortedKeys);
+
+    GError* error = NULL;
+    gboolean isSuccess = g_file_set_contents(filePath, buffer->str, (gssize)buffer->len, &error);
+    if(!isSuccess) {
+        warning("unable to write traffic matrix to '%s': %s", filePath, error->message);
+        g_error_free(error);
+    }
+
+    g_string_free(buffer, TRUE);
+    return isSuccess;
+}
+
+SimulationTime topology_getNextChangeTime(Topology* top) {
+    MAGIC_ASSERT(top);
+    TopologyChange* change = top->changes ? g_queue_peek_head(top->changes) : NULL;
+    return change ? change->time : SIMTIME_INVALID;
+}
+
+/* the pathCacheLock must be held by the writer */
+static guint _topology_invalidateCachedPath(Topology* top, gpointer pathKey) {
+    if(!top->pathCache) {
+        return 0;
+    }
+
+    GHashTable* srcCache = g_hash_table_lookup(top->pathCache, GINT_TO_POINTER(TOPOLOGY_PATH_KEY_SRC(pathKey)));
+    if(srcCache) {
+        Path* path = g_hash_table_lookup(srcCache, GINT_TO_POINTER(TOPOLOGY_PATH_KEY_DST(pathKey)));
+        if(path) {
+            gchar* pathStr = path_toString(path);
+            debug("invalidating cached path: %s", pathStr);
+            g_free(pathStr);
+
+            /* this frees the path */
+            g_hash_table_remove(srcCache, GINT_TO_POINTER(TOPOLOGY_PATH_KEY_DST(pathKey)));
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static gboolean _topology_isNotDirectPath(gpointer dstIndexKey, Path* path, gpointer userData) {
+    return !path_isDirect(path);
+}
+
+static void _topology_setLinkAttributes(Topology* top, gint fromVertexIndex, gint toVertexIndex,
+        const TopologyChange* change, gboolean* latencyDecreased) {
+    CompiledGraph* cg = top->compiled;
+
+    for(gint position = _topology_findAdjacency(top, fromVertexIndex, toVertexIndex);
+            position >= 0 && position < cg->rowOffsets[fromVertexIndex + 1] &&
+            cg->adjTargets[position] == toVertexIndex; position++) {
+        if(change->latency >= 0) {
+            if(change->latency < cg->adjLatency[position]) {
+                *latencyDecreased = TRUE;
+            }
+            cg->adjLatency[position] = change->latency;
+        }
+        if(change->packetLoss >= 0) {
+            cg->adjReliability[position] = 1.0f - change->packetLoss;
+        }
+    }
+}
+
+static gdouble _topology_getMinimumEdgeLatency(Topology* top) {
+    const CompiledGraph* cg = top->compiled;
+    gdouble minLatency = 0;
+    gboolean found = FALSE;
+
+    for(gint position = 0; position < cg->adjacencyCount; position++) {
+        if(!found || cg->adjLatency[position] < minLatency) {
+            minLatency = cg->adjLatency[position];
+            found = TRUE;
+        }
+    }
+
+    return minLatency;
+}
+
+gboolean topology_applyChanges(Topology* top, SimulationTime now, gdouble* minPathLatencyOut) {
+    MAGIC_ASSERT(top);
+
+    TopologyChange* change = top->changes ? g_queue_peek_head(top->changes) : NULL;
+    if(!change || change->time > now) {
+        return FALSE;
+    }
+
+    guint numChanges = 0;
+    guint numInvalidated = 0;
+    gboolean latencyDecreased = FALSE;
+
+    /* workers are not running, but keep the cache consistent for anyone who might look */
+    g_rw_lock_writer_lock(&(top->pathCacheLock));
+
+    while(change && change->time <= now) {
+        g_queue_pop_head(top->changes);
+
+        /* update the compiled graph in place, both ways for undirected graphs */
+        _topology_setLinkAttributes(top, change->srcVertexIndex,
+                change->dstVertexIndex, change, &latencyDecreased);
+        if(!top->isDirected) {
+            _topology_setLinkAttributes(top, change->dstVertexIndex, change->srcVertexIndex,
+                    change, &latencyDecreased);
+        }
+
+        info("applying topology change at %"G_GUINT64_FORMAT": link %s%s%s latency=%f packetloss=%f",
+                change->time, _topology_getVertexID(top, change->srcVertexIndex),
+                top->isDirected ? "->" : "<->", _topology_getVertexID(top, change->dstVertexIndex),
+                change->latency, change->packetLoss);
+
+        /* only the paths that traverse this link are affected */
+        gint position = _topology_findAdjacency(top, change->srcVertexIndex, change->dstVertexIndex);
+        GHashTable* pathKeys = g_ptr_array_index(top->changeSlotPaths, top->compiled->adjChangeSlots[position]);
+
+        GHashTableIter iter;
+        gpointer pathKey;
+        g_hash_table_iter_init(&iter, pathKeys);
+        while(g_hash_table_iter_next(&iter, &pathKey, NULL)) {
+            numInvalidated += _topology_invalidateCachedPath(top, pathKey);
+        }
+        g_hash_table_remove_all(pathKeys);
+
+        g_free(change);
+        numChanges++;
+        change = g_queue_peek_head(top->changes);
+    }
+
+    /* a faster link may give a shorter route to any path that was not direct */
+    if(latencyDecreased && top->pathCache) {
+        GHashTableIter iter;
+        gpointer srcIndexKey;
+        GHashTable* srcCache;
+        g_hash_table_iter_init(&iter, top->pathCache);
+        while(g_hash_table_iter_next(&iter, &srcIndexKey, (gpointer*)&srcCache)) {
+            numInvalidated += g_hash_table_foreach_remove(srcCache, (GHRFunc)_topology_isNotDirectPath, NULL);
+        }
+    }
+
+    /* every path crosses at least one edge, so the fastest edge in the whole graph bounds
+     * the paths we have and all the ones we may compute later. the cached paths alone
+     * are not enough, since a path computed later over other links can be shorter. */
+    gdouble minPathLatency = _topology_getMinimumEdgeLatency(top);
+    top->minimumPathLatency = minPathLatency;
+
+    g_rw_lock_writer_unlock(&(top->pathCacheLock));
+
+    message("applied %u topology changes at time %"G_GUINT64_FORMAT", invalidated %u cached paths, "
+            "minimum path latency is now %f ms", numChanges, now, numInvalidated, minPathLatency);
+
+    if(minPathLatencyOut) {
+        *minPathLatencyOut = minPathLatency;
+    }
+    return TRUE;
+}
+
 static gboolean _topology_findAttachmentVertexHelperHook(Topology* top, igraph_integer_t vertexIndex, AttachHelper* ah) {
     MAGIC_ASSERT(top);
     utility_assert(ah);
@@ -2461,15 +3067,21 @@ void topology_free(Topology* top) {
     _topology_clearCache(top);
     g_rw_lock_clear(&(top->pathCacheLock));
 
-    /* clear the stored edge weights */
-    g_rw_lock_writer_lock(&(top->edgeWeightsLock));
-    if(top->edgeWeights) {
-        igraph_vector_destroy(top->edgeWeights);
-        g_free(top->edgeWeights);
-        top->edgeWeights = NULL;
+    /* clear the changes that we did not get to */
+    if(top->changes) {
+        g_queue_free_full(top->changes, g_free);
+        top->changes = NULL;
+    }
+    if(top->changeSlotPaths) {
+        g_ptr_array_free(top->changeSlotPaths, TRUE);
+        top->changeSlotPaths = NULL;
+    }
+
+    /* clear the compiled graph, nobody is looking up paths anymore */
+    if(top->compiled) {
+        _topology_freeCompiledGraph(top->compiled);
+        top->compiled = NULL;
     }
-    g_rw_lock_writer_unlock(&(top->edgeWeightsLock));
-    g_rw_lock_clear(&(top->edgeWeightsLock));
 
     /* clear the graph */
     _topology_lockGraph(top);
@@ -2483,7 +3095,7 @@ void topology_free(Topology* top) {
     g_free(top);
 }
 
-Topology* topology_new(const gchar* graphPath) {
+Topology* topology_new(const gchar* graphPath, const gchar* changesPath) {
     utility_assert(graphPath);
     Topology* top = g_new0(Topology, 1);
     MAGIC_INIT(top);
@@ -2493,18 +3105,26 @@ Topology* topology_new(const gchar* graphPath) {
 
     _topology_initGraphLock(&(top->graphLock));
     g_mutex_init(&(top->topologyLock));
-    g_rw_lock_init(&(top->edgeWeightsLock));
     g_rw_lock_init(&(top->virtualIPLock));
     g_rw_lock_init(&(top->pathCacheLock));
 
     /* first read in the graph and make sure its formed correctly,
-     * then setup our edge weights for shortest path */
+     * then compile the representation we use for path lookups */
     if(!_topology_loadGraph(top, graphPath) || !_topology_checkGraph(top) ||
-            !_topology_extractEdgeWeights(top)) {
+            !_topology_compileGraph(top)) {
         topology_free(top);
         critical("we failed to create the simulation topology because we were unable to validate the topology graphml file");
         return NULL;
     }
 
+    /* changes must be known before collapsing vertices, since they break equivalence */
+    if(changesPath && !_topology_loadChanges(top, changesPath)) {
+        topology_free(top);
+        critical("we failed to create the simulation topology because we were unable to load the topology changes");
+        return NULL;
+    }
+
+    _topology_compileVertexClasses(top, top->compiled);
+
     return top;
 }
@@ -9,12 +9,13 @@
 
 #include <glib.h>
 
+#include "main/core/support/definitions.h"
 #include "main/routing/address.h"
 #include "main/utility/random.h"
 
 typedef struct _Topology Topology;
 
-Topology* topology_new(const gchar* graphPath);
+Topology* topology_new(const gchar* graphPath, const gchar* changesPath);
 void topology_free(Topology* top);
 
 void topology_attach(Topology* top, Address* address, Random* randomSourcePool,
@@ -25,6 +26,26 @@ void topology_detach(Topology* top, Address* address);
 gboolean topology_isRoutable(Topology* top, Address* srcAddress, Address* dstAddress);
 gdouble topology_getLatency(Topology* top, Address* srcAddress, Address* dstAddress);
 gdouble topology_getReliability(Topology* top, Address* srcAddress, Address* dstAddress);
-void topology_incrementPathPacketCounter(Topology* top, Address* srcAddress, Address* dstAddress);
+
+/* looks up the path between the addresses and returns its properties, and a key of the
+ * ordered pair of vertices the addresses are attached to that keys the per-worker packet
+ * counters. returns FALSE if there is no path. */
+gboolean topology_lookupPath(Topology* top, Address* srcAddress, Address* dstAddress,
+        gdouble* latencyOut, gdouble* reliabilityOut, gpointer* vertexPairOut);
+
+/* writes the packet counts, keyed by vertex pair key and stored as pointers, as a
+ * source-by-destination vertex traffic matrix, one nonzero entry per line, to filePath */
+gboolean topology_writeTrafficMatrix(Topology* top, GHashTable* vertexPairPacketCounts,
+        const gchar* filePath);
+
+/* returns the time of the next scheduled link change, or SIMTIME_INVALID if there is none */
+SimulationTime topology_getNextChangeTime(Topology* top);
+
+/* applies all scheduled link changes up to and including time now, and invalidates
+ * the cached paths that they affect. must only be called while no other thread is
+ * using the topology. returns TRUE if any changes were applied, in which case the
+ * minimum edge latency of the changed graph in milliseconds, which bounds the latency
+ * of every path, is returned in minPathLatencyOut. */
+gboolean topology_applyChanges(Topology* top, SimulationTime now, gdouble* minPathLatencyOut);
 
 #endif /* SHD_TOPOLOGY_H_ */
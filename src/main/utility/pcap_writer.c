@@ -172,6 +172,12 @@ PCapWriter* pcapwriter_new(gchar* pcapDirectory, gchar* pcapFilename) {
     return pcap;
 }
 
+void pcapwriter_flush(PCapWriter* pcap) {
+    if(pcap && pcap->pcapFile) {
+        fflush(pcap->pcapFile);
+    }
+}
+
 void pcapwriter_free(PCapWriter* pcap) {
     if(pcap && pcap->pcapFile) {
         fclose(pcap->pcapFile);
@@ -47,6 +47,7 @@ struct _PCapPacket {
 
 PCapWriter* pcapwriter_new(gchar* pcapDirectory, gchar* pcapFilename);
 void pcapwriter_free(PCapWriter* pcap);
+void pcapwriter_flush(PCapWriter* pcap);
 void pcapwriter_writePacket(PCapWriter* pcap, PCapPacket* packet);
 
 #endif /* SHD_PCAP_WRITER_H_ */
@@ -12,7 +12,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 #include "main/utility/utility.h"
 #include "support/logger/logger.h"
@@ -84,6 +88,43 @@ guint utility_getRawCPUFrequency(const gchar* freqFilename) {
     return rawFrequencyKHz;
 }
 
+/* the first cycle count we handed out, and the monotonic time at which we took
+ * it. we calibrate the cycle rate against the clock over the time since then. */
+static struct {
+    guint64 cycles;
+    gint64 microseconds;
+} _utilityCycleBase;
+
+static guint64 _utility_readCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return (guint64)__rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((guint64)now.tv_sec * 1000000000UL) + (guint64)now.tv_nsec;
+#endif
+}
+
+guint64 utility_getCycleCount() {
+    static gsize baseIsSet = 0;
+    if(g_once_init_enter(&baseIsSet)) {
+        _utilityCycleBase.cycles = _utility_readCycleCounter();
+        _utilityCycleBase.microseconds = g_get_monotonic_time();
+        g_once_init_leave(&baseIsSet, 1);
+    }
+    return _utility_readCycleCounter();
+}
+
+gdouble utility_cyclesToSeconds(guint64 cycles) {
+    guint64 elapsedCycles = utility_getCycleCount() - _utilityCycleBase.cycles;
+    gint64 elapsedMicros = g_get_monotonic_time() - _utilityCycleBase.microseconds;
+    if(elapsedCycles == 0 || elapsedMicros <= 0) {
+        return 0.0;
+    }
+    gdouble secondsPerCycle = ((gdouble)elapsedMicros / G_USEC_PER_SEC) / (gdouble)elapsedCycles;
+    return (gdouble)cycles * secondsPerCycle;
+}
+
 static GString* _utility_formatError(const gchar* file, gint line, const gchar* function, const gchar* message) {
     GString* errorString = g_string_new("**ERROR ENCOUNTERED**\n");
     g_string_append_printf(errorString, "\tAt process: %i (parent %i)\n", (gint) getpid(), (gint) getppid());
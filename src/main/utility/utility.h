@@ -79,6 +79,12 @@ gint utility_simulationTimeCompare(const SimulationTime* value1, const Simulatio
         gpointer userData);
 gchar* utility_getHomePath(const gchar* path);
 guint utility_getRawCPUFrequency(const gchar* freqFilename);
+
+/* a cheap, monotonically increasing counter for timing hot paths without a
+ * system call. the unit is machine-dependent, so convert differences between
+ * two counts with utility_cyclesToSeconds(). */
+guint64 utility_getCycleCount();
+gdouble utility_cyclesToSeconds(guint64 cycles);
 gboolean utility_isRandomPath(const gchar* path);
 
 gboolean utility_removeAll(const gchar* path);
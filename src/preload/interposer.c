@@ -204,11 +204,19 @@ static inline Process* _doEmulate() {
 #if defined(PRELOADDEF)
 #undef PRELOADDEF
 #endif
+/* the profiled call ends when it goes out of scope, after the emulated function returns.
+ * without --profile-syscalls, we go straight to the emulated function. */
 #define PRELOADDEF(returnstatement, returntype, functionname, argumentlist, ...) \
 returntype functionname argumentlist { \
     Process* proc = NULL; \
     if((proc = _doEmulate()) != NULL) { \
-        returnstatement process_emu_##functionname(proc, ##__VA_ARGS__); \
+        if(G_UNLIKELY(process_isProfilingEmuCalls)) { \
+            ProcessEmuCall call __attribute__((cleanup(process_endEmuCall))) = \
+                    process_beginEmuCall(proc, #functionname); \
+            returnstatement process_emu_##functionname(proc, ##__VA_ARGS__); \
+        } else { \
+            returnstatement process_emu_##functionname(proc, ##__VA_ARGS__); \
+        } \
     } else { \
         ENSURE(functionname); \
         returnstatement director.next.functionname(__VA_ARGS__); \
@@ -14,6 +14,7 @@ PRELOADDEF(return, void*, aligned_alloc, (size_t a, size_t b), a, b);
 PRELOADDEF(return, void*, valloc, (size_t a), a);
 PRELOADDEF(return, void*, pvalloc, (size_t a), a);
 PRELOADDEF(return, void*, mmap, (void *a, size_t b, int c, int d, int e, off_t f), a, b, c, d, e, f);
+PRELOADDEF(return, int, munmap, (void *a, size_t b), a, b);
 
 /* event family */
 
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Run a loopback tcp test in shadow with the loopback fast path enabled, and
+# make sure that the connection was paired so the user data bypassed packets.
+
+# Catch failures
+set -euo pipefail
+
+LOG=`mktemp`
+trap "rm -f $LOG" EXIT
+
+# Interpret the args as a shadow command to run with debug logging
+$@ | tee $LOG
+
+NUM_PAIRED=`grep -c "paired with loopback peer" $LOG || true`
+NUM_PASSED=`grep -c "user bytes to loopback peer" $LOG || true`
+echo "paired $NUM_PAIRED loopback connections, passed user data directly $NUM_PASSED times"
+
+if [ "$NUM_PAIRED" -eq 0 ] || [ "$NUM_PASSED" -eq 0 ]; then
+    echo "no user data bypassed packets, so the loopback fast path was not tested" 1>&2
+    exit 1
+fi
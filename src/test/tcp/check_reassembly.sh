@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Run a lossy tcp test in shadow, and make sure that the receivers had to
+# reassemble out-of-order packets along the way. The number of duplicate
+# packets that were dropped from the reassembly buffers is reported.
+
+# Catch failures
+set -euo pipefail
+
+LOG=`mktemp`
+trap "rm -f $LOG" EXIT
+
+# Interpret the args as a shadow command to run with debug logging
+$@ | tee $LOG
+
+NUM_OUT_OF_ORDER=`grep -c "buffered out-of-order packet" $LOG || true`
+NUM_DUPLICATE=`grep -c "dropped duplicate packet" $LOG || true`
+echo "reassembled $NUM_OUT_OF_ORDER out-of-order packets, dropped $NUM_DUPLICATE duplicate packets"
+
+if [ "$NUM_OUT_OF_ORDER" -eq 0 ]; then
+    echo "no packets arrived out of order, so the reassembly was not tested" 1>&2
+    exit 1
+fi
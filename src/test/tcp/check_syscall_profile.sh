@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Run a tcp test in shadow with --profile-syscalls, and make sure that the
+# processes wrote their syscall profiles and that the profiles counted the
+# bytes moved by send and recv. The first arg is the shadow data directory,
+# the remaining args are the shadow command to run.
+
+# Catch failures
+set -euo pipefail
+
+DATA_DIR=$1
+shift
+
+# Interpret the remaining args as a shadow command to run
+$@
+
+PROFILES=`find $DATA_DIR/hosts -name "syscalls-*.csv"`
+if [ -z "$PROFILES" ]; then
+    echo "no syscall profiles were written to $DATA_DIR/hosts" 1>&2
+    exit 1
+fi
+
+# function,caller,calls,seconds,bytes
+NUM_SEND=`cat $PROFILES | awk -F, '$1 == "send" && $3 > 0 && $5 > 0' | wc -l`
+NUM_RECV=`cat $PROFILES | awk -F, '$1 == "recv" && $3 > 0 && $5 > 0' | wc -l`
+echo "found `echo $PROFILES | wc -w` syscall profiles, $NUM_SEND send rows and $NUM_RECV recv rows with bytes"
+
+if [ "$NUM_SEND" -eq 0 ] || [ "$NUM_RECV" -eq 0 ]; then
+    echo "the syscall profiles have no send or recv rows that moved bytes" 1>&2
+    exit 1
+fi
@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Run a traffic model test in shadow with --live-metrics, and make sure that
+# the metrics file it leaves behind says that the simulation finished and
+# counted the events it executed. The first arg is the shadow data directory,
+# the remaining args are the shadow command to run.
+
+# Catch failures
+set -euo pipefail
+
+DATA_DIR=$1
+shift
+
+LOG=`mktemp`
+trap "rm -f $LOG" EXIT
+
+# Interpret the remaining args as a shadow command to run
+$@
+
+`dirname $0`/../../tools/read-live-metrics.py $DATA_DIR/live-metrics.bin | tee $LOG
+
+if ! grep -q "^state finished," $LOG; then
+    echo "the live metrics do not say that the simulation finished" 1>&2
+    exit 1
+fi
+if grep -q "^0 events executed," $LOG; then
+    echo "the live metrics did not count any executed events" 1>&2
+    exit 1
+fi
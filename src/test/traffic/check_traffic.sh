@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Run a traffic model test in shadow, and make sure that every model moved
+# data and that the request/response exchanges completed. Each model reports
+# what it did in a "stopping traffic model" line when it stops.
+
+# Catch failures
+set -euo pipefail
+
+LOG=`mktemp`
+trap "rm -f $LOG" EXIT
+
+# Interpret the args as a shadow command to run
+$@ | tee $LOG
+
+NUM_STOPPED=`grep -c "stopping traffic model" $LOG || true`
+NUM_IDLE=`grep "stopping traffic model" $LOG | grep -c "sent 0 bytes, received 0 bytes" || true`
+NUM_EXCHANGING=`grep "stopping traffic model" $LOG | grep -c "\.\(requestresponse\|server\)\.[0-9]*'" || true`
+NUM_NO_EXCHANGES=`grep "stopping traffic model" $LOG | grep "\.\(requestresponse\|server\)\.[0-9]*'" | grep -c "completed 0 exchanges" || true`
+echo "$NUM_STOPPED traffic models stopped, $NUM_IDLE moved no data, $NUM_NO_EXCHANGES of $NUM_EXCHANGING completed no exchanges"
+
+if [ "$NUM_STOPPED" -eq 0 ]; then
+    echo "no traffic model reported its counters" 1>&2
+    exit 1
+fi
+if [ "$NUM_IDLE" -ne 0 ]; then
+    echo "some traffic models did not send or receive any bytes" 1>&2
+    exit 1
+fi
+if [ "$NUM_EXCHANGING" -eq 0 ] || [ "$NUM_NO_EXCHANGES" -ne 0 ]; then
+    echo "some request/response models or servers did not complete any exchanges" 1>&2
+    exit 1
+fi
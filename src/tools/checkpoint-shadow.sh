@@ -0,0 +1,116 @@
+#!/bin/bash
+
+# Take a CRIU checkpoint every time a shadow process that was started with
+# '--checkpoint-interval=N' stops at a checkpoint barrier, then let it continue.
+#
+# USAGE: checkpoint-shadow.sh [-p SECONDS] [-t PID] shadow.data checkpoints
+#
+# Each checkpoint is stored in 'checkpoints/<simtime>'. The process images are
+# in its 'dump' directory, and a copy of the data directory as it was at the
+# barrier is in its 'data' directory.
+#
+# With '-p SECONDS', the memory of the running shadow process is pre-dumped
+# every SECONDS of real time while we wait for the next barrier. Shadow keeps
+# running during a pre-dump, and the dump at the barrier then only has to copy
+# the pages that changed since the last pre-dump, which keeps the pause short.
+# We learn the pid of shadow at its first barrier, so pass it with '-t PID' to
+# also pre-dump before the first checkpoint.
+#
+# Resume a checkpoint in a fresh process with:
+#   rm -rf shadow.data && cp -a checkpoints/<simtime>/data shadow.data
+#   criu restore -D checkpoints/<simtime>/dump --shell-job -d && kill -CONT <pid>
+
+PREDUMP_INTERVAL=0
+PID=""
+while getopts "p:t:" OPT; do
+    case ${OPT} in
+        p) PREDUMP_INTERVAL=${OPTARG} ;;
+        t) PID=${OPTARG} ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -lt 2 ]; then
+    echo "USAGE: $0 [-p predump-seconds] [-t shadow-pid] shadow-data-directory checkpoint-directory" 1>&2
+    exit 1
+fi
+
+DATADIR=$1
+CHECKPOINTDIR=$2
+READY=${DATADIR}/checkpoint.ready
+# pre-dumps for the next checkpoint go here until we know its simtime
+NEXTDIR=${CHECKPOINTDIR}/next
+
+mkdir -p ${CHECKPOINTDIR}
+rm -rf ${NEXTDIR}
+mkdir -p ${NEXTDIR}
+
+NUMPREDUMPS=0
+LASTPREDUMP=$(date +%s)
+
+# the pre-dumps form a chain, each one only stores what changed since the last
+predump() {
+    local NEXT=$((NUMPREDUMPS + 1))
+    local PREV=""
+    if [ ${NUMPREDUMPS} -gt 0 ]; then
+        PREV="--prev-images-dir ../pre${NUMPREDUMPS}"
+    fi
+    mkdir -p ${NEXTDIR}/pre${NEXT}
+    if criu pre-dump -t ${PID} -D ${NEXTDIR}/pre${NEXT} --track-mem ${PREV} --shell-job; then
+        NUMPREDUMPS=${NEXT}
+    else
+        echo "pre-dump of shadow process ${PID} failed" 1>&2
+        rm -rf ${NEXTDIR}/pre${NEXT}
+    fi
+}
+
+while true; do
+    if [ -f ${READY} ]; then
+        read PID SIMTIME < ${READY}
+
+        # shadow writes the file just before it stops, so wait until it is stopped
+        while [ "$(ps -o state= -p ${PID} 2>/dev/null | tr -d ' ')" != "T" ]; do
+            if ! kill -0 ${PID} 2>/dev/null; then
+                echo "shadow process ${PID} exited" 1>&2
+                exit 0
+            fi
+            sleep 0.1
+        done
+
+        echo "checkpointing shadow process ${PID} at simtime ${SIMTIME}" 1>&2
+        PREV=""
+        if [ ${NUMPREDUMPS} -gt 0 ]; then
+            PREV="--prev-images-dir ../pre${NUMPREDUMPS}"
+        fi
+        mkdir -p ${NEXTDIR}/dump
+        if criu dump -t ${PID} -D ${NEXTDIR}/dump --track-mem ${PREV} --shell-job --leave-running; then
+            # the restored process reopens its output files at the dumped offsets,
+            # so they must match the dump. copy-on-write where the filesystem allows.
+            cp -a --reflink=auto ${DATADIR} ${NEXTDIR}/data
+            # the pre-dump links are relative, so the directory can be renamed
+            mv ${NEXTDIR} ${CHECKPOINTDIR}/${SIMTIME}
+        else
+            echo "checkpoint at simtime ${SIMTIME} failed" 1>&2
+            rm -rf ${NEXTDIR}
+        fi
+        mkdir -p ${NEXTDIR}
+        NUMPREDUMPS=0
+
+        # shadow removes the ready file once it continues
+        kill -CONT ${PID}
+        while [ -f ${READY} ] && kill -0 ${PID} 2>/dev/null; do
+            sleep 0.1
+        done
+        LASTPREDUMP=$(date +%s)
+    elif [ -n "${PID}" ] && ! kill -0 ${PID} 2>/dev/null; then
+        echo "shadow process ${PID} exited" 1>&2
+        rm -rf ${NEXTDIR}
+        exit 0
+    elif [ -n "${PID}" ] && [ ${PREDUMP_INTERVAL} -gt 0 ] && \
+            [ $(($(date +%s) - LASTPREDUMP)) -ge ${PREDUMP_INTERVAL} ]; then
+        predump
+        LASTPREDUMP=$(date +%s)
+    fi
+    sleep 1
+done
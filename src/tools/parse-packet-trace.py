@@ -0,0 +1,58 @@
+#!/usr/bin/python
+
+'''
+Convert the binary packet trace that shadow writes with the '--packet-trace'
+option into text, one record per line, sorted by simulation time. The record
+format is defined in src/main/core/support/packet_trace.h, and the status
+values are defined in src/main/routing/packet.h.
+'''
+
+from __future__ import print_function
+import struct
+import sys
+
+HEADER_FORMAT = "<8sII"
+RECORD_FORMAT = "<QQIIII"
+MAGIC = b"SHDPKTTR"
+
+STATUS_NAMES = ["NONE", "SND_CREATED", "SND_TCP_ENQUEUE_THROTTLED",
+    "SND_TCP_ENQUEUE_RETRANSMIT", "SND_TCP_DEQUEUE_RETRANSMIT",
+    "SND_TCP_RETRANSMITTED", "SND_SOCKET_BUFFERED", "SND_INTERFACE_SENT",
+    "INET_SENT", "INET_DROPPED", "ROUTER_ENQUEUED", "ROUTER_DEQUEUED",
+    "ROUTER_DROPPED", "RCV_INTERFACE_RECEIVED", "RCV_INTERFACE_DROPPED",
+    "RCV_SOCKET_PROCESSED", "RCV_SOCKET_DROPPED", "RCV_TCP_ENQUEUE_UNORDERED",
+    "RCV_SOCKET_BUFFERED", "RCV_SOCKET_DELIVERED", "DESTROYED"]
+
+def status_to_string(status):
+    # statuses are single bits, PDS_SND_CREATED is 1 << 1
+    for bit in range(1, len(STATUS_NAMES)):
+        if status == (1 << bit):
+            return STATUS_NAMES[bit]
+    return "UNKNOWN({0})".format(status)
+
+if len(sys.argv) < 2:
+    print("USAGE: {0} packet-trace.bin".format(sys.argv[0]), file=sys.stderr)
+    exit(1)
+
+with open(sys.argv[1], 'rb') as inf:
+    header = inf.read(struct.calcsize(HEADER_FORMAT))
+    magic, version, record_size = struct.unpack(HEADER_FORMAT, header)
+    if magic != MAGIC or record_size != struct.calcsize(RECORD_FORMAT):
+        print("{0} is not a version {1} packet trace".format(sys.argv[1], version), file=sys.stderr)
+        exit(1)
+
+    records = []
+    while True:
+        data = inf.read(record_size)
+        if len(data) < record_size:
+            break
+        records.append(struct.unpack(RECORD_FORMAT, data))
+
+# the trace interleaves records from all workers, and sorting is stable so
+# the statuses of a packet on a host stay in the order they were added
+records.sort(key=lambda r: r[0])
+
+for (time, packet_id, packet_host_id, host_id, status, _) in records:
+    print("{0} {1}:{2} {3} {4}".format(time, packet_host_id, packet_id, host_id, status_to_string(status)))
+
+print("Done! Processed {0} records.".format(len(records)), file=sys.stderr)
@@ -0,0 +1,116 @@
+#!/usr/bin/python
+
+'''
+Print the live metrics that shadow keeps in the memory-mapped file
+'live-metrics.bin' in its data directory when run with the '--live-metrics'
+option. The file can be read while shadow is running, and keeps the last
+values after it exits. The layout is defined in
+src/main/core/support/live_metrics.h.
+'''
+
+from __future__ import print_function
+import argparse
+import mmap
+import struct
+import sys
+import time
+
+MAGIC = b"SHDMETRC"
+VERSION = 2
+
+# magic, version, sizes of header/worker/host records, number of workers/hosts
+HEADER_PREFIX_FORMAT = "<8sIIIIII"
+# sequence, state, rounds, sim time, end time, real time, events executed,
+# events per second, events pending, packets alive
+HEADER_FORMAT = HEADER_PREFIX_FORMAT + "QQQQQQQdQQ"
+# sequence, rounds, events executed, idle seconds
+WORKER_FORMAT = "<QQQd"
+# sequence, name, last active sim time, execution seconds, bytes sent/received/allocated
+HOST_FORMAT = "<Q64sQdQQQ"
+
+STATE_NAMES = ["starting", "running", "finished"]
+
+def read_record(region, record_format, offset, sequence_offset):
+    # records are rewritten in place, so retry until we see the same even
+    # sequence number before and after copying one
+    size = struct.calcsize(record_format)
+    while True:
+        before = struct.unpack_from("<Q", region, offset + sequence_offset)[0]
+        record = struct.unpack(record_format, region[offset:offset + size])
+        after = struct.unpack_from("<Q", region, offset + sequence_offset)[0]
+        if before % 2 == 0 and before == after:
+            return record
+        time.sleep(0.001)
+
+def read_header(region):
+    return read_record(region, HEADER_FORMAT, 0, struct.calcsize(HEADER_PREFIX_FORMAT))
+
+def format_bytes(num):
+    for unit in ["B", "KiB", "MiB", "GiB"]:
+        if num < 1024.0:
+            return "{0:.1f} {1}".format(num, unit)
+        num /= 1024.0
+    return "{0:.1f} TiB".format(num)
+
+def print_metrics(region, num_hosts_shown):
+    (magic, version, header_size, worker_size, host_size, num_workers, num_hosts,
+        sequence, state, num_rounds, sim_time, end_time, real_time, num_events,
+        events_per_second, num_events_pending, num_packets_alive) = read_header(region)
+
+    state_name = STATE_NAMES[state] if state < len(STATE_NAMES) else "unknown"
+    progress = 100.0 * sim_time / end_time if end_time > 0 else 0.0
+    print("state {0}, round {1}, simtime {2:.3f}s of {3:.3f}s ({4:.1f}%), real time {5:.1f}s".format(
+        state_name, num_rounds, sim_time / 1e9, end_time / 1e9, progress, real_time / 1e9))
+    print("{0} events executed, {1:.0f} events/s, {2} events pending, {3} packets alive".format(
+        num_events, events_per_second, num_events_pending, num_packets_alive))
+
+    offset = header_size
+    print("worker rounds events idle-seconds")
+    for i in range(num_workers):
+        (_, rounds, events, idle) = read_record(region, WORKER_FORMAT, offset + i * worker_size, 0)
+        print("{0} {1} {2} {3:.3f}".format(i, rounds, events, idle))
+
+    offset += num_workers * worker_size
+    hosts = []
+    for i in range(num_hosts):
+        (_, name, last_active, seconds, sent, received, allocated) = \
+            read_record(region, HOST_FORMAT, offset + i * host_size, 0)
+        name = name.split(b"\0", 1)[0].decode("utf-8", "replace")
+        hosts.append((name, last_active, seconds, sent, received, allocated))
+
+    # show the hosts that took the most simulator time
+    hosts.sort(key=lambda h: h[2], reverse=True)
+    print("host last-active-simtime execution-seconds sent received allocated")
+    for (name, last_active, seconds, sent, received, allocated) in hosts[:num_hosts_shown]:
+        print("{0} {1:.3f} {2:.3f} {3} {4} {5}".format(name, last_active / 1e9, seconds,
+            format_bytes(sent), format_bytes(received), format_bytes(allocated)))
+
+def main():
+    parser = argparse.ArgumentParser(description="Print the live metrics of a shadow simulation.")
+    parser.add_argument("path", help="the live-metrics.bin file in the shadow data directory")
+    parser.add_argument("-i", "--interval", type=float, default=0,
+        help="print the metrics again every INTERVAL seconds until the simulation finishes")
+    parser.add_argument("-n", "--hosts", type=int, default=10,
+        help="the number of hosts to print, starting with the ones that took the most time [10]")
+    args = parser.parse_args()
+
+    with open(args.path, 'rb') as inf:
+        region = mmap.mmap(inf.fileno(), 0, access=mmap.ACCESS_READ)
+
+        prefix_size = struct.calcsize(HEADER_PREFIX_FORMAT)
+        magic, version = struct.unpack_from(HEADER_PREFIX_FORMAT, region[0:prefix_size])[0:2]
+        if magic != MAGIC or version != VERSION:
+            print("{0} is not a version {1} live metrics file".format(args.path, VERSION), file=sys.stderr)
+            exit(1)
+
+        while True:
+            print_metrics(region, args.hosts)
+            if args.interval <= 0 or read_header(region)[8] == STATE_NAMES.index("finished"):
+                break
+            print("")
+            time.sleep(args.interval)
+
+        region.close()
+
+if __name__ == '__main__':
+    main()